@@ -49,6 +49,9 @@
 #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_per_neighbor_rpl_storing, &default_common }
 /* Example configuration for RPL non-storing mode: */
 /* #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_per_neighbor_rpl_ns, &default_common } */
+/* Example configuration with a staircase slotframe for low-latency upward unicast,
+ * placed before the per-neighbor rule so that its links take precedence: */
+/* #define ORCHESTRA_RULES { &eb_per_time_source, &unicast_upward_staircase, &unicast_per_neighbor_rpl_storing, &default_common } */
 
 #endif /* ORCHESTRA_CONF_RULES */
 
@@ -72,6 +75,28 @@
 #define ORCHESTRA_UNICAST_PERIOD                  17
 #endif /* ORCHESTRA_CONF_UNICAST_PERIOD */
 
+#ifdef ORCHESTRA_CONF_STAIRCASE_PERIOD
+#define ORCHESTRA_STAIRCASE_PERIOD                ORCHESTRA_CONF_STAIRCASE_PERIOD
+#else /* ORCHESTRA_CONF_STAIRCASE_PERIOD */
+#define ORCHESTRA_STAIRCASE_PERIOD                23
+#endif /* ORCHESTRA_CONF_STAIRCASE_PERIOD */
+
+/* Number of channel offsets the upward staircase spreads nodes of the same depth
+ * over, so that sibling subtrees do not collide */
+#ifdef ORCHESTRA_CONF_STAIRCASE_NUM_CHANNEL_OFFSETS
+#define ORCHESTRA_STAIRCASE_NUM_CHANNEL_OFFSETS   ORCHESTRA_CONF_STAIRCASE_NUM_CHANNEL_OFFSETS
+#else /* ORCHESTRA_CONF_STAIRCASE_NUM_CHANNEL_OFFSETS */
+#define ORCHESTRA_STAIRCASE_NUM_CHANNEL_OFFSETS   4
+#endif /* ORCHESTRA_CONF_STAIRCASE_NUM_CHANNEL_OFFSETS */
+
+/* First channel offset of the upward staircase. The other rules use their
+ * slotframe handle as channel offset, so start right after the last rule */
+#ifdef ORCHESTRA_CONF_STAIRCASE_CHANNEL_OFFSET_BASE
+#define ORCHESTRA_STAIRCASE_CHANNEL_OFFSET_BASE   ORCHESTRA_CONF_STAIRCASE_CHANNEL_OFFSET_BASE
+#else /* ORCHESTRA_CONF_STAIRCASE_CHANNEL_OFFSET_BASE */
+#define ORCHESTRA_STAIRCASE_CHANNEL_OFFSET_BASE   (sizeof((const struct orchestra_rule *[])ORCHESTRA_RULES) / sizeof(struct orchestra_rule *))
+#endif /* ORCHESTRA_CONF_STAIRCASE_CHANNEL_OFFSET_BASE */
+
 /* Is the per-neighbor unicast slotframe sender-based (if not, it is receiver-based).
  * Note: sender-based works only with RPL storing mode as it relies on DAO and
  * routing entries to keep track of children and parents. */
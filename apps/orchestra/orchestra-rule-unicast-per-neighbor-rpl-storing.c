@@ -218,6 +218,7 @@ struct orchestra_rule unicast_per_neighbor_rpl_storing = {
   select_packet,
   child_added,
   child_removed,
+  NULL,
 };
 
 #endif /* UIP_MAX_ROUTES */
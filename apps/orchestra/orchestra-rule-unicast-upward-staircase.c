@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * \file
+ *         Orchestra: a slotframe dedicated to upward unicast transmission, laid out
+ *         as a staircase along the RPL DODAG. Nodes derive a depth from their rank,
+ *         DAG_RANK(rank) - 1, which is 0 at the root and grows by at least one per hop.
+ *           Nodes listen at timeslot ORCHESTRA_STAIRCASE_PERIOD - 1 - depth
+ *           Nodes transmit to their preferred parent at the parent's Rx timeslot
+ *         Every hop up is one or more timeslots later in the slotframe, so an upward
+ *         packet can reach the root within a single slotframe rather than one per hop.
+ *         Nodes of the same depth listen in the same timeslot, each on a channel offset
+ *         derived from its address, so that siblings receive from their children in
+ *         parallel. Nodes move their Rx link whenever RPL changes their rank, and
+ *         follow the stair of their parent before every packet. Downward and other
+ *         traffic is left to the next rules.
+ */
+
+#include "contiki.h"
+#include "orchestra.h"
+#include "net/packetbuf.h"
+#include "net/rpl/rpl-private.h"
+
+static uint16_t slotframe_handle = 0;
+static struct tsch_slotframe *sf_staircase;
+/* Our current Rx link, and Tx link to our parent. 0xffff if none */
+static uint16_t rx_timeslot = 0xffff;
+static uint16_t tx_timeslot = 0xffff;
+static uint16_t tx_channel_offset;
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_rank_timeslot(rpl_rank_t rank, const rpl_instance_t *instance)
+{
+  uint16_t depth;
+  if(instance == NULL || rank == INFINITE_RANK || rank < ROOT_RANK(instance)) {
+    return 0xffff;
+  }
+  depth = DAG_RANK(rank, instance) - 1;
+  /* Beyond the last stair, all nodes share timeslot 0 */
+  return ORCHESTRA_STAIRCASE_PERIOD - 1 - MIN(depth, ORCHESTRA_STAIRCASE_PERIOD - 1);
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+get_node_channel_offset(const linkaddr_t *addr)
+{
+  return ORCHESTRA_STAIRCASE_CHANNEL_OFFSET_BASE + ORCHESTRA_LINKADDR_HASH(addr) % ORCHESTRA_STAIRCASE_NUM_CHANNEL_OFFSETS;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_link(uint16_t timeslot)
+{
+  struct tsch_link *l = tsch_schedule_get_link_by_timeslot(sf_staircase, timeslot);
+  if(l != NULL) {
+    tsch_schedule_remove_link(sf_staircase, l);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Listen at the stair of our current rank */
+static void
+update_rx_link(void)
+{
+  rpl_dag_t *dag = rpl_get_any_dag();
+  uint16_t timeslot = dag != NULL ? get_rank_timeslot(dag->rank, dag->instance) : 0xffff;
+
+  if(timeslot != rx_timeslot) {
+    if(rx_timeslot != 0xffff) {
+      remove_link(rx_timeslot);
+    }
+    rx_timeslot = timeslot;
+    if(rx_timeslot != 0xffff) {
+      tsch_schedule_add_link(sf_staircase, LINK_OPTION_RX, LINK_TYPE_NORMAL, &tsch_broadcast_address,
+          rx_timeslot, get_node_channel_offset(&linkaddr_node_addr));
+    }
+    /* Our Tx link may have been in this timeslot */
+    if(tx_timeslot == rx_timeslot) {
+      tx_timeslot = 0xffff;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Transmit at the stair of our parent, as last advertised in its DIOs */
+static void
+update_tx_link(void)
+{
+  rpl_dag_t *dag = rpl_get_any_dag();
+  uint16_t timeslot = 0xffff;
+  uint16_t channel_offset = 0;
+
+  if(dag != NULL && dag->preferred_parent != NULL
+     && !linkaddr_cmp(&orchestra_parent_linkaddr, &linkaddr_null)) {
+    timeslot = get_rank_timeslot(dag->preferred_parent->rank, dag->instance);
+    channel_offset = get_node_channel_offset(&orchestra_parent_linkaddr);
+    if(timeslot == rx_timeslot) {
+      /* Both at the last stair: leave upward traffic to the next rules */
+      timeslot = 0xffff;
+    }
+  }
+
+  if(timeslot != tx_timeslot || channel_offset != tx_channel_offset) {
+    if(tx_timeslot != 0xffff) {
+      remove_link(tx_timeslot);
+    }
+    tx_timeslot = timeslot;
+    tx_channel_offset = channel_offset;
+    if(tx_timeslot != 0xffff) {
+      tsch_schedule_add_link(sf_staircase, LINK_OPTION_TX | LINK_OPTION_SHARED, LINK_TYPE_NORMAL,
+          &tsch_broadcast_address, tx_timeslot, tx_channel_offset);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+select_packet(uint16_t *slotframe, uint16_t *timeslot)
+{
+  const linkaddr_t *dest = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+
+  update_tx_link();
+
+  /* Select data packets to our parent */
+  if(packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) == FRAME802154_DATAFRAME
+     && tx_timeslot != 0xffff
+     && !linkaddr_cmp(dest, &linkaddr_null)
+     && linkaddr_cmp(dest, &orchestra_parent_linkaddr)) {
+    if(slotframe != NULL) {
+      *slotframe = slotframe_handle;
+    }
+    if(timeslot != NULL) {
+      *timeslot = tx_timeslot;
+    }
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+new_time_source(const struct tsch_neighbor *old, const struct tsch_neighbor *new)
+{
+  if(new != old) {
+    if(new != NULL) {
+      linkaddr_copy(&orchestra_parent_linkaddr, &new->addr);
+    } else {
+      linkaddr_copy(&orchestra_parent_linkaddr, &linkaddr_null);
+    }
+    update_rx_link();
+    update_tx_link();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+new_rank(uint16_t old_rank, uint16_t new_rank)
+{
+  /* Move to the stair of our new rank */
+  update_rx_link();
+  update_tx_link();
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(uint16_t sf_handle)
+{
+  slotframe_handle = sf_handle;
+  /* Slotframe for upward unicast transmissions */
+  sf_staircase = tsch_schedule_add_slotframe(slotframe_handle, ORCHESTRA_STAIRCASE_PERIOD);
+  /* The root has its rank already */
+  update_rx_link();
+}
+/*---------------------------------------------------------------------------*/
+struct orchestra_rule unicast_upward_staircase = {
+  init,
+  new_time_source,
+  select_packet,
+  NULL,
+  NULL,
+  new_rank,
+};
@@ -106,6 +106,18 @@ orchestra_callback_child_removed(const linkaddr_t *addr)
 }
 /*---------------------------------------------------------------------------*/
 void
+orchestra_callback_new_rank(uint16_t old_rank, uint16_t new_rank)
+{
+  /* Notify all Orchestra rules that our rank changed */
+  int i;
+  for(i = 0; i < NUM_RULES; i++) {
+    if(all_rules[i]->new_rank != NULL) {
+      all_rules[i]->new_rank(old_rank, new_rank);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
 orchestra_callback_packet_ready(void)
 {
   int i;
@@ -50,11 +50,13 @@ struct orchestra_rule {
   int  (* select_packet)(uint16_t *slotframe, uint16_t *timeslot);
   void (* child_added)(const linkaddr_t *addr);
   void (* child_removed)(const linkaddr_t *addr);
+  void (* new_rank)(uint16_t old_rank, uint16_t new_rank);
 };
 
 struct orchestra_rule eb_per_time_source;
 struct orchestra_rule unicast_per_neighbor_rpl_storing;
 struct orchestra_rule unicast_per_neighbor_rpl_ns;
+struct orchestra_rule unicast_upward_staircase;
 struct orchestra_rule default_common;
 
 extern linkaddr_t orchestra_parent_linkaddr;
@@ -71,5 +73,7 @@ void orchestra_callback_new_time_source(const struct tsch_neighbor *old, const s
 void orchestra_callback_child_added(const linkaddr_t *addr);
 /* Set with #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed */
 void orchestra_callback_child_removed(const linkaddr_t *addr);
+/* Set with #define RPL_CALLBACK_NEW_RANK orchestra_callback_new_rank */
+void orchestra_callback_new_rank(uint16_t old_rank, uint16_t new_rank);
 
 #endif /* __ORCHESTRA_H__ */
@@ -53,8 +53,66 @@ memb_init(struct memb *m)
 {
   memset(m->count, 0, m->num);
   memset(m->mem, 0, m->size * m->num);
+#if MEMB_WITH_FREELIST
+  m->free_head = 0;
+  m->unused_start = 0;
+  m->used = 0;
+#endif /* MEMB_WITH_FREELIST */
 }
 /*---------------------------------------------------------------------------*/
+#if MEMB_WITH_FREELIST
+void *
+memb_alloc(struct memb *m)
+{
+  unsigned short i;
+
+  if(m->free_head != 0) {
+    /* Take the first block from the free list. */
+    i = m->free_head - 1;
+    m->free_head = m->next[i];
+  } else if(m->unused_start < m->num) {
+    /* The free list is empty, but there are blocks that have never
+       been allocated. */
+    i = m->unused_start++;
+  } else {
+    return NULL;
+  }
+
+  m->count[i] = 1;
+  ++m->used;
+  return (void *)((char *)m->mem + (i * m->size));
+}
+/*---------------------------------------------------------------------------*/
+char
+memb_free(struct memb *m, void *ptr)
+{
+  unsigned short i;
+  unsigned long offset;
+
+  if(!memb_inmemb(m, ptr)) {
+    return -1;
+  }
+
+  offset = (char *)ptr - (char *)m->mem;
+  i = offset / m->size;
+  if(offset != (unsigned long)i * m->size) {
+    /* The pointer does not point to the start of a block. */
+    return -1;
+  }
+
+  if(m->count[i] > 0) {
+    /* Make sure that we don't deallocate free memory. */
+    --(m->count[i]);
+    if(m->count[i] == 0) {
+      /* The block is now unused: put it first on the free list. */
+      m->next[i] = m->free_head;
+      m->free_head = i + 1;
+      --m->used;
+    }
+  }
+  return m->count[i];
+}
+#else /* MEMB_WITH_FREELIST */
 void *
 memb_alloc(struct memb *m)
 {
@@ -99,6 +157,7 @@ memb_free(struct memb *m, void *ptr)
   }
   return -1;
 }
+#endif /* MEMB_WITH_FREELIST */
 /*---------------------------------------------------------------------------*/
 int
 memb_inmemb(struct memb *m, void *ptr)
@@ -110,6 +169,9 @@ memb_inmemb(struct memb *m, void *ptr)
 int
 memb_numfree(struct memb *m)
 {
+#if MEMB_WITH_FREELIST
+  return m->num - m->used;
+#else /* MEMB_WITH_FREELIST */
   int i;
   int num_free = 0;
 
@@ -120,5 +182,6 @@ memb_numfree(struct memb *m)
   }
 
   return num_free;
+#endif /* MEMB_WITH_FREELIST */
 }
 /** @} */
@@ -63,8 +63,30 @@
 #ifndef MEMB_H_
 #define MEMB_H_
 
+#include "contiki-conf.h"
 #include "sys/cc.h"
 
+/**
+ * \brief Enables the constant-time free-list allocator
+ *
+ * By default, memb_alloc(), memb_free() and memb_numfree() scan the
+ * reference count array of the memory block, which is cheap in RAM
+ * but linear in the number of blocks. With this option set, every
+ * memory block also keeps a free list of block indices and a count of
+ * the blocks in use, making all memb operations constant time at the
+ * cost of two extra bytes of RAM per block.
+ *
+ * The free list is built lazily, so memory blocks that are used
+ * without a prior call to memb_init() work just as before.
+ *
+ * To enable, define MEMB_CONF_WITH_FREELIST to 1 in contiki-conf.h
+ */
+#ifdef MEMB_CONF_WITH_FREELIST
+#define MEMB_WITH_FREELIST MEMB_CONF_WITH_FREELIST
+#else /* MEMB_CONF_WITH_FREELIST */
+#define MEMB_WITH_FREELIST 0
+#endif /* MEMB_CONF_WITH_FREELIST */
+
 /**
  * Declare a memory block.
  *
@@ -86,18 +108,42 @@ MEMB(connections, struct connection, 16);
  * \param num The total number of memory chunks in the block.
  *
  */
+#if MEMB_WITH_FREELIST
+#define MEMB(name, structure, num) \
+        static char CC_CONCAT(name,_memb_count)[num]; \
+        static unsigned short CC_CONCAT(name,_memb_next)[num]; \
+        static structure CC_CONCAT(name,_memb_mem)[num]; \
+        static struct memb name = {sizeof(structure), num, \
+                                          CC_CONCAT(name,_memb_count), \
+                                          (void *)CC_CONCAT(name,_memb_mem), \
+                                          CC_CONCAT(name,_memb_next), \
+                                          0, 0, 0}
+#else /* MEMB_WITH_FREELIST */
 #define MEMB(name, structure, num) \
         static char CC_CONCAT(name,_memb_count)[num]; \
         static structure CC_CONCAT(name,_memb_mem)[num]; \
         static struct memb name = {sizeof(structure), num, \
                                           CC_CONCAT(name,_memb_count), \
                                           (void *)CC_CONCAT(name,_memb_mem)}
+#endif /* MEMB_WITH_FREELIST */
 
 struct memb {
   unsigned short size;
   unsigned short num;
   char *count;
   void *mem;
+#if MEMB_WITH_FREELIST
+  /* Free list of block indices. Entries and the list head hold the
+     index plus one, so that zero denotes the end of the list and a
+     statically zeroed memb is a valid, empty one. */
+  unsigned short *next;
+  unsigned short free_head;
+  /* Blocks at or above this index have never been handed out and are
+     free without being on the free list. */
+  unsigned short unused_start;
+  /* Number of blocks currently allocated. */
+  unsigned short used;
+#endif /* MEMB_WITH_FREELIST */
 };
 
 /**
@@ -128,8 +174,22 @@ void *memb_alloc(struct memb *m);
  */
 char  memb_free(struct memb *m, void *ptr);
 
+/**
+ * Check if a pointer points into a memory block declared with MEMB().
+ *
+ * \param m A memory block previously declared with MEMB().
+ *
+ * \param ptr A pointer.
+ *
+ * \return Non-zero if "ptr" points into the memory of the block.
+ */
 int memb_inmemb(struct memb *m, void *ptr);
 
+/**
+ * Get the number of free blocks of a memory block declared with MEMB().
+ *
+ * \param m A memory block previously declared with MEMB().
+ */
 int  memb_numfree(struct memb *m);
 
 /** @} */
@@ -49,6 +49,11 @@
 #include "contiki-conf.h"
 #include <string.h>
 
+#if MMEM_DEFERRED_COMPACTION
+#include "sys/clock.h"
+#include "sys/rtimer.h"
+#endif /* MMEM_DEFERRED_COMPACTION */
+
 #ifdef MMEM_CONF_SIZE
 #define MMEM_SIZE MMEM_CONF_SIZE
 #else
@@ -59,6 +64,25 @@ LIST(mmemlist);
 unsigned int avail_memory;
 static char memory[MMEM_SIZE];
 
+#if MMEM_DEFERRED_COMPACTION
+/* Offset of the first byte after the last allocated block. The
+   memory from there to the end is free, all other free memory is in
+   holes between the blocks. */
+static unsigned int used_end;
+
+static unsigned long compact_time;
+#endif /* MMEM_DEFERRED_COMPACTION */
+
+static unsigned long compacted;
+
+/*---------------------------------------------------------------------------*/
+#if MMEM_DEFERRED_COMPACTION
+static unsigned int
+hole_bytes(void)
+{
+  return avail_memory - (MMEM_SIZE - used_end);
+}
+#endif /* MMEM_DEFERRED_COMPACTION */
 /*---------------------------------------------------------------------------*/
 /**
  * \brief      Allocate a managed memory block
@@ -82,6 +106,60 @@ static char memory[MMEM_SIZE];
 int
 mmem_alloc(struct mmem *m, unsigned int size)
 {
+#if MMEM_DEFERRED_COMPACTION
+  struct mmem *n, *prev, *best_prev;
+  char *hole, *best;
+  unsigned int best_size;
+
+  /* Check if we have enough memory left for this allocation. */
+  if(avail_memory < size) {
+    return 0;
+  }
+
+  if(hole_bytes() > 0) {
+    /* Look for the smallest hole between two blocks that fits. */
+    best = NULL;
+    best_prev = NULL;
+    best_size = 0;
+    hole = memory;
+    prev = NULL;
+    for(n = list_head(mmemlist); n != NULL; n = n->next) {
+      if((char *)n->ptr - hole >= size &&
+         (best == NULL || (char *)n->ptr - hole < best_size)) {
+        best = hole;
+        best_prev = prev;
+        best_size = (char *)n->ptr - hole;
+        if(best_size == size) {
+          break;
+        }
+      }
+      hole = (char *)n->ptr + n->size;
+      prev = n;
+    }
+
+    if(best != NULL) {
+      /* Insert the block so that the list stays in address order. */
+      list_insert(mmemlist, best_prev, m);
+      m->ptr = best;
+      m->size = size;
+      avail_memory -= size;
+      return 1;
+    }
+
+    if(MMEM_SIZE - used_end < size) {
+      /* The memory is there, but not in one piece. */
+      mmem_compact(0);
+    }
+  }
+
+  list_add(mmemlist, m);
+  m->ptr = &memory[used_end];
+  m->size = size;
+  used_end += size;
+  avail_memory -= size;
+
+  return 1;
+#else /* MMEM_DEFERRED_COMPACTION */
   /* Check if we have enough memory left for this allocation. */
   if(avail_memory < size) {
     return 0;
@@ -104,6 +182,7 @@ mmem_alloc(struct mmem *m, unsigned int size)
   /* Return non-zero to indicate that we were able to allocate
      memory. */
   return 1;
+#endif /* MMEM_DEFERRED_COMPACTION */
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -118,6 +197,28 @@ mmem_alloc(struct mmem *m, unsigned int size)
 void
 mmem_free(struct mmem *m)
 {
+#if MMEM_DEFERRED_COMPACTION
+  struct mmem *prev;
+
+  if(m->next == NULL) {
+    /* The last block is removed, so the free memory at the end grows
+       down to the end of the block before it. */
+    for(prev = list_head(mmemlist);
+        prev != NULL && prev->next != m;
+        prev = prev->next);
+    used_end = prev == NULL ? 0 : (char *)prev->ptr + prev->size - memory;
+  }
+
+  avail_memory += m->size;
+
+  /* Remove the memory block from the list. Its memory is left as a
+     hole until it is reused or compacted away. */
+  list_remove(mmemlist, m);
+
+  if(hole_bytes() > MMEM_COMPACT_THRESHOLD) {
+    mmem_compact(MMEM_COMPACT_STEP);
+  }
+#else /* MMEM_DEFERRED_COMPACTION */
   struct mmem *n;
 
   if(m->next != NULL) {
@@ -125,6 +226,7 @@ mmem_free(struct mmem *m)
        by moving it downwards. */
     memmove(m->ptr, m->next->ptr,
 	    &memory[MMEM_SIZE - avail_memory] - (char *)m->next->ptr);
+    compacted += &memory[MMEM_SIZE - avail_memory] - (char *)m->next->ptr;
     
     /* Update all the memory pointers that points to memory that is
        after the allocation that is to be removed. */
@@ -137,6 +239,75 @@ mmem_free(struct mmem *m)
 
   /* Remove the memory block from the list. */
   list_remove(mmemlist, m);
+#endif /* MMEM_DEFERRED_COMPACTION */
+}
+/*---------------------------------------------------------------------------*/
+unsigned int
+mmem_compact(unsigned int max_bytes)
+{
+#if MMEM_DEFERRED_COMPACTION
+  struct mmem *n;
+  char *end;
+  unsigned int moved;
+  rtimer_clock_t start;
+
+  if(hole_bytes() == 0) {
+    return 0;
+  }
+
+  start = RTIMER_NOW();
+  moved = 0;
+  end = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    if(n->ptr != end) {
+      if(max_bytes > 0 && moved > 0 && moved + n->size > max_bytes) {
+        break;
+      }
+      memmove(end, n->ptr, n->size);
+      n->ptr = end;
+      moved += n->size;
+    }
+    end += n->size;
+  }
+
+  if(n == NULL) {
+    /* All holes are closed. */
+    used_end = end - memory;
+  }
+
+  compacted += moved;
+  compact_time += (rtimer_clock_t)(RTIMER_NOW() - start);
+  return moved;
+#else /* MMEM_DEFERRED_COMPACTION */
+  /* The memory is compacted on every mmem_free(). */
+  return 0;
+#endif /* MMEM_DEFERRED_COMPACTION */
+}
+/*---------------------------------------------------------------------------*/
+void
+mmem_stats(struct mmem_stats *stats)
+{
+#if MMEM_DEFERRED_COMPACTION
+  struct mmem *n;
+  char *hole;
+
+  stats->largest_free = MMEM_SIZE - used_end;
+  hole = memory;
+  for(n = list_head(mmemlist); n != NULL; n = n->next) {
+    if((char *)n->ptr - hole > stats->largest_free) {
+      stats->largest_free = (char *)n->ptr - hole;
+    }
+    hole = (char *)n->ptr + n->size;
+  }
+  stats->compact_time = compact_time;
+#else /* MMEM_DEFERRED_COMPACTION */
+  stats->largest_free = avail_memory;
+  stats->compact_time = 0;
+#endif /* MMEM_DEFERRED_COMPACTION */
+  stats->avail = avail_memory;
+  stats->fragmentation = avail_memory == 0 ? 0 :
+    100 - (unsigned char)(100UL * stats->largest_free / avail_memory);
+  stats->compacted = compacted;
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -157,6 +328,9 @@ mmem_init(void)
   }
   list_init(mmemlist);
   avail_memory = MMEM_SIZE;
+#if MMEM_DEFERRED_COMPACTION
+  used_end = 0;
+#endif /* MMEM_DEFERRED_COMPACTION */
   inited = 1;
 }
 /*---------------------------------------------------------------------------*/
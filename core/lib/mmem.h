@@ -39,7 +39,8 @@
  *
  * The managed memory allocator is a fragmentation-free memory
  * manager. It keeps the allocated memory free from fragmentation by
- * compacting the memory when blocks are freed. A program that uses
+ * compacting the memory when blocks are freed, or later when
+ * MMEM_CONF_DEFERRED_COMPACTION is set. A program that uses
  * the managed memory module cannot be sure that allocated memory
  * stays in place. Therefore, a level of indirection is used: access
  * to allocated memory must always be done using a special macro.
@@ -59,6 +60,37 @@
 #ifndef MMEM_H_
 #define MMEM_H_
 
+#include "contiki-conf.h"
+
+/**
+ * \brief Compact the memory lazily
+ *
+ * By default, mmem_free() compacts the memory immediately by moving
+ * all later blocks down, which costs time proportional to the amount
+ * of allocated memory on every free. With this option, a freed block
+ * is left as a hole that later allocations reuse (best fit). The
+ * memory is compacted only when an allocation does not fit in any
+ * hole, or one step of at most MMEM_COMPACT_STEP bytes at a time once
+ * the holes add up to more than MMEM_COMPACT_THRESHOLD bytes.
+ */
+#ifdef MMEM_CONF_DEFERRED_COMPACTION
+#define MMEM_DEFERRED_COMPACTION MMEM_CONF_DEFERRED_COMPACTION
+#else /* MMEM_CONF_DEFERRED_COMPACTION */
+#define MMEM_DEFERRED_COMPACTION 0
+#endif /* MMEM_CONF_DEFERRED_COMPACTION */
+
+#ifdef MMEM_CONF_COMPACT_THRESHOLD
+#define MMEM_COMPACT_THRESHOLD MMEM_CONF_COMPACT_THRESHOLD
+#else /* MMEM_CONF_COMPACT_THRESHOLD */
+#define MMEM_COMPACT_THRESHOLD 512
+#endif /* MMEM_CONF_COMPACT_THRESHOLD */
+
+#ifdef MMEM_CONF_COMPACT_STEP
+#define MMEM_COMPACT_STEP MMEM_CONF_COMPACT_STEP
+#else /* MMEM_CONF_COMPACT_STEP */
+#define MMEM_COMPACT_STEP 256
+#endif /* MMEM_CONF_COMPACT_STEP */
+
 /*---------------------------------------------------------------------------*/
 /**
  * \brief      Get a pointer to the managed memory
@@ -83,10 +115,48 @@ struct mmem {
 /* XXX: tagga minne med "interrupt usage", vilke gr att man r
    speciellt varsam under free(). */
 
+/**
+ * Statistics about the managed memory, filled in by mmem_stats().
+ */
+struct mmem_stats {
+  /** Number of free bytes */
+  unsigned int avail;
+  /** Size of the largest contiguous free region */
+  unsigned int largest_free;
+  /** Percentage of the free memory outside the largest free region */
+  unsigned char fragmentation;
+  /** Number of bytes moved by compaction since boot */
+  unsigned long compacted;
+  /** Time spent compacting since boot, in rtimer ticks. Only measured
+      with MMEM_CONF_DEFERRED_COMPACTION, 0 otherwise */
+  unsigned long compact_time;
+};
+
 int  mmem_alloc(struct mmem *m, unsigned int size);
 void mmem_free(struct mmem *);
 void mmem_init(void);
 
+/**
+ * \brief      Compact the managed memory
+ * \param max_bytes Stop before moving more than this many bytes, or 0
+ *             to compact all of the memory
+ * \return     The number of bytes moved
+ *
+ *             This function moves allocated blocks downwards to
+ *             close the holes left by mmem_free(), starting from the
+ *             beginning of the memory. At least one block is moved if
+ *             there is a hole. Without MMEM_CONF_DEFERRED_COMPACTION
+ *             the memory is always compact and this function does
+ *             nothing.
+ */
+unsigned int mmem_compact(unsigned int max_bytes);
+
+/**
+ * \brief      Get statistics about the managed memory
+ * \param stats A pointer to the struct to fill in
+ */
+void mmem_stats(struct mmem_stats *stats);
+
 #endif /* MMEM_H_ */
 
 /** @} */
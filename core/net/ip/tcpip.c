@@ -813,6 +813,9 @@ PROCESS_THREAD(tcpip_process, ev, data)
 {
   PROCESS_BEGIN();
 
+  /* Deliver events to the network stack ahead of application events */
+  process_set_priority(&tcpip_process, PROCESS_PRIORITY_HIGH);
+
 #if UIP_TCP
   {
     unsigned char i;
@@ -70,6 +70,11 @@
 #include "net/ipv6/sicslowpan.h"
 #include "net/netstack.h"
 
+#if UIP_CONF_IPV6_RPL
+#include "net/rpl/rpl.h"
+#include "net/rpl/rpl-private.h"
+#endif /* UIP_CONF_IPV6_RPL */
+
 #include <stdio.h>
 
 #define DEBUG DEBUG_NONE
@@ -251,6 +256,101 @@ static uint16_t my_tag;
 /* Assuming that the worst growth for uncompression is 38 bytes */
 #define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
 
+#if SICSLOWPAN_REASS_POOL
+/* With the reassembly pool, the non-first fragments of all
+ * reassemblies share one byte pool instead of fixed-size fragment
+ * buffers, so that many short fragments do not waste the space of a
+ * full buffer each. The pool defaults to the same amount of RAM as
+ * the fragment buffers. */
+#ifdef SICSLOWPAN_CONF_REASS_POOL_SIZE
+#define SICSLOWPAN_REASS_POOL_SIZE SICSLOWPAN_CONF_REASS_POOL_SIZE
+#else
+#define SICSLOWPAN_REASS_POOL_SIZE \
+  (SICSLOWPAN_FRAGMENT_BUFFERS * SICSLOWPAN_FRAGMENT_SIZE)
+#endif
+
+/* The maximum number of fragments stored in the pool */
+#ifdef SICSLOWPAN_CONF_REASS_POOL_FRAGMENTS
+#define SICSLOWPAN_REASS_POOL_FRAGMENTS SICSLOWPAN_CONF_REASS_POOL_FRAGMENTS
+#else
+#define SICSLOWPAN_REASS_POOL_FRAGMENTS (2 * SICSLOWPAN_FRAGMENT_BUFFERS)
+#endif
+
+/* The maximum number of reassemblies a single sender can have going
+ * on at the same time. A sender that starts a new datagram beyond
+ * this gives up its own least recently active reassembly rather than
+ * taking a context from another sender. */
+#ifdef SICSLOWPAN_CONF_REASS_PER_SENDER
+#define SICSLOWPAN_REASS_PER_SENDER SICSLOWPAN_CONF_REASS_PER_SENDER
+#elif SICSLOWPAN_REASS_CONTEXTS > 1
+#define SICSLOWPAN_REASS_PER_SENDER (SICSLOWPAN_REASS_CONTEXTS / 2)
+#else
+#define SICSLOWPAN_REASS_PER_SENDER 1
+#endif
+
+/* A reassembly that has not received any fragment for this long may
+ * be evicted before its timer expires to make room for a new one.
+ * In the same unit as SICSLOWPAN_REASS_MAXAGE (1/16 s). */
+#ifdef SICSLOWPAN_CONF_REASS_STALE
+#define SICSLOWPAN_REASS_STALE SICSLOWPAN_CONF_REASS_STALE
+#else
+#define SICSLOWPAN_REASS_STALE (SICSLOWPAN_REASS_MAXAGE / 4)
+#endif
+
+struct sicslowpan_reass_stats sicslowpan_reass_stats;
+#define REASS_STAT(x) sicslowpan_reass_stats.x++
+#else /* SICSLOWPAN_REASS_POOL */
+#define REASS_STAT(x)
+#endif /* SICSLOWPAN_REASS_POOL */
+
+/* FRAG_FWD enables per-hop fragment forwarding: a router that is not
+ * the destination of a fragmented datagram forwards each fragment as
+ * soon as it arrives instead of reassembling the whole datagram
+ * first. This must be enabled on all nodes of the network, as it also
+ * makes the sender of a datagram leave FRAG_FWD_HEADROOM bytes free in
+ * the first fragment, for routers that cannot compress the header as
+ * well as the sender did. */
+#ifdef SICSLOWPAN_CONF_FRAG_FWD
+#define SICSLOWPAN_FRAG_FWD SICSLOWPAN_CONF_FRAG_FWD
+#else
+#define SICSLOWPAN_FRAG_FWD 0
+#endif
+
+#if SICSLOWPAN_FRAG_FWD
+#ifdef SICSLOWPAN_CONF_FRAG_FWD_HEADROOM
+#define SICSLOWPAN_FRAG_FWD_HEADROOM SICSLOWPAN_CONF_FRAG_FWD_HEADROOM
+#else
+#define SICSLOWPAN_FRAG_FWD_HEADROOM 8
+#endif
+#else /* SICSLOWPAN_FRAG_FWD */
+#define SICSLOWPAN_FRAG_FWD_HEADROOM 0
+#endif /* SICSLOWPAN_FRAG_FWD */
+
+#if SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER
+/* The number of datagrams that can be forwarded at the same time */
+#ifdef SICSLOWPAN_CONF_FRAG_FWD_ENTRIES
+#define SICSLOWPAN_FRAG_FWD_ENTRIES SICSLOWPAN_CONF_FRAG_FWD_ENTRIES
+#else
+#define SICSLOWPAN_FRAG_FWD_ENTRIES 4
+#endif
+
+/* Switching from the previous hop and tag of a datagram to the next
+   hop and the tag it is forwarded with */
+struct sicslowpan_frag_fwd {
+  linkaddr_t sender;
+  linkaddr_t nexthop;
+  uint16_t tag;
+  uint16_t out_tag;
+  /** Size of the datagram (if zero this entry is not allocated) */
+  uint16_t len;
+  /** Number of bytes of the datagram forwarded so far */
+  uint16_t forwarded_len;
+  struct timer timer;
+};
+
+static struct sicslowpan_frag_fwd frag_fwd[SICSLOWPAN_FRAG_FWD_ENTRIES];
+#endif /* SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER */
+
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
   /** When reassembling, the source address of the fragments being merged */
@@ -265,6 +365,10 @@ struct sicslowpan_frag_info {
   uint16_t reassembled_len;
   /** Reassembly %process %timer. */
   struct timer reass_timer;
+#if SICSLOWPAN_REASS_POOL
+  /** The time the last fragment of this reassembly was received */
+  clock_time_t last_active;
+#endif /* SICSLOWPAN_REASS_POOL */
 
   /** Fragment size of first fragment */
   uint16_t first_frag_len;
@@ -275,6 +379,23 @@ struct sicslowpan_frag_info {
 
 static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
 
+#if SICSLOWPAN_REASS_POOL
+struct sicslowpan_frag_buf {
+  /* the index of the frag_info */
+  uint8_t index;
+  /* Fragment offset */
+  uint8_t offset;
+  /* Length of this fragment */
+  uint8_t len;
+};
+
+/* The fragments frag_buf[0] to frag_buf[frag_count - 1] have their
+   data stored back to back in frag_pool, in the same order. */
+static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_REASS_POOL_FRAGMENTS];
+static uint8_t frag_pool[SICSLOWPAN_REASS_POOL_SIZE];
+static uint8_t frag_count;
+static uint16_t frag_pool_used;
+#else /* SICSLOWPAN_REASS_POOL */
 struct sicslowpan_frag_buf {
   /* the index of the frag_info */
   uint8_t index;
@@ -286,12 +407,41 @@ struct sicslowpan_frag_buf {
 };
 
 static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
+#endif /* SICSLOWPAN_REASS_POOL */
 
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
 {
   int i, clear_count;
+#if SICSLOWPAN_REASS_POOL
+  uint16_t src, dst;
+  uint8_t kept;
+
+  clear_count = 0;
+  frag_info[frag_info_index].len = 0;
+
+  /* Remove the fragments of this context and move the remaining ones
+     down to keep the pool contiguous. */
+  src = dst = 0;
+  kept = 0;
+  for(i = 0; i < frag_count; i++) {
+    if(frag_buf[i].index == frag_info_index) {
+      src += frag_buf[i].len;
+      clear_count++;
+    } else {
+      if(src != dst) {
+        memmove(&frag_pool[dst], &frag_pool[src], frag_buf[i].len);
+      }
+      src += frag_buf[i].len;
+      dst += frag_buf[i].len;
+      frag_buf[kept++] = frag_buf[i];
+    }
+  }
+  frag_count = kept;
+  frag_pool_used = dst;
+  return clear_count;
+#else /* SICSLOWPAN_REASS_POOL */
   clear_count = 0;
   frag_info[frag_info_index].len = 0;
   for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
@@ -302,6 +452,7 @@ clear_fragments(uint8_t frag_info_index)
     }
   }
   return clear_count;
+#endif /* SICSLOWPAN_REASS_POOL */
 }
 /*---------------------------------------------------------------------------*/
 static int
@@ -314,11 +465,112 @@ timeout_fragments(int not_context)
        timer_expired(&frag_info[i].reass_timer)) {
       /* This context can be freed */
       count += clear_fragments(i);
+      REASS_STAT(timeout);
     }
   }
   return count;
 }
 /*---------------------------------------------------------------------------*/
+#if SICSLOWPAN_REASS_POOL
+static clock_time_t
+idle_time(int context)
+{
+  return clock_time() - frag_info[context].last_active;
+}
+/*---------------------------------------------------------------------------*/
+/* Evict the least recently active reassembly other than not_context,
+   if it has been idle long enough to be considered stale. */
+static int
+evict_stale(int not_context)
+{
+  int i;
+  int stale = -1;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(frag_info[i].len > 0 && i != not_context &&
+       (stale < 0 || idle_time(i) > idle_time(stale))) {
+      stale = i;
+    }
+  }
+  if(stale >= 0 &&
+     idle_time(stale) >= SICSLOWPAN_REASS_STALE * CLOCK_SECOND / 16) {
+    PRINTF("*** Evicting stale reassembly - tag: %d\n", frag_info[stale].tag);
+    REASS_STAT(evicted);
+    clear_fragments(stale);
+    return stale;
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Find a context for a new reassembly from sender */
+static int8_t
+alloc_context(const linkaddr_t *sender)
+{
+  int i;
+  int8_t found = -1;
+  int8_t own = -1;
+  int own_count = 0;
+
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    /* clear all fragment info with expired timer to free all fragment buffers */
+    if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
+      clear_fragments(i);
+      REASS_STAT(timeout);
+    }
+
+    if(frag_info[i].len == 0) {
+      if(found < 0) {
+        found = i;
+      }
+    } else if(linkaddr_cmp(&frag_info[i].sender, sender)) {
+      own_count++;
+      if(own < 0 || idle_time(i) > idle_time(own)) {
+        own = i;
+      }
+    }
+  }
+
+  if(own_count >= SICSLOWPAN_REASS_PER_SENDER) {
+    /* The sender is at its quota: it is more likely to have given up
+       on its oldest datagram than to still be sending it. */
+    PRINTF("*** Sender over reassembly quota - dropping tag: %d\n",
+           frag_info[own].tag);
+    REASS_STAT(quota);
+    clear_fragments(own);
+    return own;
+  }
+
+  if(found < 0) {
+    found = evict_stale(-1);
+  }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+static int
+store_fragment(uint8_t index, uint8_t offset)
+{
+  uint8_t len;
+
+  len = packetbuf_datalen() - packetbuf_hdr_len;
+  if(frag_count >= SICSLOWPAN_REASS_POOL_FRAGMENTS ||
+     frag_pool_used + len > SICSLOWPAN_REASS_POOL_SIZE) {
+    /* failed */
+    return -1;
+  }
+
+  /* copy over the data from packetbuf to the end of the pool */
+  frag_buf[frag_count].offset = offset; /* frag offset */
+  frag_buf[frag_count].len = len;
+  frag_buf[frag_count].index = index;
+  memcpy(&frag_pool[frag_pool_used], packetbuf_ptr + packetbuf_hdr_len, len);
+  frag_pool_used += len;
+  frag_count++;
+
+  PRINTF("Fragsize: %d\n", len);
+  /* return the length of the stored fragment */
+  return len;
+}
+#else /* SICSLOWPAN_REASS_POOL */
 static int
 store_fragment(uint8_t index, uint8_t offset)
 {
@@ -340,6 +592,7 @@ store_fragment(uint8_t index, uint8_t offset)
   /* failed */
   return -1;
 }
+#endif /* SICSLOWPAN_REASS_POOL */
 /*---------------------------------------------------------------------------*/
 /* add a new fragment to the buffer */
 static int8_t
@@ -351,6 +604,9 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 
   if(offset == 0) {
     /* This is a first fragment - check if we can add this */
+#if SICSLOWPAN_REASS_POOL
+    found = alloc_context(packetbuf_addr(PACKETBUF_ADDR_SENDER));
+#else /* SICSLOWPAN_REASS_POOL */
     for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
       /* clear all fragment info with expired timer to free all fragment buffers */
       if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
@@ -364,9 +620,11 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
         found = i;
       }
     }
+#endif /* SICSLOWPAN_REASS_POOL */
 
     if(found < 0) {
       PRINTF("*** Failed to store new fragment session - tag: %d\n", tag);
+      REASS_STAT(no_context);
       return -1;
     }
 
@@ -376,6 +634,9 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
     linkaddr_copy(&frag_info[found].sender,
                   packetbuf_addr(PACKETBUF_ADDR_SENDER));
     timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+#if SICSLOWPAN_REASS_POOL
+    frag_info[found].last_active = clock_time();
+#endif /* SICSLOWPAN_REASS_POOL */
     /* first fragment can not be stored immediately but is moved into
        the buffer while uncompressing */
     return found;
@@ -394,6 +655,7 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
   if(found < 0) {
     /* no entry found for storing the new fragment */
     PRINTF("*** Failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
+    REASS_STAT(orphan);
     return -1;
   }
 
@@ -402,13 +664,25 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
   if(len < 0 && timeout_fragments(i) > 0) {
     len = store_fragment(i, offset);
   }
+#if SICSLOWPAN_REASS_POOL
+  while(len < 0 && evict_stale(i) >= 0) {
+    len = store_fragment(i, offset);
+  }
+#endif /* SICSLOWPAN_REASS_POOL */
   if(len > 0) {
     frag_info[i].reassembled_len += len;
+#if SICSLOWPAN_REASS_POOL
+    frag_info[i].last_active = clock_time();
+#endif /* SICSLOWPAN_REASS_POOL */
     return i;
   } else {
-    /* should we also clear all fragments since we failed to store
-       this fragment? */
     PRINTF("*** Failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
+#if SICSLOWPAN_REASS_POOL
+    /* The datagram can no longer be completed, so release what it
+       holds in the pool for the other reassemblies. */
+    REASS_STAT(no_buffer);
+    clear_fragments(i);
+#endif /* SICSLOWPAN_REASS_POOL */
     return -1;
   }
 }
@@ -423,6 +697,18 @@ copy_frags2uip(int context)
   /* Copy from the fragment context info buffer first */
   memcpy((uint8_t *)UIP_IP_BUF, (uint8_t *)frag_info[context].first_frag,
 	 frag_info[context].first_frag_len);
+#if SICSLOWPAN_REASS_POOL
+  {
+    uint16_t pos = 0;
+    for(i = 0; i < frag_count; i++) {
+      if(frag_buf[i].index == context) {
+        memcpy((uint8_t *)UIP_IP_BUF + (uint16_t)(frag_buf[i].offset << 3),
+               &frag_pool[pos], frag_buf[i].len);
+      }
+      pos += frag_buf[i].len;
+    }
+  }
+#else /* SICSLOWPAN_REASS_POOL */
   for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
     /* And also copy all matching fragments */
     if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
@@ -430,6 +716,7 @@ copy_frags2uip(int context)
 	     (uint8_t *)frag_buf[i].data, frag_buf[i].len);
     }
   }
+#endif /* SICSLOWPAN_REASS_POOL */
   /* deallocate all the fragments for this context */
   clear_fragments(context);
 }
@@ -532,10 +819,51 @@ const uint8_t llprefix[] = {0xfe, 0x80};
 /* TTL uncompression values */
 static const uint8_t ttl_values[] = {0, 1, 64, 255};
 
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+/* How long a context is kept for decompression only after the end of
+   its lifetime, in seconds (RFC 6775, section 7.2) */
+#ifdef SICSLOWPAN_CONF_CONTEXT_GRACE
+#define SICSLOWPAN_CONTEXT_GRACE SICSLOWPAN_CONF_CONTEXT_GRACE
+#else
+#define SICSLOWPAN_CONTEXT_GRACE 3600
+#endif
+
+#define CONTEXT_USABLE(c) (context_valid(c) && (c)->compress)
+#define CONTEXT_VALID(c)  context_valid(c)
+#else /* SICSLOWPAN_DYNAMIC_CONTEXTS */
+#define CONTEXT_USABLE(c) ((c)->used == 1)
+#define CONTEXT_VALID(c)  ((c)->used == 1)
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
+
 /*--------------------------------------------------------------------*/
 /** \name IPHC related functions
  * @{                                                                 */
 /*--------------------------------------------------------------------*/
+#if SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+/* Check the lifetime of a context. At the end of its lifetime, a
+   context is first only kept for decompression, then removed. */
+static int
+context_valid(struct sicslowpan_addr_context *c)
+{
+  if(c->used && !c->isinfinite && stimer_expired(&c->lifetime)) {
+    if(c->compress) {
+      c->compress = 0;
+      stimer_set(&c->lifetime, SICSLOWPAN_CONTEXT_GRACE);
+    } else {
+      c->used = 0;
+    }
+  }
+  return c->used;
+}
+/*--------------------------------------------------------------------*/
+static void
+context_hit(struct sicslowpan_addr_context *c, uint8_t inline_len)
+{
+  c->hits++;
+  c->saved += sizeof(uip_ipaddr_t) - inline_len;
+}
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
+/*--------------------------------------------------------------------*/
 /** \brief find the context corresponding to prefix ipaddr */
 static struct sicslowpan_addr_context*
 addr_context_lookup_by_prefix(uip_ipaddr_t *ipaddr)
@@ -544,7 +872,7 @@ addr_context_lookup_by_prefix(uip_ipaddr_t *ipaddr)
 #if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
   int i;
   for(i = 0; i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
-    if((addr_contexts[i].used == 1) &&
+    if(CONTEXT_USABLE(&addr_contexts[i]) &&
        uip_ipaddr_prefixcmp(&addr_contexts[i].prefix, ipaddr, 64)) {
       return &addr_contexts[i];
     }
@@ -561,7 +889,7 @@ addr_context_lookup_by_number(uint8_t number)
 #if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
   int i;
   for(i = 0; i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
-    if((addr_contexts[i].used == 1) &&
+    if(CONTEXT_VALID(&addr_contexts[i]) &&
        addr_contexts[i].number == number) {
       return &addr_contexts[i];
     }
@@ -669,6 +997,9 @@ static void
 compress_hdr_iphc(linkaddr_t *link_destaddr)
 {
   uint8_t tmp, iphc0, iphc1;
+#if SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+  uint8_t *addr_ptr;
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
 #if DEBUG
   { uint16_t ndx;
     PRINTF("before compression (%d): ", UIP_IP_BUF->len[1]);
@@ -805,8 +1136,14 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
     PACKETBUF_IPHC_BUF[2] |= context->number << 4;
     /* compession compare with this nodes address (source) */
 
+#if SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+    addr_ptr = hc06_ptr;
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
     iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_SAM_BIT,
                               &UIP_IP_BUF->srcipaddr, &uip_lladdr);
+#if SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+    context_hit(context, hc06_ptr - addr_ptr);
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
     /* No context found for this address */
   } else if(uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) &&
             UIP_IP_BUF->destipaddr.u16[1] == 0 &&
@@ -856,9 +1193,15 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
       PACKETBUF_IPHC_BUF[2] |= context->number;
       /* compession compare with link adress (destination) */
 
+#if SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+      addr_ptr = hc06_ptr;
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
       iphc1 |= compress_addr_64(SICSLOWPAN_IPHC_DAM_BIT,
                                 &UIP_IP_BUF->destipaddr,
                                 (uip_lladdr_t *)link_destaddr);
+#if SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+      context_hit(context, hc06_ptr - addr_ptr);
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
       /* No context found for this address */
     } else if(uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) &&
               UIP_IP_BUF->destipaddr.u16[1] == 0 &&
@@ -1262,6 +1605,29 @@ send_packet(linkaddr_t *dest)
   watchdog_periodic();
 }
 /*--------------------------------------------------------------------*/
+/* The room left for 6lowpan headers and payload in a frame to dest */
+static int
+get_max_payload(const linkaddr_t *dest)
+{
+  int framer_hdrlen;
+
+  /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_RDC.
+   * We calculate it here only to make a better decision of whether the outgoing packet
+   * needs to be fragmented or not. */
+#ifndef SICSLOWPAN_USE_FIXED_HDRLEN
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  framer_hdrlen = NETSTACK_FRAMER.length();
+  if(framer_hdrlen < 0) {
+    /* Framing failed, we assume the maximum header length */
+    framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+  }
+#else /* USE_FRAMER_HDRLEN */
+  framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
+#endif /* USE_FRAMER_HDRLEN */
+
+  return MAC_MAX_PAYLOAD - framer_hdrlen;
+}
+/*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
  *  network using 6lowpan.
  *  \param localdest The MAC address of the destination
@@ -1274,7 +1640,6 @@ send_packet(linkaddr_t *dest)
 static uint8_t
 output(const uip_lladdr_t *localdest)
 {
-  int framer_hdrlen;
   int max_payload;
 
   /* The MAC address of the destination of the packet */
@@ -1337,21 +1702,7 @@ output(const uip_lladdr_t *localdest)
   }
   PRINTFO("sicslowpan output: header of len %d\n", packetbuf_hdr_len);
 
-  /* Calculate NETSTACK_FRAMER's header length, that will be added in the NETSTACK_RDC.
-   * We calculate it here only to make a better decision of whether the outgoing packet
-   * needs to be fragmented or not. */
-#ifndef SICSLOWPAN_USE_FIXED_HDRLEN
-  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &dest);
-  framer_hdrlen = NETSTACK_FRAMER.length();
-  if(framer_hdrlen < 0) {
-    /* Framing failed, we assume the maximum header length */
-    framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
-  }
-#else /* USE_FRAMER_HDRLEN */
-  framer_hdrlen = SICSLOWPAN_FIXED_HDRLEN;
-#endif /* USE_FRAMER_HDRLEN */
-
-  max_payload = MAC_MAX_PAYLOAD - framer_hdrlen;
+  max_payload = get_max_payload(&dest);
   if((int)uip_len - (int)uncomp_hdr_len > max_payload - (int)packetbuf_hdr_len) {
 #if SICSLOWPAN_CONF_FRAG
     /* Number of bytes processed. */
@@ -1399,7 +1750,8 @@ output(const uip_lladdr_t *localdest)
 
     /* Copy payload and send */
     packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
-    packetbuf_payload_len = (max_payload - packetbuf_hdr_len) & 0xfffffff8;
+    packetbuf_payload_len = (max_payload - packetbuf_hdr_len -
+                             SICSLOWPAN_FRAG_FWD_HEADROOM) & 0xfffffff8;
     PRINTFO("(len %d, tag %d)\n", packetbuf_payload_len, frag_tag);
     memcpy(packetbuf_ptr + packetbuf_hdr_len,
            (uint8_t *)UIP_IP_BUF + uncomp_hdr_len, packetbuf_payload_len);
@@ -1487,6 +1839,254 @@ output(const uip_lladdr_t *localdest)
   return 1;
 }
 
+/*--------------------------------------------------------------------*/
+#if SICSLOWPAN_CONF_FRAG && SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER
+#define FWD_LOCAL   0
+#define FWD_NEXTHOP 1
+#define FWD_DROP    2
+/* Make the routing decision for the header of a datagram in uip_buf,
+   of which only the first uip_len bytes are there, so that the header
+   processing never reads or moves more than that. Returns FWD_NEXTHOP
+   with the link-layer address of the next hop in lladdr if the
+   datagram can be forwarded fragment by fragment, FWD_LOCAL if it has
+   to be reassembled first, and FWD_DROP if it is to be dropped. */
+static int
+fwd_route(const uip_lladdr_t **lladdr)
+{
+  uip_ipaddr_t *nexthop = NULL;
+  uip_ds6_route_t *route;
+  uip_ds6_nbr_t *nbr;
+#if UIP_CONF_IPV6_RPL
+  uint16_t datagram_len;
+#endif /* UIP_CONF_IPV6_RPL */
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+  uip_ipaddr_t ipaddr;
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
+
+  /* Only the headers that RPL may have to process and update on the
+     way are checked, and they must be in the first fragment. */
+  uip_ext_len = 0;
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO ||
+     UIP_IP_BUF->proto == UIP_PROTO_ROUTING) {
+    if(uip_len < UIP_IPH_LEN + 8 ||
+       uip_len < UIP_IPH_LEN + (((struct uip_ext_hdr *)(UIP_IP_BUF + 1))->len << 3) + 8) {
+      return FWD_LOCAL;
+    }
+  }
+
+  if(UIP_IP_BUF->proto == UIP_PROTO_HBHO) {
+#if UIP_CONF_IPV6_RPL
+    if(((uint8_t *)(UIP_IP_BUF + 1))[2] != UIP_EXT_HDR_OPT_RPL) {
+      return FWD_LOCAL;
+    }
+    if(!rpl_verify_hbh_header(2)) {
+      return FWD_DROP;
+    }
+#else /* UIP_CONF_IPV6_RPL */
+    return FWD_LOCAL;
+#endif /* UIP_CONF_IPV6_RPL */
+  }
+
+  if(uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr)) {
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+    /* We are the next hop in a source route */
+    if(UIP_IP_BUF->proto != UIP_PROTO_ROUTING ||
+       ((struct uip_routing_hdr *)(UIP_IP_BUF + 1))->seg_left == 0 ||
+       !rpl_process_srh_header()) {
+      return FWD_LOCAL;
+    }
+#else /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
+    return FWD_LOCAL;
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
+  }
+
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr) ||
+     uip_is_addr_loopback(&UIP_IP_BUF->destipaddr) ||
+     uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr)) {
+    return FWD_LOCAL;
+  }
+
+  if(UIP_IP_BUF->ttl <= 1) {
+    /* Let the IP layer send the ICMP error */
+    return FWD_LOCAL;
+  }
+  UIP_IP_BUF->ttl = UIP_IP_BUF->ttl - 1;
+
+#if UIP_CONF_IPV6_RPL
+  datagram_len = uip_len;
+  if(!rpl_update_header()) {
+    return FWD_DROP;
+  }
+  if(uip_len != datagram_len) {
+    /* RPL has added or removed a header, so that the offsets in the
+       following fragments no longer apply */
+    return FWD_LOCAL;
+  }
+#endif /* UIP_CONF_IPV6_RPL */
+
+  /* Next hop determination, as in tcpip_ipv6_output() */
+#if UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING
+  if(rpl_srh_get_next_hop(&ipaddr)) {
+    nexthop = &ipaddr;
+  }
+#endif /* UIP_CONF_IPV6_RPL && RPL_WITH_NON_STORING */
+  if(nexthop == NULL && uip_ds6_is_addr_onlink(&UIP_IP_BUF->destipaddr)) {
+    nexthop = &UIP_IP_BUF->destipaddr;
+  }
+  if(nexthop == NULL) {
+    route = uip_ds6_route_lookup(&UIP_IP_BUF->destipaddr);
+    if(route == NULL) {
+      nexthop = uip_ds6_defrt_choose();
+    } else {
+      nexthop = uip_ds6_route_nexthop(route);
+    }
+  }
+  if(nexthop == NULL) {
+    return FWD_LOCAL;
+  }
+
+  nbr = uip_ds6_nbr_lookup(nexthop);
+#if UIP_ND6_SEND_NS
+  if(nbr != NULL && nbr->state == NBR_INCOMPLETE) {
+    nbr = NULL;
+  }
+#endif /* UIP_ND6_SEND_NS */
+  if(nbr == NULL || (*lladdr = uip_ds6_nbr_get_ll(nbr)) == NULL) {
+    /* Leave neighbor discovery to the IP layer */
+    return FWD_LOCAL;
+  }
+
+  return FWD_NEXTHOP;
+}
+/*--------------------------------------------------------------------*/
+/* Forward the first fragment of a datagram, which has been
+   uncompressed into a reassembly context, unless it is for us. Returns
+   zero if the datagram is to be reassembled. */
+static int
+fwd_first_fragment(int context, uint16_t tag, uint16_t len)
+{
+  struct sicslowpan_frag_fwd *fwd;
+  const uip_lladdr_t *lladdr;
+  uint16_t first_frag_len;
+  int i;
+
+  fwd = NULL;
+  for(i = 0; i < SICSLOWPAN_FRAG_FWD_ENTRIES; i++) {
+    if(frag_fwd[i].len == 0 || timer_expired(&frag_fwd[i].timer)) {
+      fwd = &frag_fwd[i];
+      break;
+    }
+  }
+  if(fwd == NULL) {
+    return 0;
+  }
+
+  /* Route a copy of the header, so that the context is left unchanged
+     if the datagram has to be reassembled after all. The IP length
+     field still gives the length of the whole datagram. */
+  first_frag_len = frag_info[context].first_frag_len;
+  memcpy(UIP_IP_BUF, frag_info[context].first_frag, first_frag_len);
+  uip_len = first_frag_len;
+  switch(fwd_route(&lladdr)) {
+  case FWD_NEXTHOP:
+    break;
+  case FWD_DROP:
+    uip_clear_buf();
+    clear_fragments(context);
+    return 1;
+  default:
+    uip_clear_buf();
+    return 0;
+  }
+
+  uncomp_hdr_len = 0;
+  packetbuf_hdr_len = 0;
+  linkaddr_copy(&fwd->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  linkaddr_copy(&fwd->nexthop, (const linkaddr_t *)lladdr);
+
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6
+  compress_hdr_ipv6(&fwd->nexthop);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPV6 */
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  compress_hdr_iphc(&fwd->nexthop);
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+
+  if(uncomp_hdr_len > first_frag_len ||
+     SICSLOWPAN_FRAG1_HDR_LEN + packetbuf_hdr_len + first_frag_len - uncomp_hdr_len >
+     get_max_payload(&fwd->nexthop)) {
+    /* The header compresses less well than it did for the previous
+       hop, and the first fragment no longer fits in a frame */
+    PRINTF("sicslowpan: first fragment does not fit, reassembling\n");
+    uip_clear_buf();
+    return 0;
+  }
+
+  fwd->tag = tag;
+  fwd->out_tag = my_tag++;
+  fwd->len = len;
+  fwd->forwarded_len = first_frag_len;
+  timer_set(&fwd->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  memmove(packetbuf_ptr + SICSLOWPAN_FRAG1_HDR_LEN, packetbuf_ptr, packetbuf_hdr_len);
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAG1 << 8) | len));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, fwd->out_tag);
+  packetbuf_hdr_len += SICSLOWPAN_FRAG1_HDR_LEN;
+  /* The rest of the first fragment comes from the routed copy, which
+     carries the updated RPL option and source routing header */
+  memcpy(packetbuf_ptr + packetbuf_hdr_len,
+         (uint8_t *)UIP_IP_BUF + uncomp_hdr_len,
+         first_frag_len - uncomp_hdr_len);
+  packetbuf_set_datalen(packetbuf_hdr_len + first_frag_len - uncomp_hdr_len);
+  uip_clear_buf();
+
+  PRINTF("sicslowpan: forwarding tag %u as %u\n", tag, fwd->out_tag);
+  UIP_STAT(++uip_stat.ip.forwarded);
+  clear_fragments(context);
+  send_packet(&fwd->nexthop);
+  return 1;
+}
+/*--------------------------------------------------------------------*/
+/* Forward a subsequent fragment of a datagram whose first fragment
+   has been forwarded. Returns zero if there is no such datagram. */
+static int
+fwd_next_fragment(uint16_t tag)
+{
+  struct sicslowpan_frag_fwd *fwd;
+  int i;
+
+  fwd = NULL;
+  for(i = 0; i < SICSLOWPAN_FRAG_FWD_ENTRIES; i++) {
+    if(frag_fwd[i].len > 0 && frag_fwd[i].tag == tag &&
+       !timer_expired(&frag_fwd[i].timer) &&
+       linkaddr_cmp(&frag_fwd[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+      fwd = &frag_fwd[i];
+      break;
+    }
+  }
+  if(fwd == NULL) {
+    return 0;
+  }
+
+  fwd->forwarded_len += packetbuf_datalen() - SICSLOWPAN_FRAGN_HDR_LEN;
+  if(fwd->forwarded_len >= fwd->len) {
+    /* This was the last one */
+    fwd->len = 0;
+  }
+
+  /* Send the fragment on as is, only with our tag */
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, fwd->out_tag);
+  packetbuf_compact();
+  packetbuf_attr_clear();
+  send_packet(&fwd->nexthop);
+  return 1;
+}
+#endif /* SICSLOWPAN_CONF_FRAG && SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER */
 /*--------------------------------------------------------------------*/
 /** \brief Process a received 6lowpan packet.
  *
@@ -1578,6 +2178,12 @@ input(void)
              frag_size, frag_tag, frag_offset);
       packetbuf_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
 
+#if SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER
+      if(fwd_next_fragment(frag_tag)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER */
+
       /* If this is the last fragment, we may shave off any extrenous
          bytes at the end. We must be liberal in what we accept. */
       PRINTFI("last_fragment?: packetbuf_payload_len %d frag_size %d\n",
@@ -1680,6 +2286,11 @@ input(void)
     if(first_fragment != 0) {
       frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
       frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+#if SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER
+      if(fwd_first_fragment(frag_context, frag_tag, frag_size)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FWD && UIP_CONF_ROUTER */
     }
     /* For the last fragment, we are OK if there is extrenous bytes at
        the end of the packet. */
@@ -1787,6 +2398,20 @@ sicslowpan_init(void)
   }
 #endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 1 */
 
+#if SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+  /* Preinitialized contexts are used for compression and never expire */
+  {
+    int i;
+    for(i = 0; i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
+      if(addr_contexts[i].used) {
+        addr_contexts[i].length = 64;
+        addr_contexts[i].compress = 1;
+        addr_contexts[i].isinfinite = 1;
+      }
+    }
+  }
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
+
 #endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
 }
 /*--------------------------------------------------------------------*/
@@ -1795,6 +2420,80 @@ sicslowpan_get_last_rssi(void)
 {
   return last_rssi;
 }
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+/*--------------------------------------------------------------------*/
+int
+sicslowpan_context_set(uint8_t number, const uip_ipaddr_t *prefix,
+                       uint8_t length, uint8_t compress, uint16_t lifetime)
+{
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+  struct sicslowpan_addr_context *c;
+  int i;
+
+  if(number > 15 || length > 64) {
+    /* Only the first 64 bits of the address are compressed with a
+       context */
+    return 0;
+  }
+  if(lifetime == 0) {
+    sicslowpan_context_rm(number);
+    return 1;
+  }
+
+  c = addr_context_lookup_by_number(number);
+  if(c == NULL) {
+    for(i = 0; i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
+      if(!CONTEXT_VALID(&addr_contexts[i])) {
+        c = &addr_contexts[i];
+        c->hits = 0;
+        c->saved = 0;
+        break;
+      }
+    }
+    if(c == NULL) {
+      PRINTF("sicslowpan: no room for context %u\n", number);
+      return 0;
+    }
+  }
+
+  c->used = 1;
+  c->number = number;
+  memset(c->prefix, 0, sizeof(c->prefix));
+  memcpy(c->prefix, prefix, length >> 3);
+  if(length & 7) {
+    c->prefix[length >> 3] = prefix->u8[length >> 3] & (0xff << (8 - (length & 7)));
+  }
+  c->length = length;
+  c->compress = compress != 0;
+  c->isinfinite = 0;
+  stimer_set(&c->lifetime, (unsigned long)lifetime * 60);
+  return 1;
+#else /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
+  return 0;
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
+}
+/*--------------------------------------------------------------------*/
+void
+sicslowpan_context_rm(uint8_t number)
+{
+  struct sicslowpan_addr_context *c;
+
+  c = sicslowpan_context_lookup(number);
+  if(c != NULL) {
+    c->used = 0;
+  }
+}
+/*--------------------------------------------------------------------*/
+struct sicslowpan_addr_context *
+sicslowpan_context_lookup(uint8_t number)
+{
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06
+  return addr_context_lookup_by_number(number);
+#else /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+  return NULL;
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_HC06 */
+}
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
 /*--------------------------------------------------------------------*/
 const struct network_driver sicslowpan_driver = {
   "sicslowpan",
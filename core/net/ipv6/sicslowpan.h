@@ -215,6 +215,22 @@
 /*   uint16_t udpchksum; */
 /* }; */
 
+/**
+ * \brief Manage the address contexts at runtime: contexts can be set
+ * with sicslowpan_context_set() or learned from the 6CO option of
+ * Router Advertisements, have a lifetime, and count how much they are
+ * used. Requires IPHC compression.
+ */
+#ifdef SICSLOWPAN_CONF_DYNAMIC_CONTEXTS
+#define SICSLOWPAN_DYNAMIC_CONTEXTS SICSLOWPAN_CONF_DYNAMIC_CONTEXTS
+#else
+#define SICSLOWPAN_DYNAMIC_CONTEXTS 0
+#endif
+
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+#include "sys/stimer.h"
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
+
 /**
  * \brief An address context for IPHC address compression
  * each context can have upto 8 bytes
@@ -223,6 +239,19 @@ struct sicslowpan_addr_context {
   uint8_t used; /* possibly use as prefix-length */
   uint8_t number;
   uint8_t prefix[8];
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+  /** Length of the prefix in bits, at most 64 */
+  uint8_t length;
+  /** Non-zero if the context may be used for compression and not
+      only for decompression (the C flag of the 6CO option) */
+  uint8_t compress;
+  uint8_t isinfinite;
+  struct stimer lifetime;
+  /** Number of addresses compressed with this context */
+  uint32_t hits;
+  /** Number of bytes saved by compressing addresses with this context */
+  uint32_t saved;
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
 };
 
 /**
@@ -319,8 +348,67 @@ struct sicslowpan_nh_compressor {
 
 };
 
+/**
+ * \brief Share one byte pool between the fragments of all concurrent
+ * reassemblies, with a per-sender quota, early eviction of stale
+ * reassemblies and drop counters.
+ */
+#ifdef SICSLOWPAN_CONF_REASS_POOL
+#define SICSLOWPAN_REASS_POOL SICSLOWPAN_CONF_REASS_POOL
+#else
+#define SICSLOWPAN_REASS_POOL 0
+#endif
+
+#if SICSLOWPAN_REASS_POOL
+/** Number of datagrams dropped during reassembly, by reason */
+struct sicslowpan_reass_stats {
+  /** The reassembly timer expired */
+  uint16_t timeout;
+  /** Stale reassembly evicted to make room for another one */
+  uint16_t evicted;
+  /** The sender started more reassemblies than its quota */
+  uint16_t quota;
+  /** No reassembly context available for a first fragment */
+  uint16_t no_context;
+  /** No room left in the pool for a fragment */
+  uint16_t no_buffer;
+  /** Fragment that does not belong to any ongoing reassembly */
+  uint16_t orphan;
+};
+
+extern struct sicslowpan_reass_stats sicslowpan_reass_stats;
+#endif /* SICSLOWPAN_REASS_POOL */
+
 int sicslowpan_get_last_rssi(void);
 
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+/**
+ * \brief Add or update an address context
+ * \param number The context identifier, 0 to 15
+ * \param prefix The prefix of the context
+ * \param length The length of the prefix in bits, at most 64
+ * \param compress Non-zero if the context may be used for compression,
+ * zero if it may only be used for decompression
+ * \param lifetime The lifetime of the context in minutes, as in the
+ * 6CO option. Zero removes the context.
+ * \return Non-zero on success, zero if the context table is full or
+ * the parameters are not supported
+ */
+int sicslowpan_context_set(uint8_t number, const uip_ipaddr_t *prefix,
+                           uint8_t length, uint8_t compress,
+                           uint16_t lifetime);
+
+/** \brief Remove an address context */
+void sicslowpan_context_rm(uint8_t number);
+
+/**
+ * \brief Get an address context
+ * \param number The context identifier
+ * \return The context, or NULL if there is no such context
+ */
+struct sicslowpan_addr_context *sicslowpan_context_lookup(uint8_t number);
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
+
 extern const struct network_driver sicslowpan_driver;
 
 #endif /* SICSLOWPAN_H_ */
@@ -75,6 +75,13 @@ MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 static int num_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+#if UIP_DS6_ROUTE_HASH
+/* Host routes, chained per bucket through hash_next */
+static uip_ds6_route_t *route_hash[UIP_DS6_ROUTE_HASH_SIZE];
+/* Routes shorter than 128 bits, chained through hash_next */
+static uip_ds6_route_t *prefix_routes;
+#endif /* UIP_DS6_ROUTE_HASH */
+
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -119,6 +126,44 @@ assert_nbr_routes_list_sane(void)
 }
 #endif /* DEBUG != DEBUG_NONE */
 /*---------------------------------------------------------------------------*/
+#if UIP_DS6_ROUTE_HASH && (UIP_CONF_MAX_ROUTES != 0)
+static uip_ds6_route_t **
+route_chain(const uip_ipaddr_t *addr, uint8_t length)
+{
+  int i;
+  unsigned hash;
+
+  if(length < 128) {
+    return &prefix_routes;
+  }
+  hash = 0;
+  for(i = 0; i < 8; i++) {
+    hash = hash * 31 + addr->u16[i];
+  }
+  return &route_hash[hash & (UIP_DS6_ROUTE_HASH_SIZE - 1)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+route_hash_add(uip_ds6_route_t *r)
+{
+  uip_ds6_route_t **chain = route_chain(&r->ipaddr, r->length);
+  r->hash_next = *chain;
+  *chain = r;
+}
+/*---------------------------------------------------------------------------*/
+static void
+route_hash_rm(uip_ds6_route_t *r)
+{
+  uip_ds6_route_t **p;
+  for(p = route_chain(&r->ipaddr, r->length); *p != NULL; p = &(*p)->hash_next) {
+    if(*p == r) {
+      *p = r->hash_next;
+      return;
+    }
+  }
+}
+#endif /* UIP_DS6_ROUTE_HASH && (UIP_CONF_MAX_ROUTES != 0) */
+/*---------------------------------------------------------------------------*/
 #if UIP_DS6_NOTIFICATIONS
 static void
 call_route_callback(int event, uip_ipaddr_t *route,
@@ -162,6 +207,10 @@ uip_ds6_route_init(void)
 #if (UIP_CONF_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+#if UIP_DS6_ROUTE_HASH
+  memset(route_hash, 0, sizeof(route_hash));
+  prefix_routes = NULL;
+#endif /* UIP_DS6_ROUTE_HASH */
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -265,6 +314,24 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
 
   found_route = NULL;
   longestmatch = 0;
+#if UIP_DS6_ROUTE_HASH
+  /* A host route is always the longest match. */
+  for(r = *route_chain(addr, 128); r != NULL; r = r->hash_next) {
+    if(uip_ipaddr_cmp(addr, &r->ipaddr)) {
+      found_route = r;
+      break;
+    }
+  }
+  if(found_route == NULL) {
+    for(r = prefix_routes; r != NULL; r = r->hash_next) {
+      if(r->length >= longestmatch &&
+         uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+        longestmatch = r->length;
+        found_route = r;
+      }
+    }
+  }
+#else /* UIP_DS6_ROUTE_HASH */
   for(r = uip_ds6_route_head();
       r != NULL;
       r = uip_ds6_route_next(r)) {
@@ -278,6 +345,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
       }
     }
   }
+#endif /* UIP_DS6_ROUTE_HASH */
 
   if(found_route != NULL) {
     PRINTF("uip-ds6-route: Found route: ");
@@ -289,6 +357,10 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     PRINTF("uip-ds6-route: No route found\n");
   }
 
+#if !UIP_DS6_ROUTE_HASH || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
+  /* With the hash index, the list order only matters for evicting the
+     least recently used route, so the list is not reordered unless
+     that is enabled. */
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
@@ -298,6 +370,7 @@ uip_ds6_route_lookup(uip_ipaddr_t *addr)
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* !UIP_DS6_ROUTE_HASH || UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
 
   return found_route;
 #else /* (UIP_CONF_MAX_ROUTES != 0) */
@@ -436,6 +509,9 @@ uip_ds6_route_add(uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+#if UIP_DS6_ROUTE_HASH
+  route_hash_add(r);
+#endif /* UIP_DS6_ROUTE_HASH */
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -479,6 +555,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
 
     /* Remove the route from the route list */
     list_remove(routelist, route);
+#if UIP_DS6_ROUTE_HASH
+    route_hash_rm(route);
+#endif /* UIP_DS6_ROUTE_HASH */
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
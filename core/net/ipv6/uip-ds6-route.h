@@ -88,6 +88,23 @@ void uip_ds6_notification_rm(struct uip_ds6_notification *n);
 #define UIP_DS6_ROUTE_NB 4
 #endif /* UIP_CONF_MAX_ROUTES */
 
+/* Index host (/128) routes in a hash table so that route lookups do
+   not scan the whole routing table. Routes with shorter prefixes are
+   kept on a separate chain that is searched when no host route
+   matches. */
+#ifdef UIP_DS6_ROUTE_CONF_HASH
+#define UIP_DS6_ROUTE_HASH UIP_DS6_ROUTE_CONF_HASH
+#else /* UIP_DS6_ROUTE_CONF_HASH */
+#define UIP_DS6_ROUTE_HASH 0
+#endif /* UIP_DS6_ROUTE_CONF_HASH */
+
+/* Number of hash buckets for host routes, must be a power of two */
+#ifdef UIP_DS6_ROUTE_CONF_HASH_SIZE
+#define UIP_DS6_ROUTE_HASH_SIZE UIP_DS6_ROUTE_CONF_HASH_SIZE
+#else /* UIP_DS6_ROUTE_CONF_HASH_SIZE */
+#define UIP_DS6_ROUTE_HASH_SIZE 64
+#endif /* UIP_DS6_ROUTE_CONF_HASH_SIZE */
+
 /** \brief define some additional RPL related route state and
  *  neighbor callback for RPL - if not a DS6_ROUTE_STATE is already set */
 #ifndef UIP_DS6_ROUTE_STATE_TYPE
@@ -153,6 +170,11 @@ typedef struct uip_ds6_route {
      belong to the neighbor table entry that this routing table entry
      uses. */
   struct uip_ds6_route_neighbor_routes *neighbor_routes;
+#if UIP_DS6_ROUTE_HASH
+  /* Next route in the same hash bucket, or on the prefix route chain
+     for routes shorter than 128 bits. */
+  struct uip_ds6_route *hash_next;
+#endif /* UIP_DS6_ROUTE_HASH */
   uip_ipaddr_t ipaddr;
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   UIP_DS6_ROUTE_STATE_TYPE state;
@@ -73,6 +73,7 @@
 #include "net/ipv6/uip-nd6.h"
 #include "net/ipv6/uip-ds6.h"
 #include "net/ip/uip-nameserver.h"
+#include "net/ipv6/sicslowpan.h"
 #include "lib/random.h"
 
 /*------------------------------------------------------------------*/
@@ -114,6 +115,7 @@ void uip_log(char *msg);
 #define UIP_ND6_OPT_PREFIX_BUF ((uip_nd6_opt_prefix_info *)&uip_buf[uip_l2_l3_icmp_hdr_len + nd6_opt_offset])
 #define UIP_ND6_OPT_MTU_BUF ((uip_nd6_opt_mtu *)&uip_buf[uip_l2_l3_icmp_hdr_len + nd6_opt_offset])
 #define UIP_ND6_OPT_RDNSS_BUF ((uip_nd6_opt_dns *)&uip_buf[uip_l2_l3_icmp_hdr_len + nd6_opt_offset])
+#define UIP_ND6_OPT_6CO_BUF ((uip_nd6_opt_6co *)&uip_buf[uip_l2_l3_icmp_hdr_len + nd6_opt_offset])
 /** @} */
 
 #if UIP_ND6_SEND_NS || UIP_ND6_SEND_NA || UIP_ND6_SEND_RA || !UIP_CONF_ROUTER
@@ -760,6 +762,39 @@ uip_nd6_ra_output(uip_ipaddr_t * dest)
     }
   }
 
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+  /* 6LoWPAN contexts */
+  {
+    struct sicslowpan_addr_context *context;
+    uint8_t cid;
+
+    for(cid = 0; cid <= UIP_ND6_6CO_CID_MASK; cid++) {
+      context = sicslowpan_context_lookup(cid);
+      if(context != NULL) {
+        UIP_ND6_OPT_6CO_BUF->type = UIP_ND6_OPT_6CO;
+        UIP_ND6_OPT_6CO_BUF->len = UIP_ND6_OPT_6CO_LEN / 8;
+        UIP_ND6_OPT_6CO_BUF->context_len = context->length;
+        UIP_ND6_OPT_6CO_BUF->flags_cid =
+          (context->compress ? UIP_ND6_6CO_FLAG_C : 0) | cid;
+        UIP_ND6_OPT_6CO_BUF->reserved = 0;
+        if(context->isinfinite) {
+          /* The 6CO option has no infinite lifetime, so advertise the
+             longest one and refresh it with every RA */
+          UIP_ND6_OPT_6CO_BUF->lifetime = 0xffff;
+        } else {
+          /* In minutes, rounded up */
+          UIP_ND6_OPT_6CO_BUF->lifetime =
+            uip_htons((stimer_remaining(&context->lifetime) + 59) / 60);
+        }
+        memcpy(UIP_ND6_OPT_6CO_BUF->prefix, context->prefix,
+               sizeof(UIP_ND6_OPT_6CO_BUF->prefix));
+        nd6_opt_offset += UIP_ND6_OPT_6CO_LEN;
+        uip_len += UIP_ND6_OPT_6CO_LEN;
+      }
+    }
+  }
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
+
   /* Source link-layer option */
   create_llao((uint8_t *)UIP_ND6_OPT_HDR_BUF, UIP_ND6_OPT_SLLAO);
 
@@ -869,6 +904,9 @@ void
 ra_input(void)
 {
   uip_lladdr_t lladdr_aligned;
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+  uint8_t prefix_len;
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
 
   PRINTF("Received RA from ");
   PRINT6ADDR(&UIP_IP_BUF->srcipaddr);
@@ -1049,6 +1087,26 @@ ra_input(void)
       }
       break;
 #endif /* UIP_ND6_RA_RDNSS */
+#if SICSLOWPAN_DYNAMIC_CONTEXTS
+    case UIP_ND6_OPT_6CO:
+      PRINTF("Processing 6CO option in RA\n");
+      /* Contexts longer than 64 bits are not supported. The option,
+         which is 2 or 3 units long, must hold the whole prefix. */
+      prefix_len = (UIP_ND6_OPT_6CO_BUF->context_len + 7) >> 3;
+      if(UIP_ND6_OPT_6CO_BUF->context_len <= 64 &&
+         (UIP_ND6_OPT_6CO_BUF->len << 3) >=
+         UIP_ND6_OPT_6CO_LEN - sizeof(UIP_ND6_OPT_6CO_BUF->prefix) + prefix_len &&
+         uip_l3_icmp_hdr_len + nd6_opt_offset +
+         (UIP_ND6_OPT_6CO_BUF->len << 3) <= uip_len) {
+        memset(&ipaddr, 0, sizeof(ipaddr));
+        memcpy(&ipaddr, UIP_ND6_OPT_6CO_BUF->prefix, prefix_len);
+        sicslowpan_context_set(UIP_ND6_OPT_6CO_BUF->flags_cid & UIP_ND6_6CO_CID_MASK,
+                               &ipaddr, UIP_ND6_OPT_6CO_BUF->context_len,
+                               UIP_ND6_OPT_6CO_BUF->flags_cid & UIP_ND6_6CO_FLAG_C,
+                               uip_ntohs(UIP_ND6_OPT_6CO_BUF->lifetime));
+      }
+      break;
+#endif /* SICSLOWPAN_DYNAMIC_CONTEXTS */
     default:
       PRINTF("ND option not supported in RA");
       break;
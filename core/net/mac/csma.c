@@ -51,6 +51,14 @@
 #include "lib/list.h"
 #include "lib/memb.h"
 
+#if CSMA_QUEUE_STATS || CSMA_ADAPTIVE
+#include "net/nbr-table.h"
+#endif /* CSMA_QUEUE_STATS || CSMA_ADAPTIVE */
+
+#if CSMA_ADAPTIVE && NETSTACK_CONF_WITH_IPV6
+#include "net/link-stats.h"
+#endif /* CSMA_ADAPTIVE && NETSTACK_CONF_WITH_IPV6 */
+
 #include <string.h>
 
 #include <stdio.h>
@@ -93,16 +101,113 @@
 #define CSMA_MAX_MAX_FRAME_RETRIES 7
 #endif
 
+/* What to do with a new packet when the neighbor's queue is full */
+#ifdef CSMA_CONF_DROP_POLICY
+#define CSMA_DROP_POLICY CSMA_CONF_DROP_POLICY
+#else
+#define CSMA_DROP_POLICY CSMA_DROP_TAIL
+#endif
+
+/* Packets that waited longer than this in their queue, in clock ticks,
+   are dropped instead of being sent. 0 to disable. */
+#ifdef CSMA_CONF_MAX_QUEUE_DELAY
+#define CSMA_MAX_QUEUE_DELAY CSMA_CONF_MAX_QUEUE_DELAY
+#else
+#define CSMA_MAX_QUEUE_DELAY 0
+#endif
+
+#if CSMA_DRR
+/* The number of bytes a neighbor may send per round */
+#ifdef CSMA_CONF_DRR_QUANTUM
+#define CSMA_DRR_QUANTUM CSMA_CONF_DRR_QUANTUM
+#else
+#define CSMA_DRR_QUANTUM 127
+#endif
+
+/* Number of buckets of the neighbor queue hash table, must be a power
+   of two */
+#ifdef CSMA_CONF_NEIGHBOR_HASH_SIZE
+#define CSMA_NEIGHBOR_HASH_SIZE CSMA_CONF_NEIGHBOR_HASH_SIZE
+#else
+#define CSMA_NEIGHBOR_HASH_SIZE 8
+#endif
+#endif /* CSMA_DRR */
+
+/* After a successful transmission, send the next packet to the same
+   neighbor right away rather than after a backoff: the channel was
+   just clear. This includes a packet queued within a backoff period
+   after the queue ran empty. */
+#ifdef CSMA_CONF_BURST
+#define CSMA_BURST CSMA_CONF_BURST
+#else
+#define CSMA_BURST 0
+#endif
+
+#if CSMA_ADAPTIVE
+/* The collision rates above which the backoff exponent offset is
+   increased, and below which it is decreased */
+#ifdef CSMA_CONF_ADAPTIVE_HIGH
+#define CSMA_ADAPTIVE_HIGH CSMA_CONF_ADAPTIVE_HIGH
+#else
+#define CSMA_ADAPTIVE_HIGH (CSMA_ADAPTIVE_RATE_DIVISOR * 3 / 10)
+#endif
+#ifdef CSMA_CONF_ADAPTIVE_LOW
+#define CSMA_ADAPTIVE_LOW CSMA_CONF_ADAPTIVE_LOW
+#else
+#define CSMA_ADAPTIVE_LOW (CSMA_ADAPTIVE_RATE_DIVISOR / 10)
+#endif
+
+/* The number of transmissions between two changes of the offset */
+#ifdef CSMA_CONF_ADAPTIVE_HOLD
+#define CSMA_ADAPTIVE_HOLD CSMA_CONF_ADAPTIVE_HOLD
+#else
+#define CSMA_ADAPTIVE_HOLD 16
+#endif
+
+/* The loss rate above which the retransmission budget of a neighbor
+   shrinks, and the budget it shrinks to as the loss rate reaches 1 */
+#ifdef CSMA_CONF_ADAPTIVE_LOSS_HIGH
+#define CSMA_ADAPTIVE_LOSS_HIGH CSMA_CONF_ADAPTIVE_LOSS_HIGH
+#else
+#define CSMA_ADAPTIVE_LOSS_HIGH (CSMA_ADAPTIVE_RATE_DIVISOR / 2)
+#endif
+#ifdef CSMA_CONF_ADAPTIVE_MIN_TRANSMISSIONS
+#define CSMA_ADAPTIVE_MIN_TRANSMISSIONS CSMA_CONF_ADAPTIVE_MIN_TRANSMISSIONS
+#else
+#define CSMA_ADAPTIVE_MIN_TRANSMISSIONS 2
+#endif
+
+/* Weight of a new sample in the moving averages: 1/2^ALPHA_SHIFT */
+#define ALPHA_SHIFT 4
+#endif /* CSMA_ADAPTIVE */
+
+#define CSMA_WITH_QUEUE_TIME (CSMA_QUEUE_STATS || CSMA_MAX_QUEUE_DELAY)
+
 /* Packet metadata */
 struct qbuf_metadata {
   mac_callback_t sent;
   void *cptr;
   uint8_t max_transmissions;
+#if CSMA_WITH_QUEUE_TIME
+  clock_time_t enqueued;
+#endif /* CSMA_WITH_QUEUE_TIME */
 };
 
 /* Every neighbor has its own packet queue */
 struct neighbor_queue {
   struct neighbor_queue *next;
+#if CSMA_DRR
+  struct neighbor_queue *hash_next;
+  /* The bytes the neighbor may still send in this round, negative
+     when it sent more */
+  int32_t deficit;
+  /* Non-zero when the backoff is over and the queue waits for its turn */
+  uint8_t ready;
+#endif /* CSMA_DRR */
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+  /* Non-zero while the head of the queue is handed to the RDC layer */
+  uint8_t sending;
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
   linkaddr_t addr;
   struct ctimer transmit_timer;
   uint8_t transmissions;
@@ -130,12 +235,109 @@ MEMB(packet_memb, struct rdc_buf_list, MAX_QUEUED_PACKETS);
 MEMB(metadata_memb, struct qbuf_metadata, MAX_QUEUED_PACKETS);
 LIST(neighbor_list);
 
+#if CSMA_DRR
+/* The neighbor queues, chained per bucket through hash_next */
+static struct neighbor_queue *neighbor_hash[CSMA_NEIGHBOR_HASH_SIZE];
+/* The queue served in the current round */
+static struct neighbor_queue *drr_current;
+/* The queue whose packets are handed to the RDC layer */
+static struct neighbor_queue *drr_inflight;
+static struct ctimer drr_timer;
+#endif /* CSMA_DRR */
+
+#if CSMA_QUEUE_STATS
+NBR_TABLE(struct csma_queue_stats, csma_stats);
+#endif /* CSMA_QUEUE_STATS */
+
+#if CSMA_BURST
+/* The neighbor whose queue a burst just emptied, and when */
+static linkaddr_t burst_addr;
+static clock_time_t burst_end;
+#endif /* CSMA_BURST */
+
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+/* Non-zero while the RDC layer walks a packet list */
+static uint8_t in_send_list;
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
+
+#if CSMA_ADAPTIVE
+/* The contention controller of a neighbor */
+struct adaptive_nbr {
+  struct csma_adaptive_state state;
+  /* Transmissions since the last change of the offset */
+  uint8_t hold;
+};
+NBR_TABLE(struct adaptive_nbr, csma_adaptive);
+/* Broadcast has no entry in the neighbor table */
+static struct adaptive_nbr adaptive_broadcast;
+#endif /* CSMA_ADAPTIVE */
+
 static void packet_sent(void *ptr, int status, int num_transmissions);
 static void transmit_packet_list(void *ptr);
+static void tx_done(int status, struct rdc_buf_list *q, struct neighbor_queue *n);
+/*---------------------------------------------------------------------------*/
+#if CSMA_DRR
+static struct neighbor_queue **
+hash_bucket(const linkaddr_t *addr)
+{
+  unsigned hash = 0;
+  int i;
+
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = hash * 31 + addr->u8[i];
+  }
+  return &neighbor_hash[hash & (CSMA_NEIGHBOR_HASH_SIZE - 1)];
+}
+#endif /* CSMA_DRR */
+/*---------------------------------------------------------------------------*/
+#if CSMA_QUEUE_STATS
+static void
+update_queue_stats(const linkaddr_t *addr, struct qbuf_metadata *metadata,
+                   int dropped)
+{
+  struct csma_queue_stats *stats;
+  clock_time_t delay;
+
+  if(linkaddr_cmp(addr, &linkaddr_null)) {
+    /* No statistics for broadcast */
+    return;
+  }
+  stats = nbr_table_get_from_lladdr(csma_stats, addr);
+  if(stats == NULL) {
+    /* Only for neighbors that are in the table already, or if there
+       is room, so as not to evict the neighbors of the upper layers */
+    stats = nbr_table_add_lladdr(csma_stats, addr, NBR_TABLE_REASON_STATS, NULL);
+    if(stats == NULL) {
+      return;
+    }
+  }
+
+  if(metadata != NULL) {
+    delay = clock_time() - metadata->enqueued;
+    stats->packets++;
+    stats->delay_total += delay;
+    if(delay > stats->delay_max) {
+      stats->delay_max = delay;
+    }
+  }
+  if(dropped) {
+    stats->drops++;
+  }
+}
+#endif /* CSMA_QUEUE_STATS */
 /*---------------------------------------------------------------------------*/
 static struct neighbor_queue *
 neighbor_queue_from_addr(const linkaddr_t *addr)
 {
+#if CSMA_DRR
+  struct neighbor_queue *n = *hash_bucket(addr);
+  while(n != NULL) {
+    if(linkaddr_cmp(&n->addr, addr)) {
+      return n;
+    }
+    n = n->hash_next;
+  }
+#else /* CSMA_DRR */
   struct neighbor_queue *n = list_head(neighbor_list);
   while(n != NULL) {
     if(linkaddr_cmp(&n->addr, addr)) {
@@ -143,9 +345,149 @@ neighbor_queue_from_addr(const linkaddr_t *addr)
     }
     n = list_item_next(n);
   }
+#endif /* CSMA_DRR */
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+static void
+free_neighbor(struct neighbor_queue *n)
+{
+#if CSMA_DRR
+  struct neighbor_queue **l;
+
+  for(l = hash_bucket(&n->addr); *l != NULL; l = &(*l)->hash_next) {
+    if(*l == n) {
+      *l = n->hash_next;
+      break;
+    }
+  }
+  if(drr_current == n) {
+    /* Let the round go on with the queue after this one */
+    for(drr_current = list_head(neighbor_list);
+        drr_current != NULL && list_item_next(drr_current) != n;
+        drr_current = list_item_next(drr_current));
+  }
+  if(drr_inflight == n) {
+    drr_inflight = NULL;
+  }
+#endif /* CSMA_DRR */
+  list_remove(neighbor_list, n);
+  memb_free(&neighbor_memb, n);
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_ADAPTIVE
+static void
+ewma_update(uint16_t *rate, int sample)
+{
+  *rate = *rate - (*rate >> ALPHA_SHIFT)
+    + (sample ? CSMA_ADAPTIVE_RATE_DIVISOR >> ALPHA_SHIFT : 0);
+}
+/*---------------------------------------------------------------------------*/
+static struct adaptive_nbr *
+adaptive_lookup(const linkaddr_t *addr)
+{
+  if(linkaddr_cmp(addr, &linkaddr_null)) {
+    return &adaptive_broadcast;
+  }
+  return nbr_table_get_from_lladdr(csma_adaptive, addr);
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+adaptive_be_offset(const linkaddr_t *addr)
+{
+  struct adaptive_nbr *a = adaptive_lookup(addr);
+  return a != NULL ? a->state.be_offset : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+adaptive_update(const linkaddr_t *addr, int status, int num_transmissions)
+{
+  struct adaptive_nbr *a;
+
+  if(status != MAC_TX_OK && status != MAC_TX_NOACK &&
+     status != MAC_TX_COLLISION) {
+    return;
+  }
+
+  a = adaptive_lookup(addr);
+  if(a == NULL) {
+    /* Neighbors that do not fit in the table keep the plain backoff */
+    a = nbr_table_add_lladdr(csma_adaptive, addr, NBR_TABLE_REASON_STATS, NULL);
+    if(a == NULL) {
+      return;
+    }
+  }
+
+  a->state.transmissions += num_transmissions;
+  if(status == MAC_TX_COLLISION) {
+    a->state.collisions += num_transmissions;
+  } else if(status == MAC_TX_NOACK) {
+    a->state.noacks += num_transmissions;
+  }
+  ewma_update(&a->state.collision_rate, status == MAC_TX_COLLISION);
+  if(status != MAC_TX_COLLISION) {
+    ewma_update(&a->state.noack_rate, status == MAC_TX_NOACK);
+  }
+
+  /* Back off more when the channel around the neighbor is congested,
+     less when it is clear, with some hysteresis */
+  if(a->hold < CSMA_ADAPTIVE_HOLD) {
+    a->hold++;
+    return;
+  }
+  if(a->state.collision_rate > CSMA_ADAPTIVE_HIGH &&
+     CSMA_MIN_BE + a->state.be_offset < CSMA_MAX_BE) {
+    a->state.be_offset++;
+    a->hold = 0;
+    PRINTF("csma: congestion, backoff exponent offset %u\n", a->state.be_offset);
+  } else if(a->state.collision_rate < CSMA_ADAPTIVE_LOW &&
+            a->state.be_offset > 0) {
+    a->state.be_offset--;
+    a->hold = 0;
+    PRINTF("csma: clear channel, backoff exponent offset %u\n", a->state.be_offset);
+  }
+}
+/*---------------------------------------------------------------------------*/
+const struct csma_adaptive_state *
+csma_adaptive_state(const linkaddr_t *addr)
+{
+  struct adaptive_nbr *a = adaptive_lookup(addr);
+  return a != NULL ? &a->state : NULL;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+csma_adaptive_budget(const linkaddr_t *addr, uint8_t max_transmissions)
+{
+  struct adaptive_nbr *a;
+  uint32_t loss;
+#if NETSTACK_CONF_WITH_IPV6
+  const struct link_stats *stats;
+#endif /* NETSTACK_CONF_WITH_IPV6 */
+
+  a = adaptive_lookup(addr);
+  loss = a != NULL ? a->state.noack_rate : 0;
+#if NETSTACK_CONF_WITH_IPV6
+  stats = link_stats_from_lladdr(addr);
+  if(stats != NULL && stats->etx > LINK_STATS_ETX_DIVISOR) {
+    /* A link with an ETX of e gets about one transmission in e through */
+    loss = MAX(loss, CSMA_ADAPTIVE_RATE_DIVISOR -
+               (uint32_t)CSMA_ADAPTIVE_RATE_DIVISOR * LINK_STATS_ETX_DIVISOR / stats->etx);
+  }
+#endif /* NETSTACK_CONF_WITH_IPV6 */
+
+  if(loss <= CSMA_ADAPTIVE_LOSS_HIGH ||
+     max_transmissions <= CSMA_ADAPTIVE_MIN_TRANSMISSIONS) {
+    return max_transmissions;
+  }
+  /* Retrying on a link that loses most transmissions takes the airtime
+     of the other neighbors for few packets. Shrink the budget linearly
+     with the loss rate, down to the minimum. */
+  return max_transmissions - (uint32_t)(max_transmissions - CSMA_ADAPTIVE_MIN_TRANSMISSIONS)
+    * (loss - CSMA_ADAPTIVE_LOSS_HIGH)
+    / (CSMA_ADAPTIVE_RATE_DIVISOR - CSMA_ADAPTIVE_LOSS_HIGH);
+}
+#endif /* CSMA_ADAPTIVE */
+/*---------------------------------------------------------------------------*/
 static clock_time_t
 backoff_period(void)
 {
@@ -164,17 +506,104 @@ backoff_period(void)
 }
 /*---------------------------------------------------------------------------*/
 static void
+send_queue(struct neighbor_queue *n)
+{
+  struct rdc_buf_list *q = list_head(n->queued_packet_list);
+  if(q != NULL) {
+#if CSMA_MAX_QUEUE_DELAY
+    if(clock_time() - ((struct qbuf_metadata *)q->ptr)->enqueued >
+       CSMA_MAX_QUEUE_DELAY) {
+      PRINTF("csma: packet waited too long, dropping it\n");
+      /* This also counts the drop and schedules the next packet */
+      tx_done(MAC_TX_ERR, q, n);
+      return;
+    }
+#endif /* CSMA_MAX_QUEUE_DELAY */
+    PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
+        list_length(n->queued_packet_list));
+#if CSMA_DRR
+    drr_inflight = n;
+#endif /* CSMA_DRR */
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+    n->sending = 1;
+    in_send_list = 1;
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
+    /* Send packets in the neighbor's list */
+    NETSTACK_RDC.send_list(packet_sent, n, q);
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+    in_send_list = 0;
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if CSMA_DRR
+/* Pick the next queue to serve, or NULL if no queue is ready */
+static struct neighbor_queue *
+drr_next(void)
+{
+  struct neighbor_queue *n;
+
+  for(n = list_head(neighbor_list); n != NULL; n = list_item_next(n)) {
+    if(n->ready) {
+      break;
+    }
+  }
+  if(n == NULL) {
+    return NULL;
+  }
+
+  /* Go on with the current queue as long as it has credit */
+  n = drr_current;
+  if(n != NULL && n->ready && n->deficit > 0) {
+    return n;
+  }
+
+  /* Give a new quantum to the next ready queue. A queue that sent
+     more than its share, e.g. because of retransmissions, may need a
+     few rounds to get credit again. */
+  while(1) {
+    if(n == NULL || list_item_next(n) == NULL) {
+      n = list_head(neighbor_list);
+    } else {
+      n = list_item_next(n);
+    }
+    if(n->ready) {
+      n->deficit += CSMA_DRR_QUANTUM;
+      if(n->deficit > 0) {
+        drr_current = n;
+        return n;
+      }
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+drr_run(void *ptr)
+{
+  struct neighbor_queue *n;
+
+  /* Only one queue at a time is handed to the RDC layer. With a
+     synchronous RDC layer, the transmission is over when send_queue()
+     returns. */
+  while(drr_inflight == NULL && (n = drr_next()) != NULL) {
+    n->ready = 0;
+    send_queue(n);
+  }
+}
+#endif /* CSMA_DRR */
+/*---------------------------------------------------------------------------*/
+static void
 transmit_packet_list(void *ptr)
 {
   struct neighbor_queue *n = ptr;
   if(n) {
-    struct rdc_buf_list *q = list_head(n->queued_packet_list);
-    if(q != NULL) {
-      PRINTF("csma: preparing number %d %p, queue len %d\n", n->transmissions, q,
-          list_length(n->queued_packet_list));
-      /* Send packets in the neighbor's list */
-      NETSTACK_RDC.send_list(packet_sent, n, q);
-    }
+#if CSMA_DRR
+    /* The backoff is over, wait for our turn */
+    n->ready = 1;
+    drr_run(NULL);
+#else /* CSMA_DRR */
+    send_queue(n);
+#endif /* CSMA_DRR */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -184,7 +613,15 @@ schedule_transmission(struct neighbor_queue *n)
   clock_time_t delay;
   int backoff_exponent; /* BE in IEEE 802.15.4 */
 
+#if CSMA_DRR
+  n->ready = 0;
+#endif /* CSMA_DRR */
+
+#if CSMA_ADAPTIVE
+  backoff_exponent = MIN(n->collisions + adaptive_be_offset(&n->addr), CSMA_MAX_BE);
+#else /* CSMA_ADAPTIVE */
   backoff_exponent = MIN(n->collisions, CSMA_MAX_BE);
+#endif /* CSMA_ADAPTIVE */
 
   /* Compute max delay as per IEEE 802.15.4: 2^BE-1 backoff periods  */
   delay = ((1 << backoff_exponent) - 1) * backoff_period();
@@ -193,8 +630,31 @@ schedule_transmission(struct neighbor_queue *n)
     delay = random_rand() % delay;
   }
 
+#if CSMA_BURST
+  if(n->transmissions == 0 && linkaddr_cmp(&n->addr, &burst_addr)) {
+    if(clock_time() - burst_end <= backoff_period()) {
+      /* The sender refilled the queue as the burst ended, go on with
+         it. This is the backoff that bursting saves: within a packet
+         list, the RDC layer sends the frames back to back anyway. */
+      delay = 0;
+    }
+    linkaddr_copy(&burst_addr, &linkaddr_null);
+  }
+#endif /* CSMA_BURST */
+
   PRINTF("csma: scheduling transmission in %u ticks, NB=%u, BE=%u\n",
       (unsigned)delay, n->collisions, backoff_exponent);
+#if CSMA_DRR
+  if(delay == 0) {
+    /* Ready at once. Going through the timer would leave the queue out
+       of the current round, and it would only ever get one packet per
+       quantum. */
+    ctimer_stop(&n->transmit_timer);
+    n->ready = 1;
+    ctimer_set(&drr_timer, 0, drr_run, NULL);
+    return;
+  }
+#endif /* CSMA_DRR */
   ctimer_set(&n->transmit_timer, delay, transmit_packet_list, n);
 }
 /*---------------------------------------------------------------------------*/
@@ -214,13 +674,31 @@ free_packet(struct neighbor_queue *n, struct rdc_buf_list *p, int status)
       /* There is a next packet. We reset current tx information */
       n->transmissions = 0;
       n->collisions = CSMA_MIN_BE;
-      /* Schedule next transmissions */
-      schedule_transmission(n);
+#if CSMA_BURST
+      if(status == MAC_TX_OK) {
+        /* Go on with the burst. If the RDC layer is sending the next
+           packet already, the timer is stopped or reset before it
+           fires. */
+#if CSMA_DRR
+        n->ready = 0;
+#endif /* CSMA_DRR */
+        ctimer_set(&n->transmit_timer, 0, transmit_packet_list, n);
+      } else
+#endif /* CSMA_BURST */
+      {
+        /* Schedule next transmissions */
+        schedule_transmission(n);
+      }
     } else {
+#if CSMA_BURST
+      if(status == MAC_TX_OK) {
+        linkaddr_copy(&burst_addr, &n->addr);
+        burst_end = clock_time();
+      }
+#endif /* CSMA_BURST */
       /* This was the last packet in the queue, we free the neighbor */
       ctimer_stop(&n->transmit_timer);
-      list_remove(neighbor_list, n);
-      memb_free(&neighbor_memb, n);
+      free_neighbor(n);
     }
   }
 }
@@ -238,6 +716,10 @@ tx_done(int status, struct rdc_buf_list *q, struct neighbor_queue *n)
   cptr = metadata->cptr;
   ntx = n->transmissions;
 
+#if CSMA_QUEUE_STATS
+  update_queue_stats(&n->addr, metadata, status != MAC_TX_OK);
+#endif /* CSMA_QUEUE_STATS */
+
   switch(status) {
   case MAC_TX_OK:
     PRINTF("csma: rexmit ok %d\n", n->transmissions);
@@ -326,6 +808,22 @@ packet_sent(void *ptr, int status, int num_transmissions)
     return;
   }
 
+  if(status != MAC_TX_DEFERRED) {
+#if CSMA_ADAPTIVE
+    adaptive_update(&n->addr, status, num_transmissions);
+#endif /* CSMA_ADAPTIVE */
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+    n->sending = 0;
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
+#if CSMA_DRR
+    if(drr_inflight == n) {
+      drr_inflight = NULL;
+    }
+    /* Serve the next queue, once we are out of the RDC layer */
+    ctimer_set(&drr_timer, 0, drr_run, NULL);
+#endif /* CSMA_DRR */
+  }
+
   /* Find out what packet this callback refers to */
   for(q = list_head(n->queued_packet_list);
       q != NULL; q = list_item_next(q)) {
@@ -344,6 +842,13 @@ packet_sent(void *ptr, int status, int num_transmissions)
     return;
   }
 
+#if CSMA_DRR
+  if(status != MAC_TX_DEFERRED) {
+    /* Every transmission is charged, retransmissions included */
+    n->deficit -= (int32_t)queuebuf_datalen(q->buf) * num_transmissions;
+  }
+#endif /* CSMA_DRR */
+
   switch(status) {
   case MAC_TX_OK:
     tx_ok(q, n, num_transmissions);
@@ -362,6 +867,47 @@ packet_sent(void *ptr, int status, int num_transmissions)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+/* Remove the oldest packet of a queue that is not being sent. Its
+   callback is returned, to be called once the new packet is queued. */
+static int
+drop_oldest(struct neighbor_queue *n, mac_callback_t *sent, void **cptr)
+{
+  struct rdc_buf_list *q;
+  struct qbuf_metadata *metadata;
+
+  if(in_send_list) {
+    /* The RDC layer may be walking any packet of the list */
+    return 0;
+  }
+  q = list_head(n->queued_packet_list);
+  if(n->sending) {
+    q = list_item_next(q);
+  } else {
+    /* The next packet starts afresh */
+    n->transmissions = 0;
+    n->collisions = CSMA_MIN_BE;
+  }
+  if(q == NULL) {
+    return 0;
+  }
+
+  metadata = (struct qbuf_metadata *)q->ptr;
+  *sent = metadata->sent;
+  *cptr = metadata->cptr;
+#if CSMA_QUEUE_STATS
+  update_queue_stats(&n->addr, metadata, 1);
+#endif /* CSMA_QUEUE_STATS */
+
+  list_remove(n->queued_packet_list, q);
+  queuebuf_free(q->buf);
+  memb_free(&metadata_memb, q->ptr);
+  memb_free(&packet_memb, q);
+  PRINTF("csma: neighbor queue full, dropped oldest packet\n");
+  return 1;
+}
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
+/*---------------------------------------------------------------------------*/
 static void
 send_packet(mac_callback_t sent, void *ptr)
 {
@@ -370,6 +916,11 @@ send_packet(mac_callback_t sent, void *ptr)
   static uint8_t initialized = 0;
   static uint16_t seqno;
   const linkaddr_t *addr = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+  mac_callback_t dropped_sent;
+  void *dropped_ptr;
+  int dropped = 0;
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
 
   if(!initialized) {
     initialized = 1;
@@ -394,6 +945,15 @@ send_packet(mac_callback_t sent, void *ptr)
       linkaddr_copy(&n->addr, addr);
       n->transmissions = 0;
       n->collisions = CSMA_MIN_BE;
+#if CSMA_DRR
+      n->deficit = 0;
+      n->ready = 0;
+      n->hash_next = *hash_bucket(addr);
+      *hash_bucket(addr) = n;
+#endif /* CSMA_DRR */
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+      n->sending = 0;
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
       /* Init packet list for this neighbor */
       LIST_STRUCT_INIT(n, queued_packet_list);
       /* Add neighbor to the list */
@@ -402,6 +962,12 @@ send_packet(mac_callback_t sent, void *ptr)
   }
 
   if(n != NULL) {
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+    if(list_length(n->queued_packet_list) >= CSMA_MAX_PACKET_PER_NEIGHBOR) {
+      /* Make room for the new packet */
+      dropped = drop_oldest(n, &dropped_sent, &dropped_ptr);
+    }
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
     /* Add packet to the neighbor's queue */
     if(list_length(n->queued_packet_list) < CSMA_MAX_PACKET_PER_NEIGHBOR) {
       q = memb_alloc(&packet_memb);
@@ -419,8 +985,17 @@ send_packet(mac_callback_t sent, void *ptr)
               metadata->max_transmissions =
                 packetbuf_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS);
             }
+#if CSMA_ADAPTIVE
+            if(!linkaddr_cmp(addr, &linkaddr_null)) {
+              metadata->max_transmissions =
+                csma_adaptive_budget(addr, metadata->max_transmissions);
+            }
+#endif /* CSMA_ADAPTIVE */
             metadata->sent = sent;
             metadata->cptr = ptr;
+#if CSMA_WITH_QUEUE_TIME
+            metadata->enqueued = clock_time();
+#endif /* CSMA_WITH_QUEUE_TIME */
 #if PACKETBUF_WITH_PACKET_TYPE
             if(packetbuf_attr(PACKETBUF_ATTR_PACKET_TYPE) ==
                PACKETBUF_ATTR_PACKET_TYPE_ACK) {
@@ -437,6 +1012,11 @@ send_packet(mac_callback_t sent, void *ptr)
             if(list_head(n->queued_packet_list) == q) {
               schedule_transmission(n);
             }
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+            if(dropped) {
+              mac_call_sent_callback(dropped_sent, dropped_ptr, MAC_TX_ERR, 1);
+            }
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
             return;
           }
           memb_free(&metadata_memb, q->ptr);
@@ -447,19 +1027,34 @@ send_packet(mac_callback_t sent, void *ptr)
       }
       /* The packet allocation failed. Remove and free neighbor entry if empty. */
       if(list_length(n->queued_packet_list) == 0) {
-        list_remove(neighbor_list, n);
-        memb_free(&neighbor_memb, n);
+        free_neighbor(n);
       }
     } else {
       PRINTF("csma: Neighbor queue full\n");
     }
     PRINTF("csma: could not allocate packet, dropping packet\n");
+#if CSMA_QUEUE_STATS
+    update_queue_stats(addr, NULL, 1);
+#endif /* CSMA_QUEUE_STATS */
   } else {
     PRINTF("csma: could not allocate neighbor, dropping packet\n");
   }
+#if CSMA_DROP_POLICY == CSMA_DROP_HEAD
+  if(dropped) {
+    mac_call_sent_callback(dropped_sent, dropped_ptr, MAC_TX_ERR, 1);
+  }
+#endif /* CSMA_DROP_POLICY == CSMA_DROP_HEAD */
   mac_call_sent_callback(sent, ptr, MAC_TX_ERR, 1);
 }
 /*---------------------------------------------------------------------------*/
+#if CSMA_QUEUE_STATS
+const struct csma_queue_stats *
+csma_queue_stats(const linkaddr_t *addr)
+{
+  return nbr_table_get_from_lladdr(csma_stats, addr);
+}
+#endif /* CSMA_QUEUE_STATS */
+/*---------------------------------------------------------------------------*/
 static void
 input_packet(void)
 {
@@ -493,6 +1088,12 @@ init(void)
   memb_init(&packet_memb);
   memb_init(&metadata_memb);
   memb_init(&neighbor_memb);
+#if CSMA_QUEUE_STATS
+  nbr_table_register(csma_stats, NULL);
+#endif /* CSMA_QUEUE_STATS */
+#if CSMA_ADAPTIVE
+  nbr_table_register(csma_adaptive, NULL);
+#endif /* CSMA_ADAPTIVE */
 }
 /*---------------------------------------------------------------------------*/
 const struct mac_driver csma_driver = {
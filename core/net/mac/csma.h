@@ -43,6 +43,88 @@
 
 #include "net/mac/mac.h"
 #include "dev/radio.h"
+#include "net/linkaddr.h"
+#include "sys/clock.h"
+
+/* Queue drop policies, for CSMA_CONF_DROP_POLICY */
+/* A new packet is dropped when the neighbor's queue is full */
+#define CSMA_DROP_TAIL 0
+/* The oldest packet of a full queue is dropped to make room for a
+   new one */
+#define CSMA_DROP_HEAD 1
+
+/* Serve the neighbor queues with deficit round robin, so that every
+   neighbor gets a fair share of the channel, whatever the quality of
+   its link */
+#ifdef CSMA_CONF_DRR
+#define CSMA_DRR CSMA_CONF_DRR
+#else
+#define CSMA_DRR 0
+#endif
+
+/* Keep queue statistics per neighbor, see csma_queue_stats() */
+#ifdef CSMA_CONF_QUEUE_STATS
+#define CSMA_QUEUE_STATS CSMA_CONF_QUEUE_STATS
+#else
+#define CSMA_QUEUE_STATS 0
+#endif
+
+#if CSMA_QUEUE_STATS
+/* Queue statistics of a neighbor */
+struct csma_queue_stats {
+  /* Packets that left the queue, sent or not */
+  uint32_t packets;
+  /* Total and maximum time spent in the queue by these packets */
+  uint32_t delay_total;
+  clock_time_t delay_max;
+  /* Packets dropped because of a full queue, of a too long delay, or
+     because they were not acknowledged after all their transmissions */
+  uint16_t drops;
+};
+
+/* Returns the queue statistics of a neighbor, or NULL if none. They are
+   kept only for neighbors that get an entry in the neighbor table
+   without evicting another neighbor. */
+const struct csma_queue_stats *csma_queue_stats(const linkaddr_t *addr);
+#endif /* CSMA_QUEUE_STATS */
+
+/* Adapt the backoff exponent of each neighbor to the collision rate
+   measured when sending to it, and its retransmission budget to the
+   loss rate and ETX of its link */
+#ifdef CSMA_CONF_ADAPTIVE
+#define CSMA_ADAPTIVE CSMA_CONF_ADAPTIVE
+#else
+#define CSMA_ADAPTIVE 0
+#endif
+
+#if CSMA_ADAPTIVE
+/* Fixed point divisor of the rates below */
+#define CSMA_ADAPTIVE_RATE_DIVISOR 1024
+
+/* State of the contention controller of a neighbor */
+struct csma_adaptive_state {
+  /* Moving averages of the ratio of transmissions that found the
+     channel busy, and of those that got no ACK */
+  uint16_t collision_rate;
+  uint16_t noack_rate;
+  /* Added to the backoff exponent of the neighbor */
+  uint8_t be_offset;
+  uint32_t transmissions;
+  uint32_t collisions;
+  uint32_t noacks;
+};
+
+/* Returns the state of the contention controller of a neighbor, or of
+   broadcast for linkaddr_null, or NULL if the neighbor has none. The
+   state is kept only for neighbors that get an entry in the neighbor
+   table without evicting another neighbor. */
+const struct csma_adaptive_state *csma_adaptive_state(const linkaddr_t *addr);
+/* Returns the number of transmissions a packet to a neighbor gets,
+   given the number requested for it. It is less than requested when
+   the link loses more than CSMA_CONF_ADAPTIVE_LOSS_HIGH of the
+   transmissions, but not less than CSMA_CONF_ADAPTIVE_MIN_TRANSMISSIONS. */
+uint8_t csma_adaptive_budget(const linkaddr_t *addr, uint8_t max_transmissions);
+#endif /* CSMA_ADAPTIVE */
 
 extern const struct mac_driver csma_driver;
 
@@ -60,6 +60,7 @@ enum ieee802154e_header_ie_id {
 enum ieee802154e_payload_ie_id {
   PAYLOAD_IE_ESDU = 0,
   PAYLOAD_IE_MLME,
+  PAYLOAD_IE_IETF = 0x5, /* c.f. RFC 8137 */
   PAYLOAD_IE_LIST_TERMINATION = 0xf,
 };
 
@@ -207,6 +208,27 @@ frame80215e_create_ie_mlme(uint8_t *buf, int len,
   }
 }
 
+/* Payload IE. IETF, with a 6top sub-IE. Used in 6P messages */
+int
+frame80215e_create_ie_ietf_sixtop(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int ie_len;
+  if(ies == NULL || (ies->ie_sixtop == NULL && ies->ie_sixtop_len > 0)) {
+    return -1;
+  }
+  /* Sub-ID, then the 6P message */
+  ie_len = 1 + ies->ie_sixtop_len;
+  if(len >= 2 + ie_len) {
+    buf[2] = FRAME802154E_IETF_IE_SIXTOP;
+    memcpy(buf + 3, ies->ie_sixtop, ies->ie_sixtop_len);
+    create_payload_ie_descriptor(buf, PAYLOAD_IE_IETF, ie_len);
+    return 2 + ie_len;
+  } else {
+    return -1;
+  }
+}
+
 /* MLME sub-IE. TSCH synchronization. Used in EBs: ASN and join priority */
 int
 frame80215e_create_ie_tsch_synchronization(uint8_t *buf, int len,
@@ -529,6 +551,17 @@ frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
             len = 0; /* Reset len as we want to read subIEs and not jump over them */
             PRINTF("frame802154e: entering MLME ie with len %u\n", nested_mlme_len);
             break;
+          case PAYLOAD_IE_IETF:
+            if(len > buf_size) {
+              PRINTF("frame802154e: failed to parse ietf ie\n");
+              return -1;
+            }
+            /* Keep the 6top sub-IE, skip others */
+            if(len >= 1 && buf[0] == FRAME802154E_IETF_IE_SIXTOP) {
+              ies->ie_sixtop = buf + 1;
+              ies->ie_sixtop_len = len - 1;
+            }
+            break;
           case PAYLOAD_IE_LIST_TERMINATION:
             PRINTF("frame802154e: payload ie list termination %u\n", len);
             return (len == 0) ? buf + len - start : -1;
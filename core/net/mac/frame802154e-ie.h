@@ -60,6 +60,9 @@ struct tsch_slotframe_and_links {
   struct tsch_slotframe_and_links_link links[FRAME802154E_IE_MAX_LINKS];
 };
 
+/* Sub-ID of the 6top IE within IETF IEs, c.f. RFC 8480 */
+#define FRAME802154E_IETF_IE_SIXTOP     0xc9
+
 /* The information elements that we currently support */
 struct ieee802154_ies {
   /* Header IEs */
@@ -80,6 +83,9 @@ struct ieee802154_ies {
   /* We include and parse only the sequence len and list and omit unused fields */
   uint16_t ie_hopping_sequence_len;
   uint8_t ie_hopping_sequence_list[TSCH_HOPPING_SEQUENCE_MAX_LEN];
+  /* Payload IETF IE, 6top sub-IE. We point at the 6P message in the frame */
+  const uint8_t *ie_sixtop;
+  uint8_t ie_sixtop_len;
 };
 
 /** Insert various Information Elements **/
@@ -100,6 +106,9 @@ int frame80215e_create_ie_payload_list_termination(uint8_t *buf, int len,
 /* Payload IE. MLME. Used to nest sub-IEs */
 int frame80215e_create_ie_mlme(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
+/* Payload IE. IETF, with a 6top sub-IE. Used in 6P messages */
+int frame80215e_create_ie_ietf_sixtop(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
 /* MLME sub-IE. TSCH synchronization. Used in EBs: ASN and join priority */
 int frame80215e_create_ie_tsch_synchronization(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
@@ -99,6 +99,11 @@ create_frame(int type, int do_create)
 
   /* Insert IEEE 802.15.4 version bits. */
   params.fcf.frame_version = FRAME802154_VERSION;
+
+#if TSCH_WITH_SIXTOP
+  /* The payload is a list of Information Elements */
+  params.fcf.ie_list_present = packetbuf_attr(PACKETBUF_ATTR_MAC_IE_LIST_PRESENT);
+#endif /* TSCH_WITH_SIXTOP */
   
 #if LLSEC802154_USES_AUX_HEADER
   if(packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL)) {
@@ -232,6 +237,9 @@ parse(void)
     }
     packetbuf_set_addr(PACKETBUF_ADDR_SENDER, (linkaddr_t *)&frame.src_addr);
     packetbuf_set_attr(PACKETBUF_ATTR_PENDING, frame.fcf.frame_pending);
+#if TSCH_WITH_SIXTOP
+    packetbuf_set_attr(PACKETBUF_ATTR_MAC_IE_LIST_PRESENT, frame.fcf.ie_list_present);
+#endif /* TSCH_WITH_SIXTOP */
     if(frame.fcf.sequence_number_suppression == 0) {
       packetbuf_set_attr(PACKETBUF_ATTR_MAC_SEQNO, frame.seq);
     } else {
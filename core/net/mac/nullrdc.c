@@ -97,6 +97,23 @@
 #endif /* NULLRDC_CONF_AFTER_ACK_DETECTED_WAIT_TIME */
 #endif /* NULLRDC_802154_AUTOACK */
 
+/* Mark the frames of a packet list that are followed by another one
+   with the frame pending bit, so that the receiver knows that more
+   frames follow in the burst */
+#ifdef NULLRDC_CONF_BURST
+#define NULLRDC_BURST NULLRDC_CONF_BURST
+#else /* NULLRDC_CONF_BURST */
+#define NULLRDC_BURST 0
+#endif /* NULLRDC_CONF_BURST */
+
+/* The maximum number of frames sent back to back from a packet list,
+   0 for no limit. The MAC layer sends the rest later. */
+#ifdef NULLRDC_CONF_BURST_MAX
+#define NULLRDC_BURST_MAX NULLRDC_CONF_BURST_MAX
+#else /* NULLRDC_CONF_BURST_MAX */
+#define NULLRDC_BURST_MAX 0
+#endif /* NULLRDC_CONF_BURST_MAX */
+
 #ifdef NULLRDC_CONF_SEND_802154_ACK
 #define NULLRDC_SEND_802154_ACK NULLRDC_CONF_SEND_802154_ACK
 #else /* NULLRDC_CONF_SEND_802154_ACK */
@@ -243,13 +260,27 @@ send_packet(mac_callback_t sent, void *ptr)
 static void
 send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *buf_list)
 {
+#if NULLRDC_BURST_MAX
+  int count = 0;
+#endif /* NULLRDC_BURST_MAX */
+
   while(buf_list != NULL) {
     /* We backup the next pointer, as it may be nullified by
      * mac_call_sent_callback() */
     struct rdc_buf_list *next = buf_list->next;
     int last_sent_ok;
 
+#if NULLRDC_BURST_MAX
+    if(++count == NULLRDC_BURST_MAX) {
+      /* Last frame of this burst */
+      next = NULL;
+    }
+#endif /* NULLRDC_BURST_MAX */
+
     queuebuf_to_packetbuf(buf_list->buf);
+#if NULLRDC_BURST
+    packetbuf_set_attr(PACKETBUF_ATTR_PENDING, next != NULL);
+#endif /* NULLRDC_BURST */
     last_sent_ok = send_one_packet(sent, ptr);
 
     /* If packet transmission was not successful, we should back off and let
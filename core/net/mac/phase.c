@@ -50,15 +50,134 @@
 #define PHASE_DRIFT_CORRECT 0
 #endif
 
+/* Save the drift estimates of the neighbors to CFS, and restore them
+   at boot. The phases are saved too when there is a clock that keeps
+   counting across reboots, see PHASE_CONF_PERSIST_CLOCK. */
+#if PHASE_CONF_PERSIST
+#define PHASE_PERSIST PHASE_CONF_PERSIST
+#else
+#define PHASE_PERSIST 0
+#endif
+
+#if PHASE_PERSIST && !PHASE_DRIFT_CORRECT
+#error PHASE_CONF_PERSIST requires PHASE_CONF_DRIFT_CORRECT
+#endif
+
+#if PHASE_DRIFT_CORRECT
+/* Drift is kept in 1/DRIFT_SCALE rtimer ticks per cycle */
+#define DRIFT_SCALE           256
+
+/* The minimum number of cycles between two samples used to estimate
+   the drift, so that the jitter of the samples does not dominate */
+#ifdef PHASE_CONF_DRIFT_MIN_CYCLES
+#define DRIFT_MIN_CYCLES      PHASE_CONF_DRIFT_MIN_CYCLES
+#else
+#define DRIFT_MIN_CYCLES      32
+#endif
+
+/* Samples further apart than this, in clock ticks, are not used to
+   estimate the drift, and a phase that old is not predicted */
+#ifdef PHASE_CONF_DRIFT_MAX_AGE
+#define DRIFT_MAX_AGE         PHASE_CONF_DRIFT_MAX_AGE
+#else
+#define DRIFT_MAX_AGE         (CLOCK_SECOND * 60 * 30)
+#endif
+
+/* Number of rtimer ticks per clock tick, used to count cycles */
+#if RTIMER_ARCH_SECOND >= CLOCK_SECOND
+#define RTIMER_PER_CLOCK      (RTIMER_ARCH_SECOND / CLOCK_SECOND)
+#else
+#define RTIMER_PER_CLOCK      1
+#endif
+#endif /* PHASE_DRIFT_CORRECT */
+
+#if PHASE_PERSIST
+#include "cfs/cfs.h"
+#include <string.h>
+
+#ifdef PHASE_CONF_PERSIST_FILE
+#define PERSIST_FILE          PHASE_CONF_PERSIST_FILE
+#else
+#define PERSIST_FILE          "phase"
+#endif
+
+/* How often the drift estimates are saved */
+#ifdef PHASE_CONF_PERSIST_INTERVAL
+#define PERSIST_INTERVAL      PHASE_CONF_PERSIST_INTERVAL
+#else
+#define PERSIST_INTERVAL      (CLOCK_SECOND * 60 * 10)
+#endif
+
+/* Estimates not refreshed for this many saves are forgotten */
+#ifdef PHASE_CONF_PERSIST_MAX_AGE
+#define PERSIST_MAX_AGE       PHASE_CONF_PERSIST_MAX_AGE
+#else
+#define PERSIST_MAX_AGE       6
+#endif
+
+/* A clock that keeps counting while the node is down, in clock ticks,
+   e.g. read from an RTC. The rtimer starts over at boot, so a phase
+   can only be restored by aging it against this clock. Without it,
+   only the drift is restored and the phase is learned again. */
+#ifdef PHASE_CONF_PERSIST_CLOCK
+#define PERSIST_CLOCK()       PHASE_CONF_PERSIST_CLOCK()
+#endif
+
+/* What is saved before the neighbors */
+struct phase_header {
+  /* PERSIST_CLOCK() at the save */
+  clock_time_t time;
+  rtimer_clock_t cycle;
+};
+
+/* What is saved for a neighbor */
+struct phase_record {
+  linkaddr_t addr;
+  /* Rtimer ticks from the save to the next wake-up of the neighbor */
+  rtimer_clock_t wait;
+  /* Clock ticks from the phase measurement to the save */
+  clock_time_t phase_age;
+  int16_t drift;
+  uint8_t flags;
+  uint8_t age;
+};
+
+static struct ctimer persist_timer;
+#endif /* PHASE_PERSIST */
+
 struct phase {
   rtimer_clock_t time;
 #if PHASE_DRIFT_CORRECT
-  rtimer_clock_t drift;
-#endif
+  /* When the phase was last measured */
+  clock_time_t time_clock;
+  /* The sample the drift is measured from */
+  rtimer_clock_t anchor;
+  clock_time_t anchor_clock;
+  /* Phase drift per cycle, in 1/DRIFT_SCALE rtimer ticks */
+  int16_t drift;
+  uint8_t flags;
+#if PHASE_PERSIST
+  /* Saves since the phase was last measured */
+  uint8_t age;
+#endif /* PHASE_PERSIST */
+#endif /* PHASE_DRIFT_CORRECT */
   uint8_t noacks;
   struct timer noacks_timer;
 };
 
+#if PHASE_DRIFT_CORRECT
+/* The phase is known, not only the drift */
+#define PHASE_FLAG_TIME  0x01
+/* The drift has been estimated */
+#define PHASE_FLAG_DRIFT 0x02
+/* The phase was restored from a saved one. It was predicted, not
+   measured, so the drift is not estimated from it. */
+#define PHASE_FLAG_RESTORED 0x04
+
+/* The cycle time, as given to phase_wait() */
+static rtimer_clock_t cycle;
+#endif /* PHASE_DRIFT_CORRECT */
+
 struct phase_queueitem {
   struct ctimer timer;
   mac_callback_t mac_callback;
@@ -87,6 +206,90 @@ NBR_TABLE(struct phase, nbr_phase);
 #define PRINTDEBUG(...)
 #endif
 /*---------------------------------------------------------------------------*/
+#if PHASE_DRIFT_CORRECT
+/* The number of cycles in a number of clock ticks */
+static uint32_t
+cycles(clock_time_t elapsed)
+{
+  return ((uint32_t)elapsed * RTIMER_PER_CLOCK + cycle / 2) / cycle;
+}
+/*---------------------------------------------------------------------------*/
+/* Update the drift estimate with a new phase sample */
+static void
+drift_update(struct phase *e, rtimer_clock_t time)
+{
+  clock_time_t now = clock_time();
+  clock_time_t elapsed = now - e->anchor_clock;
+  uint32_t n;
+  int32_t shift, drift;
+
+  e->time = time;
+  e->time_clock = now;
+#if PHASE_PERSIST
+  e->age = 0;
+#endif /* PHASE_PERSIST */
+
+  if(!(e->flags & PHASE_FLAG_TIME) || (e->flags & PHASE_FLAG_RESTORED) ||
+     elapsed > DRIFT_MAX_AGE) {
+    /* Start over from this sample */
+    e->flags |= PHASE_FLAG_TIME;
+    e->flags &= ~PHASE_FLAG_RESTORED;
+    e->anchor = time;
+    e->anchor_clock = now;
+    return;
+  }
+
+  if(cycle == 0) {
+    /* No cycle time to count the cycles with yet */
+    return;
+  }
+  n = cycles(elapsed);
+  if(n < DRIFT_MIN_CYCLES) {
+    /* Too close to the anchor to tell drift from jitter */
+    return;
+  }
+  if((cycle & (cycle - 1)) != 0 && sizeof(rtimer_clock_t) < 4) {
+    /* The rtimer wraps around at a point that is not a multiple of the
+       cycle, so the phase shift is unknown */
+    return;
+  }
+
+  /* The phase shift since the anchor, between -cycle/2 and cycle/2 */
+  shift = (rtimer_clock_t)(time - e->anchor) % cycle;
+  if(shift > cycle / 2) {
+    shift -= cycle;
+  }
+  drift = shift * DRIFT_SCALE / (int32_t)n;
+  if(drift > INT16_MAX || drift < INT16_MIN) {
+    /* Not drift: the neighbor changed its phase */
+    e->flags &= ~PHASE_FLAG_DRIFT;
+  } else if(e->flags & PHASE_FLAG_DRIFT) {
+    e->drift = (3 * (int32_t)e->drift + drift) / 4;
+  } else {
+    e->drift = drift;
+    e->flags |= PHASE_FLAG_DRIFT;
+  }
+  e->anchor = time;
+  e->anchor_clock = now;
+}
+/*---------------------------------------------------------------------------*/
+/* A wake-up time of the neighbor, with the drift since it was measured */
+static rtimer_clock_t
+drift_sync(struct phase *e)
+{
+  rtimer_clock_t sync = e->time;
+
+  if(e->flags & PHASE_FLAG_DRIFT) {
+    clock_time_t elapsed = clock_time() - e->time_clock;
+    if(elapsed <= DRIFT_MAX_AGE) {
+      /* Add the drift since the phase was measured */
+      sync += (int32_t)e->drift * (int32_t)cycles(elapsed) / DRIFT_SCALE;
+    }
+  }
+  return sync;
+}
+#endif /* PHASE_DRIFT_CORRECT */
+/*---------------------------------------------------------------------------*/
 void
 phase_update(const linkaddr_t *neighbor, rtimer_clock_t time,
              int mac_status)
@@ -98,9 +301,10 @@ phase_update(const linkaddr_t *neighbor, rtimer_clock_t time,
   if(e != NULL) {
     if(mac_status == MAC_TX_OK) {
 #if PHASE_DRIFT_CORRECT
-      e->drift = time-e->time;
-#endif
+      drift_update(e, time);
+#else /* PHASE_DRIFT_CORRECT */
       e->time = time;
+#endif /* PHASE_DRIFT_CORRECT */
     }
     /* If the neighbor didn't reply to us, it may have switched
        phase (rebooted). We try a number of transmissions to it
@@ -124,10 +328,12 @@ phase_update(const linkaddr_t *neighbor, rtimer_clock_t time,
     if(mac_status == MAC_TX_OK && e == NULL) {
       e = nbr_table_add_lladdr(nbr_phase, neighbor, NBR_TABLE_REASON_MAC, NULL);
       if(e) {
-        e->time = time;
 #if PHASE_DRIFT_CORRECT
-      e->drift = 0;
-#endif
+        /* The entry is zeroed, so this sets the first anchor */
+        drift_update(e, time);
+#else /* PHASE_DRIFT_CORRECT */
+        e->time = time;
+#endif /* PHASE_DRIFT_CORRECT */
       e->noacks = 0;
       }
     }
@@ -162,7 +368,16 @@ phase_wait(const linkaddr_t *neighbor, rtimer_clock_t cycle_time,
      phase for this particular neighbor. If so, we can compute the
      time for the next expected phase and setup a ctimer to switch on
      the radio just before the phase. */
+#if PHASE_DRIFT_CORRECT
+  cycle = cycle_time;
+#endif /* PHASE_DRIFT_CORRECT */
   e = nbr_table_get_from_lladdr(nbr_phase, neighbor);
+#if PHASE_DRIFT_CORRECT
+  if(e != NULL && !(e->flags & PHASE_FLAG_TIME)) {
+    /* Only the drift is known, restored from a previous run */
+    return PHASE_UNKNOWN;
+  }
+#endif /* PHASE_DRIFT_CORRECT */
   if(e != NULL) {
     rtimer_clock_t wait, now, expected, sync;
     clock_time_t ctimewait;
@@ -183,18 +398,11 @@ phase_wait(const linkaddr_t *neighbor, rtimer_clock_t cycle_time,
     
     now = RTIMER_NOW();
 
-    sync = (e == NULL) ? now : e->time;
-
 #if PHASE_DRIFT_CORRECT
-    {
-      int32_t s;
-      if(e->drift > cycle_time) {
-        s = e->drift % cycle_time / (e->drift / cycle_time);  /* drift per cycle */
-        s = s * (now - sync) / cycle_time;                    /* estimated drift to now */
-        sync += s;                                            /* add it in */
-      }
-    }
-#endif
+    sync = drift_sync(e);
+#else /* PHASE_DRIFT_CORRECT */
+    sync = (e == NULL) ? now : e->time;
+#endif /* PHASE_DRIFT_CORRECT */
 
     /* Check if cycle_time is a power of two */
     if(!(cycle_time & (cycle_time - 1))) {
@@ -243,10 +451,133 @@ phase_wait(const linkaddr_t *neighbor, rtimer_clock_t cycle_time,
   return PHASE_UNKNOWN;
 }
 /*---------------------------------------------------------------------------*/
+#if PHASE_PERSIST
+static void
+persist_save(void *ptr)
+{
+  struct phase *e;
+  struct phase_header h;
+  struct phase_record r;
+  rtimer_clock_t now;
+  int fd;
+
+  cfs_remove(PERSIST_FILE);
+  fd = cfs_open(PERSIST_FILE, CFS_WRITE);
+  if(fd >= 0) {
+    memset(&h, 0, sizeof(h));
+#ifdef PERSIST_CLOCK
+    h.time = PERSIST_CLOCK();
+    h.cycle = cycle;
+#endif /* PERSIST_CLOCK */
+    now = RTIMER_NOW();
+    if(cfs_write(fd, &h, sizeof(h)) != sizeof(h)) {
+      PRINTF("phase: could not save\n");
+    } else {
+      for(e = nbr_table_head(nbr_phase); e != NULL;
+          e = nbr_table_next(nbr_phase, e)) {
+        memset(&r, 0, sizeof(r));
+        if(h.cycle != 0 && (e->flags & PHASE_FLAG_TIME) &&
+           clock_time() - e->time_clock <= DRIFT_MAX_AGE) {
+          r.flags |= PHASE_FLAG_TIME;
+          r.wait = h.cycle - (rtimer_clock_t)((now - drift_sync(e)) % h.cycle);
+          r.phase_age = clock_time() - e->time_clock;
+        }
+        if(e->flags & PHASE_FLAG_DRIFT) {
+          r.flags |= PHASE_FLAG_DRIFT;
+          r.drift = e->drift;
+        }
+        if(r.flags == 0) {
+          continue;
+        }
+        if(e->age < PERSIST_MAX_AGE) {
+          e->age++;
+        }
+        r.age = e->age;
+        if(r.age >= PERSIST_MAX_AGE) {
+          /* Too old to be restored */
+          continue;
+        }
+        linkaddr_copy(&r.addr, nbr_table_get_lladdr(nbr_phase, e));
+        if(cfs_write(fd, &r, sizeof(r)) != sizeof(r)) {
+          PRINTF("phase: could not save\n");
+          break;
+        }
+      }
+    }
+    cfs_close(fd);
+  }
+  ctimer_reset(&persist_timer);
+}
+/*---------------------------------------------------------------------------*/
+static void
+persist_restore(void)
+{
+  struct phase *e;
+  struct phase_header h;
+  struct phase_record r;
+  clock_time_t down;
+  int32_t shift;
+  int fd;
+
+  fd = cfs_open(PERSIST_FILE, CFS_READ);
+  if(fd < 0) {
+    return;
+  }
+  if(cfs_read(fd, &h, sizeof(h)) != sizeof(h)) {
+    cfs_close(fd);
+    return;
+  }
+#ifdef PERSIST_CLOCK
+  /* The time since the save, down time included */
+  down = PERSIST_CLOCK() - h.time;
+#else /* PERSIST_CLOCK */
+  down = 0;
+  h.cycle = 0;
+#endif /* PERSIST_CLOCK */
+  cycle = h.cycle;
+
+  while(cfs_read(fd, &r, sizeof(r)) == sizeof(r)) {
+    if(h.cycle != 0 && (r.flags & PHASE_FLAG_TIME) &&
+       r.phase_age + down <= DRIFT_MAX_AGE) {
+      /* Age the phase: the neighbor went on waking up every cycle,
+         and drifted, while we were down */
+      shift = (uint32_t)down * RTIMER_PER_CLOCK % h.cycle;
+      if(r.flags & PHASE_FLAG_DRIFT) {
+        shift -= (int32_t)r.drift * (int32_t)cycles(down) / DRIFT_SCALE;
+      }
+      r.wait -= shift;
+    } else {
+      r.flags &= ~PHASE_FLAG_TIME;
+    }
+    if(r.flags == 0) {
+      continue;
+    }
+    e = nbr_table_add_lladdr(nbr_phase, &r.addr, NBR_TABLE_REASON_MAC, NULL);
+    if(e == NULL) {
+      break;
+    }
+    e->drift = r.drift;
+    e->age = r.age;
+    e->flags = r.flags;
+    if(r.flags & PHASE_FLAG_TIME) {
+      e->time = RTIMER_NOW() + r.wait;
+      e->time_clock = clock_time();
+      e->flags |= PHASE_FLAG_RESTORED;
+    }
+    /* Otherwise the phase is learned again at the first transmission */
+  }
+  cfs_close(fd);
+}
+#endif /* PHASE_PERSIST */
+/*---------------------------------------------------------------------------*/
 void
 phase_init(void)
 {
   memb_init(&queued_packets_memb);
   nbr_table_register(nbr_phase, NULL);
+#if PHASE_PERSIST
+  persist_restore();
+  ctimer_set(&persist_timer, PERSIST_INTERVAL, persist_save, NULL);
+#endif /* PHASE_PERSIST */
 }
 /*---------------------------------------------------------------------------*/
@@ -0,0 +1,551 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         6top (6P) cell negotiation and a traffic-adaptive scheduling
+ *         function. Cells are negotiated with the time source only, see
+ *         sixtop.h.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "net/packetbuf.h"
+#include "net/netstack.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-packet.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "net/mac/tsch/tsch-slot-operation.h"
+#include "net/mac/tsch/tsch-log.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include <string.h>
+
+#if TSCH_LOG_LEVEL >= 1
+#define DEBUG DEBUG_PRINT
+#else /* TSCH_LOG_LEVEL */
+#define DEBUG DEBUG_NONE
+#endif /* TSCH_LOG_LEVEL */
+#include "net/net-debug.h"
+
+#if TSCH_WITH_SIXTOP
+
+/* 6P header: version and type, code, SFID, sequence number */
+#define SIXP_HDR_LEN 4
+/* After the header of ADD and DELETE requests: metadata, cell options, number of cells */
+#define SIXP_REQ_LEN 4
+/* A cell: timeslot and channel offset */
+#define SIXP_CELL_LEN 4
+#define SIXP_MAX_LEN (SIXP_HDR_LEN + SIXP_REQ_LEN + SIXTOP_NUM_CANDIDATES * SIXP_CELL_LEN)
+
+/* Number of queue samples before deciding on the first cell */
+#define SIXTOP_MIN_SAMPLES 4
+
+PROCESS(sixtop_process, "6top");
+
+/* The slotframe holding the negotiated cells */
+static struct tsch_slotframe *sf;
+/* The neighbor we negotiate Tx cells with: our time source */
+static linkaddr_t peer;
+static int num_cells;
+/* The ongoing transaction with peer, if trans_command is not 0 */
+static uint8_t trans_command;
+static uint8_t trans_seqnum;
+static clock_time_t trans_start;
+static struct sixtop_cell trans_cells[SIXTOP_NUM_CANDIDATES];
+static uint8_t trans_num_cells;
+static uint8_t seqnum;
+/* Measurements since the number of cells last changed. cells_used is
+ * incremented from interrupt */
+static volatile uint16_t cells_used;
+static struct tsch_asn_t window_start;
+static uint16_t queue_sum;
+static uint16_t queue_samples;
+
+/*---------------------------------------------------------------------------*/
+static int
+write_header(uint8_t *buf, uint8_t type, uint8_t code, uint8_t seq)
+{
+  buf[0] = SIXP_VERSION | (type << 4);
+  buf[1] = code;
+  buf[2] = SIXTOP_SFID;
+  buf[3] = seq;
+  return SIXP_HDR_LEN;
+}
+/*---------------------------------------------------------------------------*/
+static int
+write_cell(uint8_t *buf, const struct sixtop_cell *cell)
+{
+  buf[0] = cell->timeslot & 0xff;
+  buf[1] = cell->timeslot >> 8;
+  buf[2] = cell->channel_offset & 0xff;
+  buf[3] = cell->channel_offset >> 8;
+  return SIXP_CELL_LEN;
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_cell(const uint8_t *buf, struct sixtop_cell *cell)
+{
+  cell->timeslot = buf[0] | (buf[1] << 8);
+  cell->channel_offset = buf[2] | (buf[3] << 8);
+}
+/*---------------------------------------------------------------------------*/
+/* Send a 6P message as the payload IE of a frame to dest */
+static int
+send_message(const linkaddr_t *dest, const uint8_t *msg, int len, mac_callback_t sent, void *ptr)
+{
+  int ies_len;
+
+  packetbuf_clear();
+  ies_len = tsch_packet_create_sixtop_ies(packetbuf_dataptr(), PACKETBUF_SIZE, msg, len);
+  if(ies_len <= 0) {
+    return 0;
+  }
+  packetbuf_set_datalen(ies_len);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, dest);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_IE_LIST_PRESENT, 1);
+  NETSTACK_LLSEC.send(sent, ptr);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Is a timeslot free in our slotframe? The candidates of an ongoing ADD
+ * request are reserved as well */
+static int
+timeslot_is_free(uint16_t timeslot)
+{
+  struct tsch_link *l;
+  int i;
+
+  if(timeslot >= SIXTOP_SLOTFRAME_LENGTH) {
+    return 0;
+  }
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->timeslot == timeslot) {
+      return 0;
+    }
+  }
+  if(trans_command == SIXP_CMD_ADD) {
+    for(i = 0; i < trans_num_cells; i++) {
+      if(trans_cells[i].timeslot == timeslot) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove the links with a neighbor, matching a cell or all of them if
+ * cell is NULL. Returns the number of links removed */
+static int
+remove_links(const linkaddr_t *addr, uint8_t link_options, const struct sixtop_cell *cell)
+{
+  struct tsch_link *l = list_head(sf->links_list);
+  int removed = 0;
+
+  while(l != NULL) {
+    struct tsch_link *next = list_item_next(l);
+    if(linkaddr_cmp(&l->addr, addr) && (l->link_options & link_options)
+       && (cell == NULL || (l->timeslot == cell->timeslot
+                            && l->channel_offset == cell->channel_offset))) {
+      if(tsch_schedule_remove_link(sf, l)) {
+        removed++;
+      }
+    }
+    l = next;
+  }
+  return removed;
+}
+/*---------------------------------------------------------------------------*/
+static void
+reset_window(void)
+{
+  cells_used = 0;
+  window_start = tsch_current_asn;
+  queue_sum = 0;
+  queue_samples = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+request_sent(void *ptr, int status, int transmissions)
+{
+  /* The request was not sent at all: end the transaction. Otherwise,
+   * we wait for the response or for the timeout */
+  if((uint8_t)(uintptr_t)ptr == trans_seqnum && trans_command != 0
+     && (status == MAC_TX_ERR || status == MAC_TX_ERR_FATAL)) {
+    PRINTF("6top:! request %u not sent\n", trans_seqnum);
+    trans_command = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Start a transaction with peer */
+static void
+send_request(uint8_t command, const struct sixtop_cell *cells, uint8_t n)
+{
+  const linkaddr_t *dest = &peer;
+  uint8_t msg[SIXP_MAX_LEN];
+  int len;
+  int i;
+
+  trans_seqnum = seqnum++;
+  len = write_header(msg, SIXP_TYPE_REQUEST, command, trans_seqnum);
+  /* Metadata, unused */
+  msg[len++] = 0;
+  msg[len++] = 0;
+  if(command != SIXP_CMD_CLEAR) {
+    msg[len++] = SIXP_CELL_OPTION_TX;
+    msg[len++] = 1; /* Number of cells */
+    for(i = 0; i < n; i++) {
+      len += write_cell(msg + len, &cells[i]);
+    }
+  }
+  memcpy(trans_cells, cells, n * sizeof(struct sixtop_cell));
+  trans_num_cells = n;
+  trans_command = command;
+  trans_start = clock_time();
+  PRINTF("6top: request %u cmd %u to %u, %u cells\n",
+         trans_seqnum, command, TSCH_LOG_ID_FROM_LINKADDR(dest), n);
+  if(!send_message(dest, msg, len, request_sent, (void *)(uintptr_t)trans_seqnum)) {
+    trans_command = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Propose random free cells to peer */
+static void
+request_add(void)
+{
+  struct sixtop_cell cells[SIXTOP_NUM_CANDIDATES];
+  int n = 0;
+  int tries;
+  int i;
+
+  for(tries = 0; n < SIXTOP_NUM_CANDIDATES && tries < 2 * SIXTOP_SLOTFRAME_LENGTH; tries++) {
+    uint16_t timeslot = random_rand() % SIXTOP_SLOTFRAME_LENGTH;
+    if(!timeslot_is_free(timeslot)) {
+      continue;
+    }
+    for(i = 0; i < n && cells[i].timeslot != timeslot; i++);
+    if(i == n) {
+      cells[n].timeslot = timeslot;
+      cells[n].channel_offset = 1 + random_rand() % SIXTOP_NUM_CHANNEL_OFFSETS;
+      n++;
+    }
+  }
+  if(n > 0) {
+    send_request(SIXP_CMD_ADD, cells, n);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Give one of our cells back to peer */
+static void
+request_delete(void)
+{
+  struct tsch_link *l;
+  struct sixtop_cell cell;
+
+  for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+    if((l->link_options & LINK_OPTION_TX) && linkaddr_cmp(&l->addr, &peer)) {
+      cell.timeslot = l->timeslot;
+      cell.channel_offset = l->channel_offset;
+      send_request(SIXP_CMD_DELETE, &cell, 1);
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Drop our cells to peer and ask it to do the same. The CLEAR request is
+ * a transaction: no cell is added before it is answered */
+static void
+clear_peer(void)
+{
+  num_cells -= remove_links(&peer, LINK_OPTION_TX, NULL);
+  send_request(SIXP_CMD_CLEAR, NULL, 0);
+  reset_window();
+}
+/*---------------------------------------------------------------------------*/
+static void
+request_input(const linkaddr_t *src, uint8_t command, uint8_t seq,
+              const uint8_t *body, int len)
+{
+  uint8_t msg[SIXP_MAX_LEN];
+  int msg_len = SIXP_HDR_LEN;
+  uint8_t rc = SIXP_RC_SUCCESS;
+  struct sixtop_cell cell;
+  int num_requested;
+  int n = 0;
+  int i;
+
+  switch(command) {
+    case SIXP_CMD_ADD:
+    case SIXP_CMD_DELETE:
+      if(len < SIXP_REQ_LEN || body[2] != SIXP_CELL_OPTION_TX) {
+        rc = SIXP_RC_ERR;
+        break;
+      }
+      num_requested = body[3];
+      for(i = SIXP_REQ_LEN; i + SIXP_CELL_LEN <= len
+          && n < num_requested && n < SIXTOP_NUM_CANDIDATES; i += SIXP_CELL_LEN) {
+        read_cell(body + i, &cell);
+        if(command == SIXP_CMD_ADD) {
+          /* tsch_schedule_add_link replaces any link in the timeslot:
+           * only accept free ones */
+          if(!timeslot_is_free(cell.timeslot)
+             || tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL, src,
+                                       cell.timeslot, cell.channel_offset) == NULL) {
+            continue;
+          }
+        } else if(remove_links(src, LINK_OPTION_RX, &cell) == 0) {
+          continue;
+        }
+        msg_len += write_cell(msg + msg_len, &cell);
+        n++;
+      }
+      break;
+    case SIXP_CMD_CLEAR:
+      remove_links(src, LINK_OPTION_RX, NULL);
+      break;
+    default:
+      rc = SIXP_RC_ERR;
+      break;
+  }
+  PRINTF("6top: request %u cmd %u from %u, rc %u, %u cells\n",
+         seq, command, TSCH_LOG_ID_FROM_LINKADDR(src), rc, n);
+  write_header(msg, SIXP_TYPE_RESPONSE, rc, seq);
+  send_message(src, msg, msg_len, NULL, NULL);
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_input(const linkaddr_t *src, uint8_t rc, uint8_t seq,
+               const uint8_t *body, int len)
+{
+  struct sixtop_cell cell;
+  uint8_t command;
+  int i, j;
+
+  if(trans_command == 0 || seq != trans_seqnum || !linkaddr_cmp(src, &peer)) {
+    PRINTF("6top:! unexpected response %u from %u\n", seq, TSCH_LOG_ID_FROM_LINKADDR(src));
+    return;
+  }
+  command = trans_command;
+  trans_command = 0;
+  if(rc != SIXP_RC_SUCCESS) {
+    PRINTF("6top:! request %u failed, rc %u\n", seq, rc);
+    return;
+  }
+  for(i = 0; i + SIXP_CELL_LEN <= len; i += SIXP_CELL_LEN) {
+    read_cell(body + i, &cell);
+    /* Only consider cells we asked for */
+    for(j = 0; j < trans_num_cells; j++) {
+      if(trans_cells[j].timeslot == cell.timeslot
+         && trans_cells[j].channel_offset == cell.channel_offset) {
+        break;
+      }
+    }
+    if(j == trans_num_cells) {
+      continue;
+    }
+    if(command == SIXP_CMD_ADD) {
+      if(num_cells < SIXTOP_MAX_CELLS && timeslot_is_free(cell.timeslot)
+         && tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_NORMAL, &peer,
+                                   cell.timeslot, cell.channel_offset) != NULL) {
+        num_cells++;
+      }
+    } else if(command == SIXP_CMD_DELETE) {
+      num_cells -= remove_links(&peer, LINK_OPTION_TX, &cell);
+    }
+  }
+  PRINTF("6top: request %u done, %u cells to %u\n",
+         seq, num_cells, TSCH_LOG_ID_FROM_LINKADDR(src));
+  reset_window();
+}
+/*---------------------------------------------------------------------------*/
+/* Follow the time source. Cells to a former time source are cleared */
+static void
+update_peer(void)
+{
+  struct tsch_neighbor *n = tsch_is_associated ? tsch_queue_get_time_source() : NULL;
+  const linkaddr_t *new_peer = n != NULL ? &n->addr : &linkaddr_null;
+
+  if(!linkaddr_cmp(new_peer, &peer)) {
+    if(!linkaddr_cmp(&peer, &linkaddr_null)) {
+      clear_peer();
+    }
+    linkaddr_copy(&peer, new_peer);
+    trans_command = 0;
+    if(!linkaddr_cmp(&peer, &linkaddr_null)) {
+      /* The new time source may still have cells from a former association */
+      clear_peer();
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The scheduling function: adapt the number of cells to the traffic */
+static void
+adapt_cells(void)
+{
+  uint32_t elapsed;
+  uint32_t usage;
+  int queue_len;
+  int queue_high;
+
+  queue_len = tsch_queue_packet_count(&peer);
+  if(queue_len > 0) {
+    queue_sum += queue_len;
+  }
+  queue_samples++;
+
+  if(trans_command != 0) {
+    if(clock_time() - trans_start > SIXTOP_TIMEOUT) {
+      PRINTF("6top:! request %u timed out\n", trans_seqnum);
+      clear_peer();
+    }
+    return;
+  }
+
+  elapsed = (uint32_t)num_cells * TSCH_ASN_DIFF(tsch_current_asn, window_start)
+    / SIXTOP_SLOTFRAME_LENGTH;
+  if(num_cells > 0 ? elapsed < SIXTOP_MIN_ELAPSED : queue_samples < SIXTOP_MIN_SAMPLES) {
+    return;
+  }
+  usage = elapsed > 0 ? 100 * (uint32_t)cells_used / elapsed : 0;
+  queue_high = queue_sum >= SIXTOP_QUEUE_HIGH * queue_samples;
+
+  if(num_cells < SIXTOP_MAX_CELLS && (queue_high || usage >= SIXTOP_USAGE_HIGH)) {
+    request_add();
+  } else if(num_cells > 0 && usage < SIXTOP_USAGE_LOW && queue_sum == 0) {
+    request_delete();
+  }
+  reset_window();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(sixtop_process, ev, data)
+{
+  static struct etimer et;
+
+  PROCESS_BEGIN();
+
+  etimer_set(&et, SIXTOP_PERIOD);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+    /* The time source and the queues are not accessible while locked */
+    if(tsch_is_locked()) {
+      continue;
+    }
+    update_peer();
+    if(!linkaddr_cmp(&peer, &linkaddr_null)) {
+      adapt_cells();
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
+int
+sixtop_input(void)
+{
+  struct ieee802154_ies ies;
+  linkaddr_t src;
+  const uint8_t *msg;
+  int len;
+  uint8_t type;
+
+  if(!tsch_packet_parse_sixtop_ies(packetbuf_dataptr(), packetbuf_datalen(), &ies)) {
+    /* Not a 6P message */
+    return 0;
+  }
+  msg = ies.ie_sixtop;
+  len = ies.ie_sixtop_len;
+  if(sf == NULL
+     || !linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &linkaddr_node_addr)
+     || len < SIXP_HDR_LEN || (msg[0] & 0x0f) != SIXP_VERSION) {
+    return 1;
+  }
+  /* Responses overwrite packetbuf: keep the source address */
+  linkaddr_copy(&src, packetbuf_addr(PACKETBUF_ADDR_SENDER));
+  type = (msg[0] >> 4) & 0x03;
+  if(type == SIXP_TYPE_REQUEST) {
+    if(msg[2] != SIXTOP_SFID) {
+      uint8_t rsp[SIXP_HDR_LEN];
+      write_header(rsp, SIXP_TYPE_RESPONSE, SIXP_RC_ERR_SFID, msg[3]);
+      send_message(&src, rsp, SIXP_HDR_LEN, NULL, NULL);
+    } else {
+      request_input(&src, msg[1], msg[3], msg + SIXP_HDR_LEN, len - SIXP_HDR_LEN);
+    }
+  } else if(type == SIXP_TYPE_RESPONSE && msg[2] == SIXTOP_SFID) {
+    response_input(&src, msg[1], msg[3], msg + SIXP_HDR_LEN, len - SIXP_HDR_LEN);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+sixtop_link_used(const struct tsch_link *link)
+{
+  if(link != NULL && link->slotframe_handle == SIXTOP_SLOTFRAME_HANDLE
+     && (link->link_options & LINK_OPTION_TX)) {
+    cells_used++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+sixtop_num_cells(void)
+{
+  return num_cells;
+}
+/*---------------------------------------------------------------------------*/
+void
+sixtop_callback_neighbor_removed(const linkaddr_t *addr)
+{
+  int removed;
+
+  if(sf == NULL || addr == NULL) {
+    return;
+  }
+  /* Our Tx cells to the time source are released by update_peer */
+  removed = remove_links(addr, LINK_OPTION_RX, NULL);
+  if(removed > 0) {
+    PRINTF("6top: released %u cells of %u\n", removed, TSCH_LOG_ID_FROM_LINKADDR(addr));
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+sixtop_init(void)
+{
+  sf = tsch_schedule_get_slotframe_by_handle(SIXTOP_SLOTFRAME_HANDLE);
+  if(sf == NULL) {
+    sf = tsch_schedule_add_slotframe(SIXTOP_SLOTFRAME_HANDLE, SIXTOP_SLOTFRAME_LENGTH);
+  }
+  linkaddr_copy(&peer, &linkaddr_null);
+  seqnum = random_rand();
+  process_start(&sixtop_process, NULL);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_WITH_SIXTOP */
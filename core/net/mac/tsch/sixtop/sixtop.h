@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         6top (6P) cell negotiation and a traffic-adaptive scheduling
+ *         function. Every node negotiates dedicated Tx cells to its time
+ *         source, in a slotframe of its own, and adds or removes cells
+ *         depending on the occupancy of its queue and on the usage of the
+ *         cells it already has. 6P messages are carried in an IETF payload
+ *         IE, c.f. RFC 8480. Supported commands: ADD, DELETE and CLEAR.
+ */
+
+#ifndef __SIXTOP_H__
+#define __SIXTOP_H__
+
+/********** Includes **********/
+
+#include "contiki.h"
+#include "net/linkaddr.h"
+#include "net/mac/tsch/tsch-schedule.h"
+
+/******** Configuration *******/
+
+/* Handle of the slotframe holding the negotiated cells */
+#ifdef SIXTOP_CONF_SLOTFRAME_HANDLE
+#define SIXTOP_SLOTFRAME_HANDLE SIXTOP_CONF_SLOTFRAME_HANDLE
+#else
+#define SIXTOP_SLOTFRAME_HANDLE 3
+#endif
+
+/* Length of the slotframe holding the negotiated cells */
+#ifdef SIXTOP_CONF_SLOTFRAME_LENGTH
+#define SIXTOP_SLOTFRAME_LENGTH SIXTOP_CONF_SLOTFRAME_LENGTH
+#else
+#define SIXTOP_SLOTFRAME_LENGTH 31
+#endif
+
+/* Negotiated cells use channel offsets 1 to SIXTOP_NUM_CHANNEL_OFFSETS */
+#ifdef SIXTOP_CONF_NUM_CHANNEL_OFFSETS
+#define SIXTOP_NUM_CHANNEL_OFFSETS SIXTOP_CONF_NUM_CHANNEL_OFFSETS
+#else
+#define SIXTOP_NUM_CHANNEL_OFFSETS 3
+#endif
+
+/* Maximum number of Tx cells to the time source */
+#ifdef SIXTOP_CONF_MAX_CELLS
+#define SIXTOP_MAX_CELLS SIXTOP_CONF_MAX_CELLS
+#else
+#define SIXTOP_MAX_CELLS 8
+#endif
+
+/* Number of candidate cells proposed in an ADD request */
+#ifdef SIXTOP_CONF_NUM_CANDIDATES
+#define SIXTOP_NUM_CANDIDATES SIXTOP_CONF_NUM_CANDIDATES
+#else
+#define SIXTOP_NUM_CANDIDATES 3
+#endif
+
+/* Time after which a transaction without response is given up. Both
+ * sides then clear the cells they have in common */
+#ifdef SIXTOP_CONF_TIMEOUT
+#define SIXTOP_TIMEOUT SIXTOP_CONF_TIMEOUT
+#else
+#define SIXTOP_TIMEOUT (10 * CLOCK_SECOND)
+#endif
+
+/* Period at which the scheduling function samples the queue and
+ * re-evaluates the number of cells */
+#ifdef SIXTOP_CONF_PERIOD
+#define SIXTOP_PERIOD SIXTOP_CONF_PERIOD
+#else
+#define SIXTOP_PERIOD (CLOCK_SECOND / 2)
+#endif
+
+/* Minimum number of elapsed cells before deciding on their usage */
+#ifdef SIXTOP_CONF_MIN_ELAPSED
+#define SIXTOP_MIN_ELAPSED SIXTOP_CONF_MIN_ELAPSED
+#else
+#define SIXTOP_MIN_ELAPSED 16
+#endif
+
+/* Add a cell above this usage of the current cells, in percent */
+#ifdef SIXTOP_CONF_USAGE_HIGH
+#define SIXTOP_USAGE_HIGH SIXTOP_CONF_USAGE_HIGH
+#else
+#define SIXTOP_USAGE_HIGH 75
+#endif
+
+/* Remove a cell below this usage of the current cells, in percent */
+#ifdef SIXTOP_CONF_USAGE_LOW
+#define SIXTOP_USAGE_LOW SIXTOP_CONF_USAGE_LOW
+#else
+#define SIXTOP_USAGE_LOW 25
+#endif
+
+/* Add a cell when the average queue towards the time source reaches
+ * this many packets */
+#ifdef SIXTOP_CONF_QUEUE_HIGH
+#define SIXTOP_QUEUE_HIGH SIXTOP_CONF_QUEUE_HIGH
+#else
+#define SIXTOP_QUEUE_HIGH 1
+#endif
+
+/* Scheduling function identifier. In the range reserved for experimental use */
+#ifdef SIXTOP_CONF_SFID
+#define SIXTOP_SFID SIXTOP_CONF_SFID
+#else
+#define SIXTOP_SFID 0xf0
+#endif
+
+/********** Constants *********/
+
+/* 6P message types and codes, c.f. RFC 8480 */
+#define SIXP_VERSION                0
+#define SIXP_TYPE_REQUEST           0
+#define SIXP_TYPE_RESPONSE          1
+#define SIXP_CMD_ADD                1
+#define SIXP_CMD_DELETE             2
+#define SIXP_CMD_CLEAR              7
+#define SIXP_RC_SUCCESS             0
+#define SIXP_RC_ERR                 2
+#define SIXP_RC_ERR_SFID            5
+#define SIXP_CELL_OPTION_TX         0x01
+
+/********** Data types **********/
+
+/* A cell of the negotiated slotframe */
+struct sixtop_cell {
+  uint16_t timeslot;
+  uint16_t channel_offset;
+};
+
+/********** Functions *********/
+
+/* Start 6top. Called by TSCH when starting, if TSCH_WITH_SIXTOP */
+void sixtop_init(void);
+/* Process a 6P message, in packetbuf. Called by TSCH for frames with
+ * an IE list. Returns 1 if the frame carried a 6P message, 0 if it is
+ * to be passed to upper layers */
+int sixtop_input(void);
+/* A packet was transmitted in a link. Called by TSCH, from interrupt */
+void sixtop_link_used(const struct tsch_link *link);
+/* Returns the current number of Tx cells to the time source */
+int sixtop_num_cells(void);
+/* Release the cells negotiated with a neighbor that is gone. Set
+ * NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK to it, so that a
+ * node frees the Rx cells of a child that has left */
+void sixtop_callback_neighbor_removed(const linkaddr_t *addr);
+
+#endif /* __SIXTOP_H__ */
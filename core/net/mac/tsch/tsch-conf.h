@@ -170,6 +170,22 @@
 #define TSCH_WITH_LINK_SELECTOR 0
 #endif /* TSCH_CONF_WITH_LINK_SELECTOR */
 
+/* Negotiate dedicated cells with the time source through 6top (6P)
+ * messages. Needs MODULES += core/net/mac/tsch/sixtop */
+#ifdef TSCH_CONF_WITH_SIXTOP
+#define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
+#else /* TSCH_CONF_WITH_SIXTOP */
+#define TSCH_WITH_SIXTOP 0
+#endif /* TSCH_CONF_WITH_SIXTOP */
+
+/* Record, for every slot, when each phase of the slot operation ends and
+ * its deadline. The records are read with tsch_slot_trace_get() */
+#ifdef TSCH_CONF_WITH_SLOT_TRACE
+#define TSCH_WITH_SLOT_TRACE TSCH_CONF_WITH_SLOT_TRACE
+#else /* TSCH_CONF_WITH_SLOT_TRACE */
+#define TSCH_WITH_SLOT_TRACE 0
+#endif /* TSCH_CONF_WITH_SLOT_TRACE */
+
 /* Estimate the drift of the time-source neighbor and compensate for it? */
 #ifdef TSCH_CONF_ADAPTIVE_TIMESYNC
 #define TSCH_ADAPTIVE_TIMESYNC TSCH_CONF_ADAPTIVE_TIMESYNC
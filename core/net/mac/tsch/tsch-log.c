@@ -103,6 +103,11 @@ tsch_log_process_pending(void)
         if(log->tx.drift_used) {
           printf(", dr %d", log->tx.drift);
         }
+#if TSCH_QUEUE_WITH_CLASSES
+        if(log->tx.num_tx == 1) {
+          printf(", cl %u qd %u", log->tx.tx_class, log->tx.queue_delay);
+        }
+#endif /* TSCH_QUEUE_WITH_CLASSES */
         printf("\n");
         break;
       case tsch_log_rx:
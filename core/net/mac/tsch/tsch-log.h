@@ -38,6 +38,7 @@
 #include "contiki.h"
 #include "sys/rtimer.h"
 #include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/tsch-queue.h"
 
 /******** Configuration *******/
 
@@ -94,6 +95,10 @@ struct tsch_log_t {
       uint8_t is_data;
       uint8_t sec_level;
       uint8_t drift_used;
+#if TSCH_QUEUE_WITH_CLASSES
+      uint8_t tx_class;
+      uint16_t queue_delay; /* in timeslots, logged at the first transmission */
+#endif /* TSCH_QUEUE_WITH_CLASSES */
     } tx;
     struct {
       int src;
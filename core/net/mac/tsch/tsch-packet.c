@@ -410,3 +410,46 @@ tsch_packet_parse_eb(const uint8_t *buf, int buf_size,
   return curr_len;
 }
 /*---------------------------------------------------------------------------*/
+/* Create the Information Elements carrying a 6P message */
+int
+tsch_packet_create_sixtop_ies(uint8_t *buf, int buf_size,
+                              const uint8_t *msg, uint8_t msg_len)
+{
+  int ret;
+  uint8_t curr_len = 0;
+  struct ieee802154_ies ies;
+
+  memset(&ies, 0, sizeof(ies));
+  ies.ie_sixtop = msg;
+  ies.ie_sixtop_len = msg_len;
+
+  /* Header-IE termination IE, as next come payload IEs */
+  if((ret = frame80215e_create_ie_header_list_termination_1(buf + curr_len, buf_size - curr_len, &ies)) == -1) {
+    return -1;
+  }
+  curr_len += ret;
+
+  if((ret = frame80215e_create_ie_ietf_sixtop(buf + curr_len, buf_size - curr_len, &ies)) == -1) {
+    return -1;
+  }
+  curr_len += ret;
+
+  return curr_len;
+}
+/*---------------------------------------------------------------------------*/
+/* Parse the Information Elements of a frame payload and extract the 6P message */
+int
+tsch_packet_parse_sixtop_ies(const uint8_t *buf, int buf_size,
+                             struct ieee802154_ies *ies)
+{
+  if(ies == NULL || buf_size < 0) {
+    return 0;
+  }
+  memset(ies, 0, sizeof(struct ieee802154_ies));
+  if(frame802154e_parse_information_elements(buf, buf_size, ies) == -1) {
+    PRINTF("TSCH:! parse_sixtop: failed to parse IEs\n");
+    return 0;
+  }
+  return ies->ie_sixtop != NULL;
+}
+/*---------------------------------------------------------------------------*/
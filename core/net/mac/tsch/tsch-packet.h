@@ -101,5 +101,12 @@ int tsch_packet_update_eb(uint8_t *buf, int buf_size, uint8_t tsch_sync_ie_offse
 int tsch_packet_parse_eb(const uint8_t *buf, int buf_size,
     frame802154_t *frame, struct ieee802154_ies *ies,
     uint8_t *hdrlen, int frame_without_mic);
+/* Create the Information Elements carrying a 6P message, to be used as
+ * frame payload. Returns their length */
+int tsch_packet_create_sixtop_ies(uint8_t *buf, int buf_size,
+    const uint8_t *msg, uint8_t msg_len);
+/* Parse the Information Elements of a frame payload and extract the 6P message */
+int tsch_packet_parse_sixtop_ies(const uint8_t *buf, int buf_size,
+    struct ieee802154_ies *ies);
 
 #endif /* __TSCH_PACKET_H__ */
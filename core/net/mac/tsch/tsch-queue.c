@@ -54,6 +54,9 @@
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/tsch/tsch-slot-operation.h"
 #include "net/mac/tsch/tsch-log.h"
+#if TSCH_QUEUE_WITH_CLASSES && NETSTACK_CONF_WITH_IPV6
+#include "net/ipv6/uip-icmp6.h"
+#endif /* TSCH_QUEUE_WITH_CLASSES && NETSTACK_CONF_WITH_IPV6 */
 #include <string.h>
 
 #if TSCH_LOG_LEVEL >= 1
@@ -68,6 +71,17 @@
 #error TSCH_QUEUE_NUM_PER_NEIGHBOR must be power of two
 #endif
 
+#if TSCH_QUEUE_WITH_CLASSES
+/* Check if TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR is power of two */
+#if (TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR & (TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR - 1)) != 0
+#error TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR must be power of two
+#endif
+/* Data packets must be able to take at least one packet buffer */
+#if QUEUEBUF_NUM <= TSCH_QUEUE_CONTROL_RESERVE
+#error QUEUEBUF_NUM must be larger than TSCH_QUEUE_CONTROL_RESERVE
+#endif
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+
 /* We have as many packets are there are queuebuf in the system */
 MEMB(packet_memb, struct tsch_packet, QUEUEBUF_NUM);
 MEMB(neighbor_memb, struct tsch_neighbor, TSCH_QUEUE_MAX_NEIGHBOR_QUEUES);
@@ -77,6 +91,13 @@ LIST(neighbor_list);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_QUEUE_WITH_CLASSES
+/* The unicast neighbor last served over a shared link */
+static struct tsch_neighbor *rr_last;
+/* Per-class queue statistics */
+static struct tsch_queue_stats queue_stats[TSCH_QUEUE_NUM_CLASSES];
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
@@ -93,6 +114,9 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
         /* Initialize neighbor entry */
         memset(n, 0, sizeof(struct tsch_neighbor));
         ringbufindex_init(&n->tx_ringbuf, TSCH_QUEUE_NUM_PER_NEIGHBOR);
+#if TSCH_QUEUE_WITH_CLASSES
+        ringbufindex_init(&n->control_ringbuf, TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
         linkaddr_copy(&n->addr, addr);
         n->is_broadcast = linkaddr_cmp(addr, &tsch_eb_address)
           || linkaddr_cmp(addr, &tsch_broadcast_address);
@@ -215,6 +239,11 @@ tsch_queue_remove_nbr(struct tsch_neighbor *n)
 
       /* Remove neighbor from list */
       list_remove(neighbor_list, n);
+#if TSCH_QUEUE_WITH_CLASSES
+      if(rr_last == n) {
+        rr_last = NULL;
+      }
+#endif /* TSCH_QUEUE_WITH_CLASSES */
 
       tsch_release_lock();
 
@@ -227,6 +256,37 @@ tsch_queue_remove_nbr(struct tsch_neighbor *n)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_CLASSES
+/* Returns the traffic class of the packet in packetbuf */
+static uint8_t
+packet_class(void)
+{
+#ifdef TSCH_CALLBACK_PACKET_CLASS
+  return TSCH_CALLBACK_PACKET_CLASS();
+#else
+  /* EBs, ACKs and commands, as well as keepalives (empty data frames) */
+  if(packetbuf_attr(PACKETBUF_ATTR_FRAME_TYPE) != FRAME802154_DATAFRAME
+     || packetbuf_datalen() == 0) {
+    return TSCH_QUEUE_CLASS_CONTROL;
+  }
+#if TSCH_WITH_SIXTOP
+  /* 6P messages */
+  if(packetbuf_attr(PACKETBUF_ATTR_MAC_IE_LIST_PRESENT)) {
+    return TSCH_QUEUE_CLASS_CONTROL;
+  }
+#endif /* TSCH_WITH_SIXTOP */
+#if NETSTACK_CONF_WITH_IPV6
+  /* RPL control messages */
+  if(packetbuf_attr(PACKETBUF_ATTR_NETWORK_ID) == UIP_PROTO_ICMP6
+     && (packetbuf_attr(PACKETBUF_ATTR_CHANNEL) >> 8) == ICMP6_RPL) {
+    return TSCH_QUEUE_CLASS_CONTROL;
+  }
+#endif /* NETSTACK_CONF_WITH_IPV6 */
+  return TSCH_QUEUE_CLASS_DATA;
+#endif
+}
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+/*---------------------------------------------------------------------------*/
 /* Add packet to neighbor queue. Use same lockfree implementation as ringbuf.c (put is atomic) */
 struct tsch_packet *
 tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
@@ -234,10 +294,33 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
   struct tsch_neighbor *n = NULL;
   int16_t put_index = -1;
   struct tsch_packet *p = NULL;
+#if TSCH_QUEUE_WITH_CLASSES
+  struct ringbufindex *ringbuf;
+  struct tsch_packet **array;
+  uint8_t tx_class = packet_class();
+#endif /* TSCH_QUEUE_WITH_CLASSES */
   if(!tsch_is_locked()) {
     n = tsch_queue_add_nbr(addr);
     if(n != NULL) {
+#if TSCH_QUEUE_WITH_CLASSES
+      ringbuf = &n->tx_ringbuf;
+      array = n->tx_array;
+      if(tx_class == TSCH_QUEUE_CLASS_CONTROL) {
+        if(ringbufindex_peek_put(&n->control_ringbuf) != -1) {
+          ringbuf = &n->control_ringbuf;
+          array = n->control_array;
+        }
+        /* Else, spill over to the data queue */
+      } else if(memb_numfree(&packet_memb) <= TSCH_QUEUE_CONTROL_RESERVE) {
+        /* Keep the last packets for control traffic */
+        ringbuf = NULL;
+      }
+      if(ringbuf != NULL) {
+        put_index = ringbufindex_peek_put(ringbuf);
+      }
+#else /* TSCH_QUEUE_WITH_CLASSES */
       put_index = ringbufindex_peek_put(&n->tx_ringbuf);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
       if(put_index != -1) {
         p = memb_alloc(&packet_memb);
         if(p != NULL) {
@@ -251,9 +334,17 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
             p->ptr = ptr;
             p->ret = MAC_TX_DEFERRED;
             p->transmissions = 0;
+#if TSCH_QUEUE_WITH_CLASSES
+            p->tx_class = tx_class;
+            p->enqueue_asn = tsch_current_asn;
+            /* Add to ringbuf (actual add committed through atomic operation) */
+            array[put_index] = p;
+            ringbufindex_put(ringbuf);
+#else /* TSCH_QUEUE_WITH_CLASSES */
             /* Add to ringbuf (actual add committed through atomic operation) */
             n->tx_array[put_index] = p;
             ringbufindex_put(&n->tx_ringbuf);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
             PRINTF("TSCH-queue: packet is added put_index=%u, packet=%p\n",
                    put_index, p);
             return p;
@@ -265,6 +356,9 @@ tsch_queue_add_packet(const linkaddr_t *addr, mac_callback_t sent, void *ptr)
     }
   }
   PRINTF("TSCH-queue:! add packet failed: %u %p %d %p %p\n", tsch_is_locked(), n, put_index, p, p ? p->qb : NULL);
+#if TSCH_QUEUE_WITH_CLASSES
+  queue_stats[tx_class].drops++;
+#endif /* TSCH_QUEUE_WITH_CLASSES */
   return 0;
 }
 /*---------------------------------------------------------------------------*/
@@ -276,7 +370,12 @@ tsch_queue_packet_count(const linkaddr_t *addr)
   if(!tsch_is_locked()) {
     n = tsch_queue_add_nbr(addr);
     if(n != NULL) {
+#if TSCH_QUEUE_WITH_CLASSES
+      return ringbufindex_elements(&n->control_ringbuf)
+        + ringbufindex_elements(&n->tx_ringbuf);
+#else /* TSCH_QUEUE_WITH_CLASSES */
       return ringbufindex_elements(&n->tx_ringbuf);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
     }
   }
   return -1;
@@ -288,8 +387,17 @@ tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
 {
   if(!tsch_is_locked()) {
     if(n != NULL) {
+      int16_t get_index;
+#if TSCH_QUEUE_WITH_CLASSES
+      /* Control packets go first */
+      get_index = ringbufindex_get(&n->control_ringbuf);
+      if(get_index != -1) {
+        PRINTF("TSCH-queue: control packet is removed, get_index=%u\n", get_index);
+        return n->control_array[get_index];
+      }
+#endif /* TSCH_QUEUE_WITH_CLASSES */
       /* Get and remove packet from ringbuf (remove committed through an atomic operation */
-      int16_t get_index = ringbufindex_get(&n->tx_ringbuf);
+      get_index = ringbufindex_get(&n->tx_ringbuf);
       if(get_index != -1) {
         PRINTF("TSCH-queue: packet is removed, get_index=%u\n", get_index);
         return n->tx_array[get_index];
@@ -301,6 +409,59 @@ tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_QUEUE_WITH_CLASSES
+/* Remove a packet from the head of the neighbor queue it is in. Unlike
+ * tsch_queue_remove_packet_from_queue, this is not confused by a control
+ * packet added after p was picked for transmission */
+struct tsch_packet *
+tsch_queue_remove_packet(struct tsch_neighbor *n, struct tsch_packet *p)
+{
+  if(!tsch_is_locked()) {
+    if(n != NULL && p != NULL) {
+      int16_t get_index = ringbufindex_peek_get(&n->control_ringbuf);
+      if(get_index != -1 && n->control_array[get_index] == p) {
+        ringbufindex_get(&n->control_ringbuf);
+        return p;
+      }
+      get_index = ringbufindex_peek_get(&n->tx_ringbuf);
+      if(get_index != -1 && n->tx_array[get_index] == p) {
+        ringbufindex_get(&n->tx_ringbuf);
+        return p;
+      }
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Update the statistics for the first transmission of a packet.
+ * Returns its queueing delay, in timeslots */
+uint16_t
+tsch_queue_first_tx(struct tsch_packet *p)
+{
+  struct tsch_queue_stats *stats = &queue_stats[p->tx_class];
+  uint32_t delay = TSCH_ASN_DIFF(tsch_current_asn, p->enqueue_asn);
+  if(delay > 0xffff) {
+    delay = 0xffff;
+  }
+  stats->packets++;
+  stats->delay_sum += delay;
+  if(delay > stats->delay_max) {
+    stats->delay_max = delay;
+  }
+  return delay;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the queue statistics of a traffic class */
+const struct tsch_queue_stats *
+tsch_queue_get_stats(uint8_t tx_class)
+{
+  if(tx_class < TSCH_QUEUE_NUM_CLASSES) {
+    return &queue_stats[tx_class];
+  }
+  return NULL;
+}
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+/*---------------------------------------------------------------------------*/
 /* Free a packet */
 void
 tsch_queue_free_packet(struct tsch_packet *p)
@@ -353,7 +514,37 @@ tsch_queue_free_unused_neighbors(void)
 int
 tsch_queue_is_empty(const struct tsch_neighbor *n)
 {
+#if TSCH_QUEUE_WITH_CLASSES
+  return !tsch_is_locked() && n != NULL && ringbufindex_empty(&n->tx_ringbuf)
+    && ringbufindex_empty(&n->control_ringbuf);
+#else /* TSCH_QUEUE_WITH_CLASSES */
   return !tsch_is_locked() && n != NULL && ringbufindex_empty(&n->tx_ringbuf);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the first packet from one of the neighbor queues */
+static struct tsch_packet *
+get_packet(const struct tsch_neighbor *n, struct tsch_link *link,
+           const struct ringbufindex *ringbuf, struct tsch_packet * const *array)
+{
+  int is_shared_link = link != NULL && link->link_options & LINK_OPTION_SHARED;
+  int16_t get_index = ringbufindex_peek_get(ringbuf);
+  if(get_index != -1 &&
+      !(is_shared_link && !tsch_queue_backoff_expired(n))) {    /* If this is a shared link,
+                                                                make sure the backoff has expired */
+#if TSCH_WITH_LINK_SELECTOR
+    int packet_attr_slotframe = queuebuf_attr(array[get_index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
+    int packet_attr_timeslot = queuebuf_attr(array[get_index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
+    if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
+      return NULL;
+    }
+    if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
+      return NULL;
+    }
+#endif
+    return array[get_index];
+  }
+  return NULL;
 }
 /*---------------------------------------------------------------------------*/
 /* Returns the first packet from a neighbor queue */
@@ -361,24 +552,14 @@ struct tsch_packet *
 tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
-    int is_shared_link = link != NULL && link->link_options & LINK_OPTION_SHARED;
     if(n != NULL) {
-      int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
-      if(get_index != -1 &&
-          !(is_shared_link && !tsch_queue_backoff_expired(n))) {    /* If this is a shared link,
-                                                                    make sure the backoff has expired */
-#if TSCH_WITH_LINK_SELECTOR
-        int packet_attr_slotframe = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
-        int packet_attr_timeslot = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
-        if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
-          return NULL;
-        }
-        if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
-          return NULL;
-        }
-#endif
-        return n->tx_array[get_index];
+#if TSCH_QUEUE_WITH_CLASSES
+      /* Strict priority: data is sent only when no control packet is pending */
+      if(!ringbufindex_empty(&n->control_ringbuf)) {
+        return get_packet(n, link, &n->control_ringbuf, n->control_array);
       }
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+      return get_packet(n, link, &n->tx_ringbuf, n->tx_array);
     }
   }
   return NULL;
@@ -400,6 +581,44 @@ struct tsch_packet *
 tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
+#if TSCH_QUEUE_WITH_CLASSES
+    /* Look for a control packet first, then for a data packet. Each pass
+     * starts after the neighbor served last, so that neighbors take turns */
+    struct tsch_neighbor *start = rr_last != NULL ? list_item_next(rr_last) : NULL;
+    struct tsch_neighbor *curr_nbr;
+    struct tsch_packet *p = NULL;
+    int pass;
+    if(start == NULL) {
+      start = list_head(neighbor_list);
+      if(start == NULL) {
+        return NULL;
+      }
+    }
+    for(pass = 0; pass < TSCH_QUEUE_NUM_CLASSES; pass++) {
+      curr_nbr = start;
+      do {
+        if(!curr_nbr->is_broadcast && curr_nbr->tx_links_count == 0) {
+          /* Only look up for non-broadcast neighbors we do not have a tx link to */
+          if(pass == TSCH_QUEUE_CLASS_CONTROL) {
+            p = get_packet(curr_nbr, link, &curr_nbr->control_ringbuf, curr_nbr->control_array);
+          } else if(ringbufindex_empty(&curr_nbr->control_ringbuf)) {
+            p = get_packet(curr_nbr, link, &curr_nbr->tx_ringbuf, curr_nbr->tx_array);
+          }
+          if(p != NULL) {
+            rr_last = curr_nbr;
+            if(n != NULL) {
+              *n = curr_nbr;
+            }
+            return p;
+          }
+        }
+        curr_nbr = list_item_next(curr_nbr);
+        if(curr_nbr == NULL) {
+          curr_nbr = list_head(neighbor_list);
+        }
+      } while(curr_nbr != start);
+    }
+#else /* TSCH_QUEUE_WITH_CLASSES */
     struct tsch_neighbor *curr_nbr = list_head(neighbor_list);
     struct tsch_packet *p = NULL;
     while(curr_nbr != NULL) {
@@ -415,6 +634,7 @@ tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link
       }
       curr_nbr = list_item_next(curr_nbr);
     }
+#endif /* TSCH_QUEUE_WITH_CLASSES */
   }
   return NULL;
 }
@@ -474,6 +694,10 @@ tsch_queue_init(void)
   list_init(neighbor_list);
   memb_init(&neighbor_memb);
   memb_init(&packet_memb);
+#if TSCH_QUEUE_WITH_CLASSES
+  rr_last = NULL;
+  memset(queue_stats, 0, sizeof(queue_stats));
+#endif /* TSCH_QUEUE_WITH_CLASSES */
   /* Add virtual EB and the broadcast neighbors */
   n_eb = tsch_queue_add_nbr(&tsch_eb_address);
   n_broadcast = tsch_queue_add_nbr(&tsch_broadcast_address);
@@ -77,6 +77,33 @@
 #define TSCH_QUEUE_MAX_NEIGHBOR_QUEUES ((NBR_TABLE_CONF_MAX_NEIGHBORS) + 2)
 #endif
 
+/* Traffic classes. When enabled, every neighbor has a separate queue
+ * for control packets (RPL, keepalives, EBs), which is served before
+ * its data queue. Shared links serve the neighbors in turn, control
+ * packets first. */
+#ifdef TSCH_QUEUE_CONF_WITH_CLASSES
+#define TSCH_QUEUE_WITH_CLASSES TSCH_QUEUE_CONF_WITH_CLASSES
+#else
+#define TSCH_QUEUE_WITH_CLASSES 0
+#endif
+
+/* The maximum number of outgoing control packets towards each neighbor.
+ * Must be power of two. Control packets that do not fit are put in the
+ * data queue. */
+#ifdef TSCH_QUEUE_CONF_NUM_CONTROL_PER_NEIGHBOR
+#define TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR TSCH_QUEUE_CONF_NUM_CONTROL_PER_NEIGHBOR
+#else
+#define TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR 4
+#endif
+
+/* Number of packet buffers that data packets may not take, so that
+ * control packets can still be queued when data fills the queues */
+#ifdef TSCH_QUEUE_CONF_CONTROL_RESERVE
+#define TSCH_QUEUE_CONTROL_RESERVE TSCH_QUEUE_CONF_CONTROL_RESERVE
+#else
+#define TSCH_QUEUE_CONTROL_RESERVE 1
+#endif
+
 /* TSCH CSMA-CA parameters, see IEEE 802.15.4e-2012 */
 /* Min backoff exponent */
 #ifdef TSCH_CONF_MAC_MIN_BE
@@ -110,6 +137,19 @@ void TSCH_CALLBACK_NEW_TIME_SOURCE(const struct tsch_neighbor *old, const struct
 void TSCH_CALLBACK_PACKET_READY(void);
 #endif
 
+/* Called by TSCH to get the traffic class of the packet in packetbuf,
+ * instead of the default classification */
+#ifdef TSCH_CALLBACK_PACKET_CLASS
+uint8_t TSCH_CALLBACK_PACKET_CLASS(void);
+#endif
+
+/********** Constants *********/
+
+/* Traffic classes, by decreasing priority */
+#define TSCH_QUEUE_CLASS_CONTROL    0
+#define TSCH_QUEUE_CLASS_DATA       1
+#define TSCH_QUEUE_NUM_CLASSES      2
+
 /************ Types ***********/
 
 /* TSCH packet information */
@@ -121,7 +161,21 @@ struct tsch_packet {
   uint8_t ret; /* status -- MAC return code */
   uint8_t header_len; /* length of header and header IEs (needed for link-layer security) */
   uint8_t tsch_sync_ie_offset; /* Offset within the frame used for quick update of EB ASN and join priority */
+#if TSCH_QUEUE_WITH_CLASSES
+  uint8_t tx_class; /* traffic class */
+  struct tsch_asn_t enqueue_asn; /* ASN at which the packet was queued */
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+};
+
+#if TSCH_QUEUE_WITH_CLASSES
+/* Queue statistics of a traffic class */
+struct tsch_queue_stats {
+  uint32_t packets; /* #packets transmitted at least once */
+  uint32_t delay_sum; /* sum of their queueing delays, in timeslots */
+  uint16_t delay_max; /* longest queueing delay, in timeslots */
+  uint16_t drops; /* #packets refused by the queue */
 };
+#endif /* TSCH_QUEUE_WITH_CLASSES */
 
 /* TSCH neighbor information */
 struct tsch_neighbor {
@@ -140,6 +194,11 @@ struct tsch_neighbor {
   struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
   /* Circular buffer of pointers to packet. */
   struct ringbufindex tx_ringbuf;
+#if TSCH_QUEUE_WITH_CLASSES
+  /* Same for control packets */
+  struct tsch_packet *control_array[TSCH_QUEUE_NUM_CONTROL_PER_NEIGHBOR];
+  struct ringbufindex control_ringbuf;
+#endif /* TSCH_QUEUE_WITH_CLASSES */
 };
 
 /***** External Variables *****/
@@ -165,6 +224,15 @@ int tsch_queue_packet_count(const linkaddr_t *addr);
 /* Remove first packet from a neighbor queue. The packet is stored in a separate
  * dequeued packet list, for later processing. Return the packet. */
 struct tsch_packet *tsch_queue_remove_packet_from_queue(struct tsch_neighbor *n);
+#if TSCH_QUEUE_WITH_CLASSES
+/* Remove a packet from the head of the neighbor queue it is in */
+struct tsch_packet *tsch_queue_remove_packet(struct tsch_neighbor *n, struct tsch_packet *p);
+/* Update the statistics for the first transmission of a packet.
+ * Returns its queueing delay, in timeslots */
+uint16_t tsch_queue_first_tx(struct tsch_packet *p);
+/* Returns the queue statistics of a traffic class */
+const struct tsch_queue_stats *tsch_queue_get_stats(uint8_t tx_class);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
 /* Free a packet */
 void tsch_queue_free_packet(struct tsch_packet *p);
 /* Reset neighbor queues */
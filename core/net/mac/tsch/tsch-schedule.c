@@ -69,6 +69,61 @@ MEMB(slotframe_memb, struct tsch_slotframe, TSCH_SCHEDULE_MAX_SLOTFRAMES);
 /* List of slotframes (each slotframe holds its own list of links) */
 LIST(slotframe_list);
 
+#if TSCH_SCHEDULE_COMPILED
+/* The links of every slotframe, one slotframe after the other, each
+ * sorted by timeslot */
+static struct tsch_link *link_index[TSCH_SCHEDULE_MAX_LINKS];
+
+/*---------------------------------------------------------------------------*/
+/* Rebuilds the link index, call with the lock taken */
+static void
+compile_schedule(void)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  uint16_t n = 0;
+  uint16_t i;
+
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    sf->index_start = n;
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      /* Insertion sort, the lists are short */
+      for(i = n; i > sf->index_start && link_index[i - 1]->timeslot > l->timeslot; i--) {
+        link_index[i] = link_index[i - 1];
+      }
+      link_index[i] = l;
+      n++;
+    }
+    sf->index_len = n - sf->index_start;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the link of a slotframe that comes first after a timeslot */
+static struct tsch_link *
+compiled_next_link(const struct tsch_slotframe *sf, uint16_t timeslot)
+{
+  struct tsch_link **links = &link_index[sf->index_start];
+  uint16_t lo = 0;
+  uint16_t hi = sf->index_len;
+  uint16_t mid;
+
+  if(hi == 0) {
+    return NULL;
+  }
+  /* Look for the first link with a later timeslot */
+  while(lo < hi) {
+    mid = (lo + hi) / 2;
+    if(links[mid]->timeslot > timeslot) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  /* If there is none, the first link in the next slotframe cycle */
+  return links[lo < sf->index_len ? lo : 0];
+}
+#endif /* TSCH_SCHEDULE_COMPILED */
+
 /* Adds and returns a slotframe (NULL if failure) */
 struct tsch_slotframe *
 tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
@@ -91,6 +146,9 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
       LIST_STRUCT_INIT(sf, links_list);
       /* Add the slotframe to the global list */
       list_add(slotframe_list, sf);
+#if TSCH_SCHEDULE_COMPILED
+      compile_schedule();
+#endif /* TSCH_SCHEDULE_COMPILED */
     }
     PRINTF("TSCH-schedule: add_slotframe %u %u\n",
            handle, size);
@@ -129,6 +187,9 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
       PRINTF("TSCH-schedule: remove slotframe %u %u\n", slotframe->handle, slotframe->size.val);
       memb_free(&slotframe_memb, slotframe);
       list_remove(slotframe_list, slotframe);
+#if TSCH_SCHEDULE_COMPILED
+      compile_schedule();
+#endif /* TSCH_SCHEDULE_COMPILED */
       tsch_release_lock();
       return 1;
     }
@@ -209,6 +270,9 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
           address = &linkaddr_null;
         }
         linkaddr_copy(&l->addr, address);
+#if TSCH_SCHEDULE_COMPILED
+        compile_schedule();
+#endif /* TSCH_SCHEDULE_COMPILED */
 
         PRINTF("TSCH-schedule: add_link %u %u %u %u %u %u\n",
                slotframe->handle, link_options, link_type, timeslot, channel_offset, TSCH_LOG_ID_FROM_LINKADDR(address));
@@ -257,6 +321,9 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
 
       list_remove(slotframe->links_list, l);
       memb_free(&link_memb, l);
+#if TSCH_SCHEDULE_COMPILED
+      compile_schedule();
+#endif /* TSCH_SCHEDULE_COMPILED */
 
       /* Release the lock before we update the neighbor (will take the lock) */
       tsch_release_lock();
@@ -325,7 +392,13 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
       uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+#if TSCH_SCHEDULE_COMPILED
+      /* With one link per timeslot, only the first link after the
+       * current timeslot can be the earliest of this slotframe */
+      struct tsch_link *l = compiled_next_link(sf, timeslot);
+#else /* TSCH_SCHEDULE_COMPILED */
       struct tsch_link *l = list_head(sf->links_list);
+#endif /* TSCH_SCHEDULE_COMPILED */
       while(l != NULL) {
         uint16_t time_to_timeslot =
           l->timeslot > timeslot ?
@@ -369,7 +442,11 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
           }
         }
 
+#if TSCH_SCHEDULE_COMPILED
+        l = NULL;
+#else /* TSCH_SCHEDULE_COMPILED */
         l = list_item_next(l);
+#endif /* TSCH_SCHEDULE_COMPILED */
       }
       sf = list_item_next(sf);
     }
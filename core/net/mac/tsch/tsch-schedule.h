@@ -72,6 +72,15 @@
 #define TSCH_SCHEDULE_MAX_LINKS 32
 #endif
 
+/* Keep the links of every slotframe in an array sorted by timeslot,
+ * rebuilt on every schedule change. The next active link is then found
+ * with one binary search per slotframe instead of a scan of all links. */
+#ifdef TSCH_SCHEDULE_CONF_COMPILED
+#define TSCH_SCHEDULE_COMPILED TSCH_SCHEDULE_CONF_COMPILED
+#else
+#define TSCH_SCHEDULE_COMPILED 0
+#endif
+
 /********** Constants *********/
 
 /* Link options */
@@ -122,6 +131,12 @@ struct tsch_slotframe {
   struct tsch_asn_divisor_t size;
   /* List of links belonging to this slotframe */
   LIST_STRUCT(links_list);
+#if TSCH_SCHEDULE_COMPILED
+  /* Position and number of the links of this slotframe in the
+   * sorted link index */
+  uint16_t index_start;
+  uint16_t index_len;
+#endif /* TSCH_SCHEDULE_COMPILED */
 };
 
 /********** Functions *********/
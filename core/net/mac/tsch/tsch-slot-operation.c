@@ -54,6 +54,9 @@
 #include "net/mac/tsch/tsch-packet.h"
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/tsch/tsch-adaptive-timesync.h"
+#if TSCH_WITH_SIXTOP
+#include "net/mac/tsch/sixtop/sixtop.h"
+#endif /* TSCH_WITH_SIXTOP */
 #if CONTIKI_TARGET_COOJA || CONTIKI_TARGET_COOJA_IP64
 #include "lib/simEnvChange.h"
 #include "sys/cooja_mt.h"
@@ -138,6 +141,15 @@ struct tsch_packet *dequeued_array[TSCH_DEQUEUED_ARRAY_SIZE];
 struct ringbufindex input_ringbuf;
 struct input_packet input_array[TSCH_MAX_INCOMING_PACKETS];
 
+#if TSCH_WITH_SLOT_TRACE
+/* A ringbuf storing slot traces. Read with tsch_slot_trace_get */
+static struct ringbufindex trace_ringbuf;
+static struct tsch_slot_trace trace_array[TSCH_SLOT_TRACE_LEN];
+/* The trace of the current slot, NULL if it is not traced */
+static struct tsch_slot_trace *current_trace;
+static uint32_t trace_dropped;
+#endif /* TSCH_WITH_SLOT_TRACE */
+
 /* Last time we received Sync-IE (ACK or data packet from a time source) */
 static struct tsch_asn_t last_sync_asn;
 
@@ -319,6 +331,90 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
     BUSYWAIT_UNTIL_ABS(0, ref_time, offset); \
   } while(0);
 /*---------------------------------------------------------------------------*/
+#if TSCH_WITH_SLOT_TRACE
+
+/* Deadlines of the slot phases: the time after which
+ * tsch_schedule_slot_operation reports a miss for the next operation */
+#if CCA_ENABLED
+#define SLOT_TRACE_TX_START (TS_CCA_OFFSET - 2 * RTIMER_GUARD)
+#else /* CCA_ENABLED */
+#define SLOT_TRACE_TX_START (tsch_timing[tsch_ts_tx_offset] - RADIO_DELAY_BEFORE_TX - 2 * RTIMER_GUARD)
+#endif /* CCA_ENABLED */
+#define SLOT_TRACE_RX_START (tsch_timing[tsch_ts_rx_offset] - RADIO_DELAY_BEFORE_RX - 2 * RTIMER_GUARD)
+#define SLOT_TRACE_SLOT_END (tsch_timing[tsch_ts_timeslot_length] - RTIMER_GUARD)
+
+/* Start tracing the current slot, if there is room in the ringbuf */
+static void
+slot_trace_start(uint8_t is_tx)
+{
+  int16_t trace_index = ringbufindex_peek_put(&trace_ringbuf);
+  if(trace_index == -1) {
+    current_trace = NULL;
+    trace_dropped++;
+  } else {
+    current_trace = &trace_array[trace_index];
+    current_trace->asn = tsch_current_asn;
+    current_trace->is_tx = is_tx;
+    current_trace->phases = 0;
+  }
+}
+/* Record the end of a phase, in ticks from ref_time. Only the first
+ * end of every phase is kept */
+static void
+slot_trace_phase(enum tsch_slot_phase phase, rtimer_clock_t ref_time, rtimer_clock_t deadline)
+{
+  if(current_trace != NULL && !(current_trace->phases & (1 << phase))) {
+    current_trace->end[phase] = RTIMER_NOW() - ref_time;
+    current_trace->deadline[phase] = deadline;
+    current_trace->phases |= 1 << phase;
+  }
+}
+/* Hand over the trace of the current slot */
+static void
+slot_trace_end(void)
+{
+  if(current_trace != NULL) {
+    ringbufindex_put(&trace_ringbuf);
+    current_trace = NULL;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_slot_trace_init(void)
+{
+  ringbufindex_init(&trace_ringbuf, TSCH_SLOT_TRACE_LEN);
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_slot_trace_get(struct tsch_slot_trace *trace)
+{
+  int16_t trace_index = ringbufindex_peek_get(&trace_ringbuf);
+  if(trace_index == -1) {
+    return 0;
+  }
+  *trace = trace_array[trace_index];
+  ringbufindex_get(&trace_ringbuf);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+tsch_slot_trace_dropped(void)
+{
+  return trace_dropped;
+}
+
+#define TSCH_SLOT_TRACE_START(is_tx) slot_trace_start(is_tx)
+#define TSCH_SLOT_TRACE_PHASE(phase, ref_time, deadline) slot_trace_phase(phase, ref_time, deadline)
+#define TSCH_SLOT_TRACE_END() slot_trace_end()
+
+#else /* TSCH_WITH_SLOT_TRACE */
+
+#define TSCH_SLOT_TRACE_START(is_tx)
+#define TSCH_SLOT_TRACE_PHASE(phase, ref_time, deadline)
+#define TSCH_SLOT_TRACE_END()
+
+#endif /* TSCH_WITH_SLOT_TRACE */
+/*---------------------------------------------------------------------------*/
 /* Get EB, broadcast or unicast packet to be sent, and target neighbor. */
 static struct tsch_packet *
 get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
@@ -366,7 +462,11 @@ update_neighbor_state(struct tsch_neighbor *n, struct tsch_packet *p,
 
   if(mac_tx_status == MAC_TX_OK) {
     /* Successful transmission */
+#if TSCH_QUEUE_WITH_CLASSES
+    tsch_queue_remove_packet(n, p);
+#else /* TSCH_QUEUE_WITH_CLASSES */
     tsch_queue_remove_packet_from_queue(n);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
     in_queue = 0;
 
     /* Update CSMA state in the unicast case */
@@ -381,7 +481,11 @@ update_neighbor_state(struct tsch_neighbor *n, struct tsch_packet *p,
     /* Failed transmission */
     if(p->transmissions >= TSCH_MAC_MAX_FRAME_RETRIES + 1) {
       /* Drop packet */
+#if TSCH_QUEUE_WITH_CLASSES
+      tsch_queue_remove_packet(n, p);
+#else /* TSCH_QUEUE_WITH_CLASSES */
       tsch_queue_remove_packet_from_queue(n);
+#endif /* TSCH_QUEUE_WITH_CLASSES */
       in_queue = 0;
     }
     /* Update CSMA state in the unicast case */
@@ -478,6 +582,10 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
   static uint8_t mac_tx_status;
   /* is the packet in its neighbor's queue? */
   uint8_t in_queue;
+#if TSCH_QUEUE_WITH_CLASSES
+  /* queueing delay, set at the first transmission */
+  uint16_t queue_delay = 0;
+#endif /* TSCH_QUEUE_WITH_CLASSES */
   static int dequeued_index;
   static int packet_ready = 1;
 
@@ -541,6 +649,8 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       if(packet_ready && NETSTACK_RADIO.prepare(packet, packet_len) == 0) { /* 0 means success */
         static rtimer_clock_t tx_duration;
 
+        TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_PREPARE, current_slot_start, SLOT_TRACE_TX_START);
+
 #if CCA_ENABLED
         cca_status = 1;
         /* delay before CCA */
@@ -679,9 +789,19 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
     }
 
     tsch_radio_off(TSCH_RADIO_CMD_OFF_END_OF_TIMESLOT);
+    TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_TXRX, current_slot_start, SLOT_TRACE_SLOT_END);
 
     current_packet->transmissions++;
     current_packet->ret = mac_tx_status;
+#if TSCH_QUEUE_WITH_CLASSES
+    if(current_packet->transmissions == 1) {
+      queue_delay = tsch_queue_first_tx(current_packet);
+    }
+#endif /* TSCH_QUEUE_WITH_CLASSES */
+#if TSCH_WITH_SIXTOP
+    /* Cell usage, for the 6top scheduling function */
+    sixtop_link_used(current_link);
+#endif /* TSCH_WITH_SIXTOP */
 
     /* Post TX: Update neighbor state */
     in_queue = update_neighbor_state(current_neighbor, current_packet, current_link, mac_tx_status);
@@ -706,12 +826,17 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
     log->tx.sec_level = 0;
 #endif /* LLSEC802154_ENABLED */
     log->tx.dest = TSCH_LOG_ID_FROM_LINKADDR(queuebuf_addr(current_packet->qb, PACKETBUF_ADDR_RECEIVER));
+#if TSCH_QUEUE_WITH_CLASSES
+    log->tx.tx_class = current_packet->tx_class;
+    log->tx.queue_delay = queue_delay;
+#endif /* TSCH_QUEUE_WITH_CLASSES */
     );
 
     /* Poll process for later processing of packet sent events and logs */
     process_poll(&tsch_pending_events_process);
   }
 
+  TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_POST, current_slot_start, SLOT_TRACE_SLOT_END);
   TSCH_DEBUG_TX_EVENT();
 
   PT_END(pt);
@@ -758,6 +883,8 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
     current_input = &input_array[input_index];
 
+    TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_PREPARE, current_slot_start, SLOT_TRACE_RX_START);
+
     /* Wait before starting to listen */
     TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_rx_offset] - RADIO_DELAY_BEFORE_RX, "RxBeforeListen");
     TSCH_DEBUG_RX_EVENT();
@@ -773,6 +900,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
     if(!packet_seen) {
       /* no packets on air */
       tsch_radio_off(TSCH_RADIO_CMD_OFF_FORCE);
+      TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_TXRX, current_slot_start, SLOT_TRACE_SLOT_END);
     } else {
       TSCH_DEBUG_RX_EVENT();
       /* Save packet timestamp */
@@ -880,6 +1008,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
                 tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
               }
             }
+            TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_TXRX, current_slot_start, SLOT_TRACE_SLOT_END);
 
             /* If the sender is a time source, proceed to clock drift compensation */
             n = tsch_queue_get_nbr(&source_address);
@@ -918,6 +1047,9 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
       tsch_radio_off(TSCH_RADIO_CMD_OFF_END_OF_TIMESLOT);
     }
 
+    /* Invalid frames end the Rx phase here */
+    TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_TXRX, current_slot_start, SLOT_TRACE_SLOT_END);
+
     if(input_queue_drop != 0) {
       TSCH_LOG_ADD(tsch_log_message,
           snprintf(log->message, sizeof(log->message),
@@ -927,6 +1059,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
     }
   }
 
+  TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_POST, current_slot_start, SLOT_TRACE_SLOT_END);
   TSCH_DEBUG_RX_EVENT();
 
   PT_END(pt);
@@ -969,6 +1102,9 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         current_link = backup_link;
         current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
       }
+      TSCH_SLOT_TRACE_START(current_packet != NULL);
+      TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_PACKET, current_slot_start,
+                            current_packet != NULL ? SLOT_TRACE_TX_START : SLOT_TRACE_RX_START);
       is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX);
       if(is_active_slot) {
         /* Hop channel */
@@ -1041,9 +1177,12 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         prev_slot_start = current_slot_start;
         current_slot_start += time_to_next_active_slot;
         current_slot_start += tsch_timesync_adaptive_compensate(time_to_next_active_slot);
+        TSCH_SLOT_TRACE_PHASE(TSCH_SLOT_PHASE_SCHEDULE, prev_slot_start,
+                              time_to_next_active_slot - RTIMER_GUARD);
       } while(!tsch_schedule_slot_operation(t, prev_slot_start, time_to_next_active_slot, "main"));
     }
 
+    TSCH_SLOT_TRACE_END();
     tsch_in_slot_operation = 0;
     PT_YIELD(&slot_operation_pt);
   }
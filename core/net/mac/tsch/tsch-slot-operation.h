@@ -74,6 +74,14 @@
 #define TSCH_MAX_INCOMING_PACKETS 4
 #endif
 
+/* Size of the ring buffer storing slot traces, if TSCH_WITH_SLOT_TRACE.
+ * Must be power of two */
+#ifdef TSCH_CONF_SLOT_TRACE_LEN
+#define TSCH_SLOT_TRACE_LEN TSCH_CONF_SLOT_TRACE_LEN
+#else
+#define TSCH_SLOT_TRACE_LEN 16
+#endif
+
 /*********** Callbacks *********/
 
 /* Called by TSCH form interrupt after receiving a frame, enabled upper-layer to decide
@@ -93,6 +101,26 @@ struct input_packet {
   uint8_t channel; /* Channel we received the packet on */
 };
 
+/* Phases of the slot operation, in order */
+enum tsch_slot_phase {
+  TSCH_SLOT_PHASE_PACKET,   /* Get the packet and neighbor for the link */
+  TSCH_SLOT_PHASE_PREPARE,  /* Copy the packet to the radio, or get ready to listen */
+  TSCH_SLOT_PHASE_TXRX,     /* Tx and wait for ACK, or Rx and send ACK */
+  TSCH_SLOT_PHASE_POST,     /* Update queues and neighbors, log */
+  TSCH_SLOT_PHASE_SCHEDULE, /* Get the next active link and schedule it */
+  TSCH_SLOT_NUM_PHASES
+};
+
+/* Timing of a slot. Times are in rtimer ticks from the start of the slot.
+ * The slack of a phase is its deadline minus its end, negative if missed */
+struct tsch_slot_trace {
+  struct tsch_asn_t asn; /* ASN of the slot */
+  uint8_t is_tx; /* Was there a packet to send? */
+  uint8_t phases; /* Bitmap of the phases recorded, by enum tsch_slot_phase */
+  rtimer_clock_t end[TSCH_SLOT_NUM_PHASES];
+  rtimer_clock_t deadline[TSCH_SLOT_NUM_PHASES];
+};
+
 /***** External Variables *****/
 
 /* A ringbuf storing outgoing packets after they were dequeued.
@@ -120,5 +148,13 @@ void tsch_slot_operation_sync(rtimer_clock_t next_slot_start,
     struct tsch_asn_t *next_slot_asn);
 /* Start actual slot operation */
 void tsch_slot_operation_start(void);
+#if TSCH_WITH_SLOT_TRACE
+/* Initialize the ring buffer storing slot traces */
+void tsch_slot_trace_init(void);
+/* Get the oldest slot trace. Returns 0 if there is none */
+int tsch_slot_trace_get(struct tsch_slot_trace *trace);
+/* Number of slots not traced because the ring buffer was full */
+uint32_t tsch_slot_trace_dropped(void);
+#endif /* TSCH_WITH_SLOT_TRACE */
 
 #endif /* __TSCH_SLOT_OPERATION_H__ */
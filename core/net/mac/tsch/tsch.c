@@ -56,6 +56,9 @@
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/mac-sequence.h"
 #include "lib/random.h"
+#if TSCH_WITH_SIXTOP
+#include "net/mac/tsch/sixtop/sixtop.h"
+#endif /* TSCH_WITH_SIXTOP */
 
 #if FRAME802154_VERSION < FRAME802154_IEEE802154E_2012
 #error TSCH: FRAME802154_VERSION must be at least FRAME802154_IEEE802154E_2012
@@ -851,6 +854,9 @@ tsch_init(void)
   tsch_log_init();
   ringbufindex_init(&input_ringbuf, TSCH_MAX_INCOMING_PACKETS);
   ringbufindex_init(&dequeued_ringbuf, TSCH_DEQUEUED_ARRAY_SIZE);
+#if TSCH_WITH_SLOT_TRACE
+  tsch_slot_trace_init();
+#endif /* TSCH_WITH_SLOT_TRACE */
 
   tsch_is_initialized = 1;
 
@@ -978,6 +984,12 @@ packet_input(void)
       PRINTF("TSCH: received from %u with seqno %u\n",
              TSCH_LOG_ID_FROM_LINKADDR(packetbuf_addr(PACKETBUF_ADDR_SENDER)),
              packetbuf_attr(PACKETBUF_ATTR_MAC_SEQNO));
+#if TSCH_WITH_SIXTOP
+      /* 6P messages are handled by 6top and not passed to upper layers */
+      if(packetbuf_attr(PACKETBUF_ATTR_MAC_IE_LIST_PRESENT) && sixtop_input()) {
+        return;
+      }
+#endif /* TSCH_WITH_SIXTOP */
       NETSTACK_LLSEC.input();
     }
   }
@@ -994,6 +1006,9 @@ turn_on(void)
     process_start(&tsch_send_eb_process, NULL);
     /* try to associate to a network or start one if setup as coordinator */
     process_start(&tsch_process, NULL);
+#if TSCH_WITH_SIXTOP
+    sixtop_init();
+#endif /* TSCH_WITH_SIXTOP */
     PRINTF("TSCH: starting as %s\n", tsch_is_coordinator ? "coordinator" : "node");
     return 1;
   }
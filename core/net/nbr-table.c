@@ -64,6 +64,9 @@ const linkaddr_t *NBR_TABLE_FIND_REMOVABLE(nbr_table_reason_t reason, void *data
 /* List of link-layer addresses of the neighbors, used as key in the tables */
 typedef struct nbr_table_key {
   struct nbr_table_key *next;
+#if NBR_TABLE_WITH_HASH_INDEX
+  struct nbr_table_key *hash_next;
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   linkaddr_t lladdr;
 } nbr_table_key_t;
 
@@ -83,6 +86,43 @@ static unsigned num_tables;
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+#if NBR_TABLE_WITH_HASH_INDEX
+/* The keys in nbr_table_keys, chained per bucket by hash_next */
+static nbr_table_key_t *hash_buckets[NBR_TABLE_HASH_SIZE];
+
+/*---------------------------------------------------------------------------*/
+static nbr_table_key_t **
+hash_bucket(const linkaddr_t *lladdr)
+{
+  int i;
+  unsigned hash = 0;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = hash * 31 + lladdr->u8[i];
+  }
+  return &hash_buckets[hash & (NBR_TABLE_HASH_SIZE - 1)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_add(nbr_table_key_t *key)
+{
+  nbr_table_key_t **bucket = hash_bucket(&key->lladdr);
+  key->hash_next = *bucket;
+  *bucket = key;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(nbr_table_key_t *key)
+{
+  nbr_table_key_t **k;
+  for(k = hash_bucket(&key->lladdr); *k != NULL; k = &(*k)->hash_next) {
+    if(*k == key) {
+      *k = key->hash_next;
+      return;
+    }
+  }
+}
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
+
 /*---------------------------------------------------------------------------*/
 /* Get a key from a neighbor index */
 static nbr_table_key_t *
@@ -136,6 +176,13 @@ index_from_lladdr(const linkaddr_t *lladdr)
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
+#if NBR_TABLE_WITH_HASH_INDEX
+  for(key = *hash_bucket(lladdr); key != NULL; key = key->hash_next) {
+    if(linkaddr_cmp(lladdr, &key->lladdr)) {
+      return index_from_key(key);
+    }
+  }
+#else /* NBR_TABLE_WITH_HASH_INDEX */
   key = list_head(nbr_table_keys);
   while(key != NULL) {
     if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
@@ -143,6 +190,7 @@ index_from_lladdr(const linkaddr_t *lladdr)
     }
     key = list_item_next(key);
   }
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   return -1;
 }
 /*---------------------------------------------------------------------------*/
@@ -195,6 +243,9 @@ remove_key(nbr_table_key_t *least_used_key)
   used_map[index_from_key(least_used_key)] = 0;
   /* Remove neighbor from list */
   list_remove(nbr_table_keys, least_used_key);
+#if NBR_TABLE_WITH_HASH_INDEX
+  hash_remove(least_used_key);
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
 }
 /*---------------------------------------------------------------------------*/
 static nbr_table_key_t *
@@ -207,6 +258,9 @@ nbr_table_allocate(nbr_table_reason_t reason, void *data)
   key = memb_alloc(&neighbor_addr_mem);
   if(key != NULL) {
     return key;
+  } else if(reason == NBR_TABLE_REASON_STATS) {
+    /* Not worth removing a neighbor for */
+    return NULL;
   } else {
 #ifdef NBR_TABLE_FIND_REMOVABLE
     const linkaddr_t *lladdr;
@@ -359,6 +413,9 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+#if NBR_TABLE_WITH_HASH_INDEX
+    hash_add(key);
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   }
 
   /* Get item in the current table */
@@ -450,7 +507,13 @@ nbr_table_update_lladdr(const linkaddr_t *old_addr, const linkaddr_t *new_addr,
    * Copy the new lladdr into the key - since we know that there is no
    * conflicting entry.
    */
+#if NBR_TABLE_WITH_HASH_INDEX
+  hash_remove(key);
+  memcpy(&key->lladdr, new_addr, sizeof(linkaddr_t));
+  hash_add(key);
+#else /* NBR_TABLE_WITH_HASH_INDEX */
   memcpy(&key->lladdr, new_addr, sizeof(linkaddr_t));
+#endif /* NBR_TABLE_WITH_HASH_INDEX */
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -46,6 +46,21 @@
 #define NBR_TABLE_MAX_NEIGHBORS 8
 #endif /* NBR_TABLE_CONF_MAX_NEIGHBORS */
 
+/* Look up neighbors through a hash index on the link-layer address
+ * instead of a linear scan. Useful for large tables. */
+#ifdef NBR_TABLE_CONF_WITH_HASH_INDEX
+#define NBR_TABLE_WITH_HASH_INDEX NBR_TABLE_CONF_WITH_HASH_INDEX
+#else /* NBR_TABLE_CONF_WITH_HASH_INDEX */
+#define NBR_TABLE_WITH_HASH_INDEX 0
+#endif /* NBR_TABLE_CONF_WITH_HASH_INDEX */
+
+/* Number of hash buckets, must be a power of two */
+#ifdef NBR_TABLE_CONF_HASH_SIZE
+#define NBR_TABLE_HASH_SIZE NBR_TABLE_CONF_HASH_SIZE
+#else /* NBR_TABLE_CONF_HASH_SIZE */
+#define NBR_TABLE_HASH_SIZE 32
+#endif /* NBR_TABLE_CONF_HASH_SIZE */
+
 /* An item in a neighbor table */
 typedef void nbr_table_item_t;
 
@@ -85,6 +100,8 @@ typedef enum {
 	NBR_TABLE_REASON_MAC,
 	NBR_TABLE_REASON_LLSEC,
 	NBR_TABLE_REASON_LINK_STATS,
+	/* Statistics only, which never evict another neighbor */
+	NBR_TABLE_REASON_STATS,
 } nbr_table_reason_t;
 
 /** \name Neighbor tables: register and loop through table elements */
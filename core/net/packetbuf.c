@@ -63,6 +63,17 @@ static uint8_t hdrlen;
 static uint32_t packetbuf_aligned[(PACKETBUF_SIZE + 3) / 4];
 static uint8_t *packetbuf = (uint8_t *)packetbuf_aligned;
 
+#if PACKETBUF_WITH_REFERENCE
+/* The data given to packetbuf_reference(), and the room in front of
+   it where packetbuf may start */
+static uint8_t *reference;
+static uint8_t *reference_start;
+
+/* Non-zero when packetbuf points to data given to
+   packetbuf_reference() */
+#define IS_REFERENCE() (packetbuf != (uint8_t *)packetbuf_aligned)
+#endif /* PACKETBUF_WITH_REFERENCE */
+
 #define DEBUG 0
 #if DEBUG
 #include <stdio.h>
@@ -71,12 +82,43 @@ static uint8_t *packetbuf = (uint8_t *)packetbuf_aligned;
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+#if PACKETBUF_WITH_REFERENCE
+/* Copy referenced data into the packetbuf, leaving room for a header
+   of the given size in front of it. */
+static void
+unreference(int size)
+{
+  memcpy((uint8_t *)packetbuf_aligned + size, packetbuf, packetbuf_totlen());
+  packetbuf = (uint8_t *)packetbuf_aligned;
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_reference(void *from, uint16_t len, uint8_t headroom)
+{
+  packetbuf_clear();
+  reference = from;
+  reference_start = reference - headroom;
+  packetbuf = reference;
+  buflen = MIN(PACKETBUF_SIZE, len);
+  return buflen;
+}
+/*---------------------------------------------------------------------------*/
+const void *
+packetbuf_referenced(void)
+{
+  return IS_REFERENCE() ? reference : NULL;
+}
+#endif /* PACKETBUF_WITH_REFERENCE */
 /*---------------------------------------------------------------------------*/
 void
 packetbuf_clear(void)
 {
   buflen = bufptr = 0;
   hdrlen = 0;
+#if PACKETBUF_WITH_REFERENCE
+  packetbuf = (uint8_t *)packetbuf_aligned;
+#endif /* PACKETBUF_WITH_REFERENCE */
 
   packetbuf_attr_clear();
 }
@@ -98,6 +140,12 @@ packetbuf_compact(void)
 {
   int16_t i;
 
+#if PACKETBUF_WITH_REFERENCE
+  if(IS_REFERENCE()) {
+    unreference(0);
+  }
+#endif /* PACKETBUF_WITH_REFERENCE */
+
   if(bufptr) {
     /* shift data to the left */
     for(i = 0; i < buflen; i++) {
@@ -113,8 +161,8 @@ packetbuf_copyto(void *to)
   if(hdrlen + buflen > PACKETBUF_SIZE) {
     return 0;
   }
-  memcpy(to, packetbuf_hdrptr(), hdrlen);
-  memcpy((uint8_t *)to + hdrlen, packetbuf_dataptr(), buflen);
+  memcpy(to, packetbuf, hdrlen);
+  memcpy((uint8_t *)to + hdrlen, packetbuf + packetbuf_hdrlen(), buflen);
   return hdrlen + buflen;
 }
 /*---------------------------------------------------------------------------*/
@@ -127,6 +175,20 @@ packetbuf_hdralloc(int size)
     return 0;
   }
 
+#if PACKETBUF_WITH_REFERENCE
+  if(IS_REFERENCE()) {
+    if(packetbuf - size >= reference_start) {
+      /* Write the header in front of the referenced data */
+      packetbuf -= size;
+    } else {
+      /* Copy the data in behind the new header in one go */
+      unreference(size);
+    }
+    hdrlen += size;
+    return 1;
+  }
+#endif /* PACKETBUF_WITH_REFERENCE */
+
   /* shift data to the right */
   for(i = packetbuf_totlen() - 1; i >= 0; i--) {
     packetbuf[i + size] = packetbuf[i];
@@ -157,12 +219,25 @@ packetbuf_set_datalen(uint16_t len)
 void *
 packetbuf_dataptr(void)
 {
+#if PACKETBUF_WITH_REFERENCE
+  /* The caller may write to the data */
+  if(IS_REFERENCE()) {
+    unreference(0);
+  }
+#endif /* PACKETBUF_WITH_REFERENCE */
   return packetbuf + packetbuf_hdrlen();
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_hdrptr(void)
 {
+#if PACKETBUF_WITH_REFERENCE
+  /* The caller may write to the header, which is the packetbuf's own
+     only if it was allocated in the headroom */
+  if(IS_REFERENCE() && hdrlen == 0) {
+    unreference(0);
+  }
+#endif /* PACKETBUF_WITH_REFERENCE */
   return packetbuf;
 }
 /*---------------------------------------------------------------------------*/
@@ -72,6 +72,33 @@
 #define PACKETBUF_WITH_PACKET_TYPE NETSTACK_CONF_WITH_RIME
 #endif
 
+/**
+ * \brief      Let the packetbuf reference data instead of copying it
+ *
+ *             With this option, queuebuf_to_packetbuf() points the
+ *             packetbuf at the queued frame with
+ *             packetbuf_reference() instead of copying it.
+ */
+#ifdef PACKETBUF_CONF_WITH_REFERENCE
+#define PACKETBUF_WITH_REFERENCE PACKETBUF_CONF_WITH_REFERENCE
+#else
+#define PACKETBUF_WITH_REFERENCE 0
+#endif
+
+/**
+ * \brief      Room for headers in front of referenced queuebuf data
+ *
+ *             Headers of up to this size in total, such as the
+ *             802.15.4 header added by the framer, are written in
+ *             front of a referenced frame instead of copying the frame.
+ *             Must be a multiple of 4.
+ */
+#ifdef PACKETBUF_CONF_REFERENCE_HEADROOM
+#define PACKETBUF_REFERENCE_HEADROOM PACKETBUF_CONF_REFERENCE_HEADROOM
+#else
+#define PACKETBUF_REFERENCE_HEADROOM 24
+#endif
+
 /**
  * \brief      Clear and reset the packetbuf
  *
@@ -165,6 +192,42 @@ void packetbuf_compact(void);
  */
 int packetbuf_copyfrom(const void *from, uint16_t len);
 
+#if PACKETBUF_WITH_REFERENCE
+/**
+ * \brief      Make the packetbuf use external data in place
+ * \param from A pointer to the data, which must stay unchanged for as
+ *             long as it is referenced
+ * \param len  The size of the data
+ * \param headroom The number of bytes in front of the data that the
+ *             packetbuf may use for headers
+ * \retval     The number of bytes that the packetbuf references
+ *
+ *             This function works like packetbuf_copyfrom(), except
+ *             that the data is not copied. Headers allocated with
+ *             packetbuf_hdralloc() are placed in the headroom, and
+ *             may be written through packetbuf_hdrptr(). The data is
+ *             copied into the packetbuf only when it may be modified:
+ *             by packetbuf_compact(), when a pointer to it is taken
+ *             with packetbuf_dataptr(), when the headers do not fit in
+ *             the headroom, or when packetbuf_hdrptr() is called
+ *             before any header is allocated. Until then, the packetbuf
+ *             can be inspected through its length and attribute
+ *             functions and copied out with packetbuf_copyto() at no
+ *             cost.
+ *
+ *             Writes through packetbuf_hdrptr() must stay within the
+ *             header.
+ */
+int packetbuf_reference(void *from, uint16_t len, uint8_t headroom);
+
+/**
+ * \brief      Get the external data that the packetbuf references
+ * \retval     The pointer given to packetbuf_reference(), or NULL if
+ *             the packetbuf holds its own copy of the data
+ */
+const void *packetbuf_referenced(void);
+#endif /* PACKETBUF_WITH_REFERENCE */
+
 /**
  * \brief      Copy the entire packetbuf to an external buffer
  * \param to   A pointer to the buffer to which the data is to be copied
@@ -248,6 +311,9 @@ enum {
   PACKETBUF_ATTR_TSCH_SLOTFRAME,
   PACKETBUF_ATTR_TSCH_TIMESLOT,
 #endif /* TSCH_WITH_LINK_SELECTOR */
+#if TSCH_WITH_SIXTOP
+  PACKETBUF_ATTR_MAC_IE_LIST_PRESENT,
+#endif /* TSCH_WITH_SIXTOP */
 
   /* Scope 1 attributes: used between two neighbors only. */
 #if PACKETBUF_WITH_PACKET_TYPE
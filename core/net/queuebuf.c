@@ -72,12 +72,34 @@ struct queuebuf {
 
 /* The actual queuebuf data */
 struct queuebuf_data {
+#if PACKETBUF_WITH_REFERENCE
+  /* The packetbuf may reference the data and add headers in front of
+     it, so keep room for them and align the data like the packetbuf's
+     own memory */
+  union {
+    uint8_t u8[PACKETBUF_REFERENCE_HEADROOM + PACKETBUF_SIZE];
+    uint32_t u32[(PACKETBUF_REFERENCE_HEADROOM + PACKETBUF_SIZE + 3) / 4];
+  } mem;
+  /* The queuebuf owning the data, plus the packetbuf if it references
+     the data */
+  uint8_t refs;
+#else /* PACKETBUF_WITH_REFERENCE */
   uint8_t data[PACKETBUF_SIZE];
+#endif /* PACKETBUF_WITH_REFERENCE */
   uint16_t len;
   struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
   struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
 };
 
+#if PACKETBUF_WITH_REFERENCE
+#if PACKETBUF_REFERENCE_HEADROOM % 4
+#error "PACKETBUF_REFERENCE_HEADROOM must be a multiple of 4"
+#endif
+#define DATA(d) (&(d)->mem.u8[PACKETBUF_REFERENCE_HEADROOM])
+#else /* PACKETBUF_WITH_REFERENCE */
+#define DATA(d) ((d)->data)
+#endif /* PACKETBUF_WITH_REFERENCE */
+
 MEMB(bufmem, struct queuebuf, QUEUEBUF_NUM);
 MEMB(buframmem, struct queuebuf_data, QUEUEBUFRAM_NUM);
 
@@ -134,6 +156,32 @@ LIST(queuebuf_list);
 uint8_t queuebuf_len, queuebuf_max_len;
 #endif /* QUEUEBUF_STATS */
 
+#if PACKETBUF_WITH_REFERENCE
+/* The queuebuf data last handed to the packetbuf by reference */
+static struct queuebuf_data *lent_data;
+
+/*---------------------------------------------------------------------------*/
+static void
+free_data(struct queuebuf_data *data)
+{
+  if(--data->refs == 0) {
+    memb_free(&buframmem, data);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Drop the packetbuf's reference to lent_data if the packetbuf has
+   moved on to other data, or unconditionally if it is about to. */
+static void
+release_lent_data(int force)
+{
+  if(lent_data != NULL &&
+     (force || packetbuf_referenced() != DATA(lent_data))) {
+    free_data(lent_data);
+    lent_data = NULL;
+  }
+}
+#endif /* PACKETBUF_WITH_REFERENCE */
+
 #if WITH_SWAP
 /*---------------------------------------------------------------------------*/
 static void
@@ -288,6 +336,9 @@ queuebuf_init(void)
 #endif
   memb_init(&buframmem);
   memb_init(&bufmem);
+#if PACKETBUF_WITH_REFERENCE
+  lent_data = NULL;
+#endif /* PACKETBUF_WITH_REFERENCE */
 #if QUEUEBUF_STATS
   queuebuf_max_len = 0;
 #endif /* QUEUEBUF_STATS */
@@ -310,6 +361,10 @@ queuebuf_new_from_packetbuf(void)
   struct queuebuf *buf;
 
   struct queuebuf_data *buframptr;
+#if PACKETBUF_WITH_REFERENCE
+  /* Reclaim data that is freed but was still referenced */
+  release_lent_data(0);
+#endif /* PACKETBUF_WITH_REFERENCE */
   buf = memb_alloc(&bufmem);
   if(buf != NULL) {
 #if QUEUEBUF_DEBUG
@@ -339,7 +394,10 @@ queuebuf_new_from_packetbuf(void)
     buframptr = buf->ram_ptr;
 #endif
 
-    buframptr->len = packetbuf_copyto(buframptr->data);
+#if PACKETBUF_WITH_REFERENCE
+    buframptr->refs = 1;
+#endif /* PACKETBUF_WITH_REFERENCE */
+    buframptr->len = packetbuf_copyto(DATA(buframptr));
     packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
 
 #if WITH_SWAP
@@ -382,8 +440,14 @@ void
 queuebuf_update_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
+#if PACKETBUF_WITH_REFERENCE
+  if(packetbuf_referenced() == DATA(buframptr)) {
+    /* Let the packetbuf take its own copy before it is overwritten */
+    packetbuf_compact();
+  }
+#endif /* PACKETBUF_WITH_REFERENCE */
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
-  buframptr->len = packetbuf_copyto(buframptr->data);
+  buframptr->len = packetbuf_copyto(DATA(buframptr));
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
@@ -395,12 +459,23 @@ void
 queuebuf_free(struct queuebuf *buf)
 {
   if(memb_inmemb(&bufmem, buf)) {
+#if PACKETBUF_WITH_REFERENCE
+    release_lent_data(0);
+#endif /* PACKETBUF_WITH_REFERENCE */
 #if WITH_SWAP
     if(buf->location == IN_RAM) {
+#if PACKETBUF_WITH_REFERENCE
+      /* Kept until the packetbuf stops referencing it */
+      free_data(buf->ram_ptr);
+#else /* PACKETBUF_WITH_REFERENCE */
       memb_free(&buframmem, buf->ram_ptr);
+#endif /* PACKETBUF_WITH_REFERENCE */
     } else {
       queuebuf_remove_from_file(buf->swap_id);
     }
+#elif PACKETBUF_WITH_REFERENCE
+    /* Kept until the packetbuf stops referencing it */
+    free_data(buf->ram_ptr);
 #else
     memb_free(&buframmem, buf->ram_ptr);
 #endif
@@ -420,7 +495,24 @@ queuebuf_to_packetbuf(struct queuebuf *b)
 {
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
-    packetbuf_copyfrom(buframptr->data, buframptr->len);
+#if PACKETBUF_WITH_REFERENCE
+    /* The packetbuf contents are replaced below */
+    release_lent_data(1);
+#if WITH_SWAP
+    if(b->location != IN_RAM) {
+      /* tmpdata is reused for other buffers, copy it */
+      packetbuf_copyfrom(DATA(buframptr), buframptr->len);
+    } else
+#endif /* WITH_SWAP */
+    {
+      packetbuf_reference(DATA(buframptr), buframptr->len,
+                          PACKETBUF_REFERENCE_HEADROOM);
+      buframptr->refs++;
+      lent_data = buframptr;
+    }
+#else /* PACKETBUF_WITH_REFERENCE */
+    packetbuf_copyfrom(DATA(buframptr), buframptr->len);
+#endif /* PACKETBUF_WITH_REFERENCE */
     packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
   }
 }
@@ -430,7 +522,7 @@ queuebuf_dataptr(struct queuebuf *b)
 {
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
-    return buframptr->data;
+    return DATA(buframptr);
   }
   return NULL;
 }
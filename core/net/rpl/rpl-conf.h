@@ -338,4 +338,70 @@
 #define RPL_DIS_START_DELAY             5
 #endif
 
+/*
+ * Keep the candidate parents of each DAG in a heap ordered on the path
+ * cost via each parent, so that parent selection does not go through the
+ * whole parent table. The heap is updated when the rank or link metric
+ * of a parent changes.
+ */
+#ifdef RPL_CONF_WITH_PARENT_HEAP
+#define RPL_WITH_PARENT_HEAP RPL_CONF_WITH_PARENT_HEAP
+#else
+#define RPL_WITH_PARENT_HEAP 0
+#endif
+
+/*
+ * Size of the queue of DAOs waiting to be processed at the root. When
+ * non-zero, the root does not process DAOs as they arrive but queues
+ * them, merging repeated DAOs from a sender for the same target, and
+ * processes RPL_DAO_QUEUE_BATCH of them every RPL_DAO_QUEUE_INTERVAL.
+ * This also limits the rate of DAO-ACKs. DAOs that do not fit are
+ * dropped, and are retransmitted by their sender if it asked for a
+ * DAO-ACK. A DAO that only replaces queued ones always fits.
+ */
+#ifdef RPL_CONF_DAO_QUEUE_SIZE
+#define RPL_DAO_QUEUE_SIZE RPL_CONF_DAO_QUEUE_SIZE
+#else
+#define RPL_DAO_QUEUE_SIZE 0
+#endif
+
+#ifdef RPL_CONF_DAO_QUEUE_BATCH
+#define RPL_DAO_QUEUE_BATCH RPL_CONF_DAO_QUEUE_BATCH
+#else
+#define RPL_DAO_QUEUE_BATCH 4
+#endif
+
+#ifdef RPL_CONF_DAO_QUEUE_INTERVAL
+#define RPL_DAO_QUEUE_INTERVAL RPL_CONF_DAO_QUEUE_INTERVAL
+#else
+#define RPL_DAO_QUEUE_INTERVAL (CLOCK_SECOND / 8)
+#endif
+
+/*
+ * DAO packing in storing mode. When enabled, a router does not forward
+ * the DAOs of its children one by one, but waits RPL_DAO_PACKING_DELAY
+ * and sends their targets to its parent in one DAO, with a shared
+ * Transit Information option for targets with the same lifetime. DAOs
+ * with several targets are understood whether it is enabled or not, so
+ * nodes with and without it can be mixed. RPL_DAO_PACKING_MAX_TARGETS is
+ * the most targets a router sends in one DAO, with or without packing.
+ */
+#ifdef RPL_CONF_DAO_PACKING
+#define RPL_DAO_PACKING RPL_CONF_DAO_PACKING
+#else
+#define RPL_DAO_PACKING 0
+#endif
+
+#ifdef RPL_CONF_DAO_PACKING_MAX_TARGETS
+#define RPL_DAO_PACKING_MAX_TARGETS RPL_CONF_DAO_PACKING_MAX_TARGETS
+#else
+#define RPL_DAO_PACKING_MAX_TARGETS 8
+#endif
+
+#ifdef RPL_CONF_DAO_PACKING_DELAY
+#define RPL_DAO_PACKING_DELAY RPL_CONF_DAO_PACKING_DELAY
+#else
+#define RPL_DAO_PACKING_DELAY (CLOCK_SECOND / 4)
+#endif
+
 #endif /* RPL_CONF_H */
@@ -66,6 +66,12 @@
 void RPL_CALLBACK_PARENT_SWITCH(rpl_parent_t *old, rpl_parent_t *new);
 #endif /* RPL_CALLBACK_PARENT_SWITCH */
 
+/* A configurable function called after every change of the rank of the
+   DAG the node has joined */
+#ifdef RPL_CALLBACK_NEW_RANK
+void RPL_CALLBACK_NEW_RANK(rpl_rank_t old_rank, rpl_rank_t new_rank);
+#endif /* RPL_CALLBACK_NEW_RANK */
+
 /*---------------------------------------------------------------------------*/
 extern rpl_of_t rpl_of0, rpl_mrhof;
 static rpl_of_t * const objective_functions[] = RPL_SUPPORTED_OFS;
@@ -227,6 +233,113 @@ rpl_parent_is_reachable(rpl_parent_t *p) {
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_PARENT_HEAP
+/* The path cost via a parent, which is what the OF compares parents
+   on, or INFINITE_RANK if it is not a candidate */
+static rpl_rank_t
+heap_key(rpl_parent_t *p)
+{
+  rpl_dag_t *dag = p->dag;
+
+  if(dag == NULL || dag->instance == NULL || dag->instance->of == NULL ||
+     p->rank == INFINITE_RANK || p->rank < ROOT_RANK(dag->instance) ||
+     dag->instance->of->best_parent(NULL, p) == NULL) {
+    return INFINITE_RANK;
+  }
+  /* Keep a candidate with the highest cost in the heap */
+  return MIN(dag->instance->of->parent_path_cost(p), INFINITE_RANK - 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_set(rpl_dag_t *dag, int i, rpl_parent_t *p)
+{
+  dag->parent_heap[i] = p;
+  p->heap_index = i + 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_up(rpl_dag_t *dag, int i)
+{
+  rpl_parent_t *p = dag->parent_heap[i];
+
+  while(i > 0 && dag->parent_heap[(i - 1) / 2]->heap_key > p->heap_key) {
+    heap_set(dag, i, dag->parent_heap[(i - 1) / 2]);
+    i = (i - 1) / 2;
+  }
+  heap_set(dag, i, p);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_down(rpl_dag_t *dag, int i)
+{
+  rpl_parent_t *p = dag->parent_heap[i];
+  int child;
+
+  while((child = 2 * i + 1) < dag->parent_heap_len) {
+    if(child + 1 < dag->parent_heap_len &&
+       dag->parent_heap[child + 1]->heap_key < dag->parent_heap[child]->heap_key) {
+      child++;
+    }
+    if(dag->parent_heap[child]->heap_key >= p->heap_key) {
+      break;
+    }
+    heap_set(dag, i, dag->parent_heap[child]);
+    i = child;
+  }
+  heap_set(dag, i, p);
+}
+/*---------------------------------------------------------------------------*/
+static void
+heap_remove(rpl_parent_t *p)
+{
+  rpl_dag_t *dag = p->dag;
+  rpl_parent_t *last;
+  int i;
+
+  if(p->heap_index == 0 || dag == NULL) {
+    return;
+  }
+  i = p->heap_index - 1;
+  p->heap_index = 0;
+  if(i < --dag->parent_heap_len) {
+    /* Fill the gap with the last parent of the heap */
+    last = dag->parent_heap[dag->parent_heap_len];
+    heap_set(dag, i, last);
+    heap_up(dag, i);
+    heap_down(dag, last->heap_index - 1);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_parent_heap_update(rpl_parent_t *p)
+{
+  rpl_dag_t *dag = p->dag;
+  rpl_rank_t key = heap_key(p);
+  rpl_rank_t old_key;
+  int i;
+
+  if(key == INFINITE_RANK) {
+    heap_remove(p);
+    return;
+  }
+
+  old_key = p->heap_key;
+  p->heap_key = key;
+  if(p->heap_index == 0) {
+    if(dag->parent_heap_len >= NBR_TABLE_MAX_NEIGHBORS) {
+      return;
+    }
+    i = dag->parent_heap_len++;
+    heap_set(dag, i, p);
+    heap_up(dag, i);
+  } else if(key < old_key) {
+    heap_up(dag, p->heap_index - 1);
+  } else if(key > old_key) {
+    heap_down(dag, p->heap_index - 1);
+  }
+}
+#endif /* RPL_WITH_PARENT_HEAP */
+/*---------------------------------------------------------------------------*/
 static void
 rpl_set_preferred_parent(rpl_dag_t *dag, rpl_parent_t *p)
 {
@@ -350,6 +463,21 @@ get_dag(uint8_t instance_id, uip_ipaddr_t *dag_id)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+static void
+set_rank(rpl_dag_t *dag, rpl_rank_t rank)
+{
+#ifdef RPL_CALLBACK_NEW_RANK
+  rpl_rank_t old_rank = dag->rank;
+#endif /* RPL_CALLBACK_NEW_RANK */
+
+  dag->rank = rank;
+#ifdef RPL_CALLBACK_NEW_RANK
+  if(rank != old_rank && dag->joined && dag == dag->instance->current_dag) {
+    RPL_CALLBACK_NEW_RANK(old_rank, rank);
+  }
+#endif /* RPL_CALLBACK_NEW_RANK */
+}
+/*---------------------------------------------------------------------------*/
 rpl_dag_t *
 rpl_set_root(uint8_t instance_id, uip_ipaddr_t *dag_id)
 {
@@ -414,8 +542,6 @@ rpl_set_root(uint8_t instance_id, uip_ipaddr_t *dag_id)
   instance->default_lifetime = RPL_DEFAULT_LIFETIME;
   instance->lifetime_unit = RPL_DEFAULT_LIFETIME_UNIT;
 
-  dag->rank = ROOT_RANK(instance);
-
   if(instance->current_dag != dag && instance->current_dag != NULL) {
     /* Remove routes installed by DAOs. */
     if(RPL_IS_STORING(instance)) {
@@ -426,6 +552,7 @@ rpl_set_root(uint8_t instance_id, uip_ipaddr_t *dag_id)
   }
 
   instance->current_dag = dag;
+  set_rank(dag, ROOT_RANK(instance));
   instance->dtsn_out = RPL_LOLLIPOP_INIT;
   instance->of->update_metric_container(instance);
   default_instance = instance;
@@ -688,6 +815,14 @@ rpl_add_parent(rpl_dag_t *dag, rpl_dio_t *dio, uip_ipaddr_t *addr)
   PRINT6ADDR(addr);
   PRINTF("\n");
   if(lladdr != NULL) {
+#if RPL_WITH_PARENT_HEAP
+    /* The entry is cleared when added again, so take it out of the heap
+       it is in first */
+    p = nbr_table_get_from_lladdr(rpl_parents, (linkaddr_t *)lladdr);
+    if(p != NULL) {
+      heap_remove(p);
+    }
+#endif /* RPL_WITH_PARENT_HEAP */
     /* Add parent in rpl_parents - again this is due to DIO */
     p = nbr_table_add_lladdr(rpl_parents, (linkaddr_t *)lladdr,
                              NBR_TABLE_REASON_RPL_DIO, dio);
@@ -700,6 +835,9 @@ rpl_add_parent(rpl_dag_t *dag, rpl_dio_t *dio, uip_ipaddr_t *addr)
 #if RPL_WITH_MC
       memcpy(&p->mc, &dio->mc, sizeof(p->mc));
 #endif /* RPL_WITH_MC */
+#if RPL_WITH_PARENT_HEAP
+      rpl_parent_heap_update(p);
+#endif /* RPL_WITH_PARENT_HEAP */
     }
   }
 
@@ -805,7 +943,7 @@ rpl_select_dag(rpl_instance_t *instance, rpl_parent_t *p)
 
   instance->of->update_metric_container(instance);
   /* Update the DAG rank. */
-  best_dag->rank = rpl_rank_via_parent(best_dag->preferred_parent);
+  set_rank(best_dag, rpl_rank_via_parent(best_dag->preferred_parent));
   if(last_parent == NULL || best_dag->rank < best_dag->min_rank) {
     /* This is a slight departure from RFC6550: if we had no preferred parent before,
      * reset min_rank. This helps recovering from temporary bad link conditions. */
@@ -849,6 +987,99 @@ rpl_select_dag(rpl_instance_t *instance, rpl_parent_t *p)
   return best_dag;
 }
 /*---------------------------------------------------------------------------*/
+static int
+is_candidate(rpl_dag_t *dag, rpl_parent_t *p, int fresh_only)
+{
+  /* Exclude parents from other DAGs or announcing an infinite rank */
+  if(p->dag != dag || p->rank == INFINITE_RANK || p->rank < ROOT_RANK(dag->instance)) {
+    if(p->rank < ROOT_RANK(dag->instance)) {
+      PRINTF("RPL: Parent has invalid rank\n");
+    }
+    return 0;
+  }
+
+  if(fresh_only && !rpl_parent_is_fresh(p)) {
+    /* Filter out non-fresh parents if fresh_only is set */
+    return 0;
+  }
+
+#if UIP_ND6_SEND_NS
+  {
+  uip_ds6_nbr_t *nbr = rpl_get_nbr(p);
+  /* Exclude links to a neighbor that is not reachable at a NUD level */
+  if(nbr == NULL || nbr->state != NBR_REACHABLE) {
+    return 0;
+  }
+  }
+#endif /* UIP_ND6_SEND_NS */
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#if RPL_WITH_PARENT_HEAP
+/* Fold the OF over the parents from position i of the heap down that
+   cost as much as the first one. They are all above any other parent. */
+static rpl_parent_t *
+heap_best_tied(rpl_dag_t *dag, int i, rpl_parent_t *best, int fresh_only)
+{
+  rpl_parent_t *p;
+
+  if(i >= dag->parent_heap_len ||
+     dag->parent_heap[i]->heap_key != dag->parent_heap[0]->heap_key) {
+    return best;
+  }
+  p = dag->parent_heap[i];
+  if(is_candidate(dag, p, fresh_only)) {
+    best = dag->instance->of->best_parent(best, p);
+  }
+  best = heap_best_tied(dag, 2 * i + 1, best, fresh_only);
+  return heap_best_tied(dag, 2 * i + 2, best, fresh_only);
+}
+/*---------------------------------------------------------------------------*/
+/* The best parent from the heap, or NULL if the heap cannot tell */
+static rpl_parent_t *
+heap_best_parent(rpl_dag_t *dag, int fresh_only)
+{
+  rpl_parent_t *top;
+  rpl_parent_t *best;
+
+  /* Parents are placed in the heap when their rank or link metric
+     changes. Make sure that the first one still is where it belongs. */
+  while(dag->parent_heap_len > 0 &&
+        heap_key(dag->parent_heap[0]) != dag->parent_heap[0]->heap_key) {
+    rpl_parent_heap_update(dag->parent_heap[0]);
+  }
+  if(dag->parent_heap_len == 0) {
+    return NULL;
+  }
+
+  top = dag->parent_heap[0];
+  if(!is_candidate(dag, top, fresh_only)) {
+    /* Freshness and reachability are not reflected in the heap */
+    return NULL;
+  }
+
+  /* Let the OF break ties between the first parents of the heap */
+  top = heap_best_tied(dag, 0, NULL, fresh_only);
+  if(top == NULL) {
+    return NULL;
+  }
+
+  /* Let the OF decide whether it is worth leaving the preferred
+     parent for the first one in the heap */
+  best = top;
+  if(dag->preferred_parent != NULL && dag->preferred_parent != top &&
+     dag->preferred_parent->heap_index != 0 &&
+     is_candidate(dag, dag->preferred_parent, fresh_only)) {
+    best = dag->instance->of->best_parent(dag->preferred_parent, top);
+    if(best == dag->preferred_parent) {
+      RPL_STAT(rpl_stats.parent_switch_held++);
+    }
+  }
+  return best;
+}
+#endif /* RPL_WITH_PARENT_HEAP */
+/*---------------------------------------------------------------------------*/
 static rpl_parent_t *
 best_parent(rpl_dag_t *dag, int fresh_only)
 {
@@ -860,32 +1091,19 @@ best_parent(rpl_dag_t *dag, int fresh_only)
     return NULL;
   }
 
+#if RPL_WITH_PARENT_HEAP
+  best = heap_best_parent(dag, fresh_only);
+  if(best != NULL || dag->parent_heap_len == 0) {
+    return best;
+  }
+#endif /* RPL_WITH_PARENT_HEAP */
+
   of = dag->instance->of;
   /* Search for the best parent according to the OF */
   for(p = nbr_table_head(rpl_parents); p != NULL; p = nbr_table_next(rpl_parents, p)) {
-
-    /* Exclude parents from other DAGs or announcing an infinite rank */
-    if(p->dag != dag || p->rank == INFINITE_RANK || p->rank < ROOT_RANK(dag->instance)) {
-      if(p->rank < ROOT_RANK(dag->instance)) {
-        PRINTF("RPL: Parent has invalid rank\n");
-      }
-      continue;
-    }
-
-    if(fresh_only && !rpl_parent_is_fresh(p)) {
-      /* Filter out non-fresh parents if fresh_only is set */
-      continue;
-    }
-
-#if UIP_ND6_SEND_NS
-    {
-    uip_ds6_nbr_t *nbr = rpl_get_nbr(p);
-    /* Exclude links to a neighbor that is not reachable at a NUD level */
-    if(nbr == NULL || nbr->state != NBR_REACHABLE) {
+    if(!is_candidate(dag, p, fresh_only)) {
       continue;
     }
-    }
-#endif /* UIP_ND6_SEND_NS */
 
     /* Now we have an acceptable parent, check if it is the new best */
     best = of->best_parent(best, p);
@@ -920,13 +1138,13 @@ rpl_select_parent(rpl_dag_t *dag)
     }
 #else /* RPL_WITH_PROBING */
     rpl_set_preferred_parent(dag, best);
-    dag->rank = rpl_rank_via_parent(dag->preferred_parent);
+    set_rank(dag, rpl_rank_via_parent(dag->preferred_parent));
 #endif /* RPL_WITH_PROBING */
   } else {
     rpl_set_preferred_parent(dag, NULL);
   }
 
-  dag->rank = rpl_rank_via_parent(dag->preferred_parent);
+  set_rank(dag, rpl_rank_via_parent(dag->preferred_parent));
   return dag->preferred_parent;
 }
 /*---------------------------------------------------------------------------*/
@@ -939,6 +1157,9 @@ rpl_remove_parent(rpl_parent_t *parent)
 
   rpl_nullify_parent(parent);
 
+#if RPL_WITH_PARENT_HEAP
+  heap_remove(parent);
+#endif /* RPL_WITH_PARENT_HEAP */
   nbr_table_remove(rpl_parents, parent);
 }
 /*---------------------------------------------------------------------------*/
@@ -949,7 +1170,7 @@ rpl_nullify_parent(rpl_parent_t *parent)
   /* This function can be called when the preferred parent is NULL, so we
      need to handle this condition in order to trigger uip_ds6_defrt_rm. */
   if(parent == dag->preferred_parent || dag->preferred_parent == NULL) {
-    dag->rank = INFINITE_RANK;
+    set_rank(dag, INFINITE_RANK);
     if(dag->joined) {
       if(dag->instance->def_route != NULL) {
         PRINTF("RPL: Removing default route ");
@@ -978,7 +1199,7 @@ rpl_move_parent(rpl_dag_t *dag_src, rpl_dag_t *dag_dst, rpl_parent_t *parent)
 {
   if(parent == dag_src->preferred_parent) {
       rpl_set_preferred_parent(dag_src, NULL);
-      dag_src->rank = INFINITE_RANK;
+      set_rank(dag_src, INFINITE_RANK);
     if(dag_src->joined && dag_src->instance->def_route != NULL) {
       PRINTF("RPL: Removing default route ");
       PRINT6ADDR(rpl_get_parent_ipaddr(parent));
@@ -998,7 +1219,13 @@ rpl_move_parent(rpl_dag_t *dag_src, rpl_dag_t *dag_dst, rpl_parent_t *parent)
   PRINT6ADDR(rpl_get_parent_ipaddr(parent));
   PRINTF("\n");
 
+#if RPL_WITH_PARENT_HEAP
+  heap_remove(parent);
+  parent->dag = dag_dst;
+  rpl_parent_heap_update(parent);
+#else /* RPL_WITH_PARENT_HEAP */
   parent->dag = dag_dst;
+#endif /* RPL_WITH_PARENT_HEAP */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -1154,7 +1381,7 @@ rpl_join_instance(uip_ipaddr_t *from, rpl_dio_t *dio)
 
   rpl_set_preferred_parent(dag, p);
   instance->of->update_metric_container(instance);
-  dag->rank = rpl_rank_via_parent(p);
+  set_rank(dag, rpl_rank_via_parent(p));
   /* So far this is the lowest rank we are aware of. */
   dag->min_rank = dag->rank;
 
@@ -1218,6 +1445,9 @@ rpl_add_dag(uip_ipaddr_t *from, rpl_dio_t *dio)
     }
   }
   p->rank = dio->rank;
+#if RPL_WITH_PARENT_HEAP
+  rpl_parent_heap_update(p);
+#endif /* RPL_WITH_PARENT_HEAP */
 
   /* Determine the objective function by using the
      objective code point of the DIO. */
@@ -1249,7 +1479,7 @@ rpl_add_dag(uip_ipaddr_t *from, rpl_dio_t *dio)
   memcpy(&dag->prefix_info, &dio->prefix_info, sizeof(rpl_prefix_t));
 
   rpl_set_preferred_parent(dag, p);
-  dag->rank = rpl_rank_via_parent(p);
+  set_rank(dag, rpl_rank_via_parent(p));
   dag->min_rank = dag->rank; /* So far this is the lowest rank we know of. */
 
   PRINTF("RPL: Joined DAG with instance ID %u, rank %hu, DAG ID ",
@@ -1289,9 +1519,9 @@ global_repair(uip_ipaddr_t *from, rpl_dag_t *dag, rpl_dio_t *dio)
   p = rpl_add_parent(dag, dio, from);
   if(p == NULL) {
     PRINTF("RPL: Failed to add a parent during the global repair\n");
-    dag->rank = INFINITE_RANK;
+    set_rank(dag, INFINITE_RANK);
   } else {
-    dag->rank = rpl_rank_via_parent(p);
+    set_rank(dag, rpl_rank_via_parent(p));
     dag->min_rank = dag->rank;
     PRINTF("RPL: rpl_process_parent_event global repair\n");
     rpl_process_parent_event(dag->instance, p);
@@ -1316,7 +1546,7 @@ rpl_local_repair(rpl_instance_t *instance)
   PRINTF("RPL: Starting a local instance repair\n");
   for(i = 0; i < RPL_MAX_DAG_PER_INSTANCE; i++) {
     if(instance->dag_table[i].used) {
-      instance->dag_table[i].rank = INFINITE_RANK;
+      set_rank(&instance->dag_table[i], INFINITE_RANK);
       nullify_parents(&instance->dag_table[i], 0);
     }
   }
@@ -1349,6 +1579,9 @@ rpl_recalculate_ranks(void)
   while(p != NULL) {
     if(p->dag != NULL && p->dag->instance && (p->flags & RPL_PARENT_FLAG_UPDATED)) {
       p->flags &= ~RPL_PARENT_FLAG_UPDATED;
+#if RPL_WITH_PARENT_HEAP
+      rpl_parent_heap_update(p);
+#endif /* RPL_WITH_PARENT_HEAP */
       PRINTF("RPL: rpl_process_parent_event recalculate_ranks\n");
       if(!rpl_process_parent_event(p->dag->instance, p)) {
         PRINTF("RPL: A parent was dropped\n");
@@ -1608,6 +1841,9 @@ rpl_process_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 #if RPL_WITH_MC
   memcpy(&p->mc, &dio->mc, sizeof(p->mc));
 #endif /* RPL_WITH_MC */
+#if RPL_WITH_PARENT_HEAP
+  rpl_parent_heap_update(p);
+#endif /* RPL_WITH_PARENT_HEAP */
   if(rpl_process_parent_event(instance, p) == 0) {
     PRINTF("RPL: The candidate parent is rejected\n");
     return;
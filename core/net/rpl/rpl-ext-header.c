@@ -50,6 +50,8 @@
 #include "net/rpl/rpl-private.h"
 #include "net/rpl/rpl-ns.h"
 #include "net/packetbuf.h"
+#include "lib/list.h"
+#include "lib/memb.h"
 
 #define DEBUG DEBUG_NONE
 #include "net/ip/uip-debug.h"
@@ -131,6 +133,9 @@ rpl_verify_hbh_header(int uip_ext_opt_offset)
     /* A rank error was signalled, attempt to repair it by updating
      * the sender's rank from ext header */
     sender->rank = sender_rank;
+#if RPL_WITH_PARENT_HEAP
+    rpl_parent_heap_update(sender);
+#endif /* RPL_WITH_PARENT_HEAP */
     if(RPL_IS_NON_STORING(instance)) {
       /* Select DAG and preferred parent only in non-storing mode. In storing mode,
        * a parent switch would result in an immediate No-path DAO transmission, dropping
@@ -322,6 +327,44 @@ count_matching_bytes(const void *p1, const void *p2, size_t n)
   return n;
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_NS_SRH_CACHE_SIZE
+static int
+insert_cached_srh(const rpl_ns_srh_t *e)
+{
+  uint8_t temp_len;
+
+  if(e->ext_len == 0) {
+    PRINTF("RPL: SRH no need to insert SRH\n");
+    return 1;
+  }
+
+  if(uip_len + e->ext_len > UIP_BUFSIZE) {
+    PRINTF("RPL: Packet too long: impossible to add source routing header (%u bytes)\n", e->ext_len);
+    return 1;
+  }
+
+  memmove(uip_buf + uip_l2_l3_hdr_len + e->ext_len,
+      uip_buf + uip_l2_l3_hdr_len, uip_len - UIP_IPH_LEN);
+  memcpy(uip_buf + uip_l2_l3_hdr_len, e->hdr, e->ext_len);
+
+  UIP_RH_BUF->next = UIP_IP_BUF->proto;
+  UIP_IP_BUF->proto = UIP_PROTO_ROUTING;
+  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &e->next_hop);
+
+  /* In-place update of IPv6 length field */
+  temp_len = UIP_IP_BUF->len[1];
+  UIP_IP_BUF->len[1] += e->ext_len;
+  if(UIP_IP_BUF->len[1] < temp_len) {
+    UIP_IP_BUF->len[0]++;
+  }
+
+  uip_ext_len += e->ext_len;
+  uip_len += e->ext_len;
+
+  return 1;
+}
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+/*---------------------------------------------------------------------------*/
 static int
 insert_srh_header(void)
 {
@@ -337,6 +380,9 @@ insert_srh_header(void)
   rpl_ns_node_t *node;
   rpl_dag_t *dag;
   uip_ipaddr_t node_addr;
+#if RPL_NS_SRH_CACHE_SIZE
+  const rpl_ns_srh_t *srh;
+#endif /* RPL_NS_SRH_CACHE_SIZE */
 
   PRINTF("RPL: SRH creating source routing header with destination ");
   PRINT6ADDR(&UIP_IP_BUF->destipaddr);
@@ -358,12 +404,25 @@ insert_srh_header(void)
     return 1;
   }
 
+#if RPL_NS_SRH_CACHE_SIZE
+  srh = rpl_ns_get_cached_srh(dest_node);
+  if(srh != NULL) {
+    return insert_cached_srh(srh);
+  }
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
   root_node = rpl_ns_get_node(dag, &dag->dag_id);
   if(root_node == NULL) {
     PRINTF("RPL: SRH root node not found\n");
     return 0;
   }
 
+#if RPL_NS_ROUTE_CACHE
+  if(rpl_ns_get_cached_route(dest_node, &path_len, &cmpri)) {
+    /* The path was already checked and measured */
+    cmpre = cmpri;
+  } else {
+#endif /* RPL_NS_ROUTE_CACHE */
   if(!rpl_ns_is_node_reachable(dag, &UIP_IP_BUF->destipaddr)) {
     PRINTF("RPL: SRH no path found to destination\n");
     return 0;
@@ -376,11 +435,6 @@ insert_srh_header(void)
   cmpri = 15;
   cmpre = 15;
 
-  if(node == root_node) {
-    PRINTF("RPL: SRH no need to insert SRH\n");
-    return 1;
-  }
-
   while(node != NULL && node != root_node) {
 
     rpl_ns_get_node_global_addr(&node_addr, node);
@@ -395,6 +449,19 @@ insert_srh_header(void)
     node = node->parent;
     path_len++;
   }
+#if RPL_NS_ROUTE_CACHE
+    rpl_ns_set_cached_route(dest_node, path_len, cmpri);
+  }
+#endif /* RPL_NS_ROUTE_CACHE */
+
+  if(path_len == 0) {
+    PRINTF("RPL: SRH no need to insert SRH\n");
+#if RPL_NS_SRH_CACHE_SIZE
+    rpl_ns_set_cached_srh(dest_node, &UIP_IP_BUF->destipaddr,
+                          (const uint8_t *)UIP_RH_BUF, 0);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+    return 1;
+  }
 
   /* Extension header length: fixed headers + (n-1) * (16-ComprI) + (16-ComprE)*/
   ext_len = RPL_RH_LEN + RPL_SRH_LEN
@@ -449,6 +516,11 @@ insert_srh_header(void)
   rpl_ns_get_node_global_addr(&node_addr, node);
   uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &node_addr);
 
+#if RPL_NS_SRH_CACHE_SIZE
+  rpl_ns_set_cached_srh(dest_node, &UIP_IP_BUF->destipaddr,
+                        (const uint8_t *)UIP_RH_BUF, ext_len);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
   /* In-place update of IPv6 length field */
   temp_len = UIP_IP_BUF->len[1];
   UIP_IP_BUF->len[1] += ext_len;
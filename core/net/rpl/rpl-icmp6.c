@@ -54,6 +54,8 @@
 #include "net/rpl/rpl-ns.h"
 #include "net/packetbuf.h"
 #include "net/ipv6/multicast/uip-mcast6.h"
+#include "lib/list.h"
+#include "lib/memb.h"
 #include "random.h"
 
 #include <limits.h>
@@ -136,6 +138,363 @@ prepare_for_dao_fwd(uint8_t sequence, uip_ds6_route_t *rep)
 }
 #endif /* RPL_WITH_STORING */
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_STORING || RPL_DAO_QUEUE_SIZE
+/* A target of a DAO, with the Transit Information that applies to it */
+struct dao_target {
+  uip_ipaddr_t prefix;
+  uip_ipaddr_t parent;
+  uint8_t prefixlen;
+  uint8_t lifetime;
+};
+
+/* The length of the DAO option at position i, or 0 if it does not fit
+   in the buffer */
+static int
+dao_option_length(unsigned char *buffer, int i, int buffer_length)
+{
+  int len;
+
+  if(buffer[i] == RPL_OPTION_PAD1) {
+    return 1;
+  }
+  if(i + 2 > buffer_length) {
+    return 0;
+  }
+  len = 2 + buffer[i + 1];
+  return i + len <= buffer_length ? len : 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Get the first target of the DAO options from pos on, with the lifetime
+   and parent of the Transit Information option that follows it. Returns
+   the position after the target, 0 if there are no more targets, or -1
+   if an option is malformed. */
+static int
+dao_next_target(unsigned char *buffer, int pos, int buffer_length,
+                uint8_t lifetime, struct dao_target *t)
+{
+  int i;
+  int len;
+  int next;
+
+  for(i = pos; i < buffer_length; i += len) {
+    len = dao_option_length(buffer, i, buffer_length);
+    if(len == 0) {
+      goto malformed;
+    }
+    if(buffer[i] == RPL_OPTION_TARGET) {
+      break;
+    }
+  }
+  if(i >= buffer_length) {
+    return 0;
+  }
+
+  memset(t, 0, sizeof(*t));
+  if(len < 4 || buffer[i + 3] > 128 ||
+     4 + (buffer[i + 3] + 7) / CHAR_BIT > len) {
+    goto malformed;
+  }
+  t->prefixlen = buffer[i + 3];
+  memcpy(&t->prefix, buffer + i + 4, (t->prefixlen + 7) / CHAR_BIT);
+  t->lifetime = lifetime;
+  next = i + len;
+
+  for(i = next; i < buffer_length; i += len) {
+    len = dao_option_length(buffer, i, buffer_length);
+    if(len == 0) {
+      goto malformed;
+    }
+    if(buffer[i] == RPL_OPTION_TRANSIT) {
+      if(len < 6) {
+        goto malformed;
+      }
+      t->lifetime = buffer[i + 5];
+      if(len >= 22) {
+        memcpy(&t->parent, buffer + i + 6, 16);
+      }
+      break;
+    }
+  }
+  return next;
+
+malformed:
+  PRINTF("RPL: Malformed DAO option at %d\n", i);
+  RPL_STAT(rpl_stats.malformed_msgs++);
+  return -1;
+}
+#endif /* RPL_WITH_STORING || RPL_DAO_QUEUE_SIZE */
+/*---------------------------------------------------------------------------*/
+#if RPL_WITH_STORING
+/* A target waiting to be sent to our parent */
+struct dao_pack_target {
+  uip_ipaddr_t prefix;
+  uint8_t prefixlen;
+  uint8_t lifetime;
+};
+
+static struct dao_pack_target dao_pack[RPL_DAO_PACKING_MAX_TARGETS];
+static uint8_t dao_pack_len;
+static rpl_instance_t *dao_pack_instance;
+static struct ctimer dao_pack_timer;
+
+/* The most space a target takes in a DAO, with a Transit Information
+   option of its own */
+#define DAO_PACK_TARGET_SPACE (4 + 16 + 6)
+/* The space for targets in a DAO that fits in the MTU */
+#define DAO_PACK_SPACE        (UIP_LINK_MTU - UIP_IPICMPH_LEN - 4 - 16)
+/*---------------------------------------------------------------------------*/
+static void
+dao_pack_flush(void *ptr)
+{
+  rpl_instance_t *instance;
+  uip_ipaddr_t *parent_ipaddr;
+  uip_ds6_route_t *rep;
+  unsigned char *buffer;
+  uint8_t done[RPL_DAO_PACKING_MAX_TARGETS];
+  uint8_t lifetime;
+  int pos;
+  int i;
+  int j;
+  int n;
+
+  ctimer_stop(&dao_pack_timer);
+  instance = dao_pack_instance;
+  n = dao_pack_len;
+  dao_pack_len = 0;
+
+  if(n == 0 || rpl_get_mode() == RPL_MODE_FEATHER ||
+     instance == NULL || instance->current_dag == NULL ||
+     instance->current_dag->preferred_parent == NULL) {
+    return;
+  }
+  parent_ipaddr = rpl_get_parent_ipaddr(instance->current_dag->preferred_parent);
+  if(parent_ipaddr == NULL) {
+    return;
+  }
+
+  RPL_LOLLIPOP_INCREMENT(dao_sequence);
+
+  uip_clear_buf();
+  buffer = UIP_ICMP_PAYLOAD;
+  pos = 0;
+
+  buffer[pos++] = instance->instance_id;
+  buffer[pos] = 0;
+#if RPL_DAO_SPECIFY_DAG
+  buffer[pos] |= RPL_DAO_D_FLAG;
+#endif /* RPL_DAO_SPECIFY_DAG */
+#if RPL_WITH_DAO_ACK
+  for(i = 0; i < n; i++) {
+    if(dao_pack[i].lifetime != RPL_ZERO_LIFETIME) {
+      buffer[pos] |= RPL_DAO_K_FLAG;
+      break;
+    }
+  }
+#endif /* RPL_WITH_DAO_ACK */
+  ++pos;
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = dao_sequence;
+#if RPL_DAO_SPECIFY_DAG
+  memcpy(buffer + pos, &instance->current_dag->dag_id,
+         sizeof(instance->current_dag->dag_id));
+  pos += sizeof(instance->current_dag->dag_id);
+#endif /* RPL_DAO_SPECIFY_DAG */
+
+  /* Targets with the same lifetime share a Transit Information option */
+  memset(done, 0, sizeof(done));
+  for(i = 0; i < n; i++) {
+    if(done[i]) {
+      continue;
+    }
+    lifetime = dao_pack[i].lifetime;
+    for(j = i; j < n; j++) {
+      if(done[j] || dao_pack[j].lifetime != lifetime) {
+        continue;
+      }
+      done[j] = 1;
+      buffer[pos++] = RPL_OPTION_TARGET;
+      buffer[pos++] = 2 + ((dao_pack[j].prefixlen + 7) / CHAR_BIT);
+      buffer[pos++] = 0; /* reserved */
+      buffer[pos++] = dao_pack[j].prefixlen;
+      memcpy(buffer + pos, &dao_pack[j].prefix,
+             (dao_pack[j].prefixlen + 7) / CHAR_BIT);
+      pos += (dao_pack[j].prefixlen + 7) / CHAR_BIT;
+
+      /* The DAO-ACK for this DAO is to be forwarded to the sender of
+         the target */
+      rep = uip_ds6_route_lookup(&dao_pack[j].prefix);
+      if(rep != NULL && rep->length == dao_pack[j].prefixlen &&
+         RPL_ROUTE_IS_DAO_PENDING(rep)) {
+        rep->state.dao_seqno_out = dao_sequence;
+      }
+    }
+    buffer[pos++] = RPL_OPTION_TRANSIT;
+    buffer[pos++] = 4;
+    buffer[pos++] = 0; /* flags - ignored */
+    buffer[pos++] = 0; /* path control - ignored */
+    buffer[pos++] = 0; /* path seq - ignored */
+    buffer[pos++] = lifetime;
+  }
+
+  PRINTF("RPL: Sending a DAO with %u targets and sequence number %u to ",
+         n, dao_sequence);
+  PRINT6ADDR(parent_ipaddr);
+  PRINTF("\n");
+
+  uip_icmp6_send(parent_ipaddr, ICMP6_RPL, RPL_CODE_DAO, pos);
+}
+/*---------------------------------------------------------------------------*/
+/* Add a target to the next DAO to our parent. Returns 0 if there is no
+   room for it. */
+static int
+dao_pack_add(rpl_instance_t *instance, struct dao_target *t)
+{
+  int i;
+
+  if(dao_pack_len > 0 && dao_pack_instance != instance) {
+    return 0;
+  }
+  dao_pack_instance = instance;
+
+  for(i = 0; i < dao_pack_len; i++) {
+    if(dao_pack[i].prefixlen == t->prefixlen &&
+       uip_ipaddr_cmp(&dao_pack[i].prefix, &t->prefix)) {
+      dao_pack[i].lifetime = t->lifetime;
+      return 1;
+    }
+  }
+
+  if(dao_pack_len >= RPL_DAO_PACKING_MAX_TARGETS ||
+     (dao_pack_len + 1) * DAO_PACK_TARGET_SPACE > DAO_PACK_SPACE) {
+    return 0;
+  }
+  uip_ipaddr_copy(&dao_pack[dao_pack_len].prefix, &t->prefix);
+  dao_pack[dao_pack_len].prefixlen = t->prefixlen;
+  dao_pack[dao_pack_len].lifetime = t->lifetime;
+  dao_pack_len++;
+
+#if RPL_DAO_PACKING
+  if(ctimer_expired(&dao_pack_timer)) {
+    ctimer_set(&dao_pack_timer, RPL_DAO_PACKING_DELAY, dao_pack_flush, NULL);
+  }
+#endif /* RPL_DAO_PACKING */
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Process the targets of a unicast DAO in storing mode, and pass them on
+   to our parent through the DAO pack. DAOs with several targets are
+   understood whether or not we pack the DAOs we send. */
+static void
+dao_input_targets(rpl_instance_t *instance, uip_ipaddr_t *from,
+                 uint8_t flags, uint8_t sequence,
+                 unsigned char *buffer, int pos, int buffer_length)
+{
+  rpl_dag_t *dag;
+  uip_ds6_route_t *rep;
+  struct dao_target t;
+  uint8_t status;
+  int is_root;
+  int ack_now;
+
+  dag = instance->current_dag;
+  is_root = (dag->rank == ROOT_RANK(instance));
+  status = RPL_DAO_ACK_UNCONDITIONAL_ACCEPT;
+  ack_now = 1;
+
+  for(pos = dao_next_target(buffer, pos, buffer_length,
+                            instance->default_lifetime, &t);
+      pos > 0;
+      pos = dao_next_target(buffer, pos, buffer_length,
+                            instance->default_lifetime, &t)) {
+    PRINTF("RPL: DAO lifetime: %u, prefix length: %u prefix: ",
+           (unsigned)t.lifetime, (unsigned)t.prefixlen);
+    PRINT6ADDR(&t.prefix);
+    PRINTF("\n");
+
+#if RPL_WITH_MULTICAST
+    if(uip_is_addr_mcast_global(&t.prefix)) {
+      mcast_group = uip_mcast6_route_add(&t.prefix);
+      if(mcast_group) {
+        mcast_group->dag = dag;
+        mcast_group->lifetime = RPL_LIFETIME(instance, t.lifetime);
+      }
+      if(dag->preferred_parent != NULL) {
+        dao_pack_add(instance, &t);
+      }
+      continue;
+    }
+#endif /* RPL_WITH_MULTICAST */
+
+    rep = uip_ds6_route_lookup(&t.prefix);
+
+    if(t.lifetime == RPL_ZERO_LIFETIME) {
+      PRINTF("RPL: No-Path DAO received\n");
+      if(rep != NULL &&
+         !RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
+         rep->length == t.prefixlen &&
+         uip_ds6_route_nexthop(rep) != NULL &&
+         uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), from)) {
+        RPL_ROUTE_SET_NOPATH_RECEIVED(rep);
+        rep->state.lifetime = RPL_NOPATH_REMOVAL_DELAY;
+        if(dag->preferred_parent != NULL) {
+          dao_pack_add(instance, &t);
+        }
+      }
+      continue;
+    }
+
+    if(rpl_icmp6_update_nbr_table(from, NBR_TABLE_REASON_RPL_DAO, instance) == NULL ||
+       (rep = rpl_add_route(dag, &t.prefix, t.prefixlen, from)) == NULL) {
+      RPL_STAT(rpl_stats.mem_overflows++);
+      PRINTF("RPL: Could not add a route after receiving a DAO\n");
+      status = is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
+        RPL_DAO_ACK_UNABLE_TO_ACCEPT;
+      continue;
+    }
+
+    /* set lifetime and clear NOPATH bit */
+    rep->state.lifetime = RPL_LIFETIME(instance, t.lifetime);
+    RPL_ROUTE_CLEAR_NOPATH_RECEIVED(rep);
+
+    /* The DAO is acknowledged now only if all its routes are already
+       installed above us, as for a single target */
+    if(!is_root &&
+       (RPL_ROUTE_IS_DAO_PENDING(rep) || rep->state.dao_seqno_in != sequence)) {
+      ack_now = 0;
+    }
+
+    if(dag->preferred_parent != NULL) {
+      if(!dao_pack_add(instance, &t)) {
+        /* Leave it to the sender to retransmit */
+        PRINTF("RPL: No room to forward DAO target\n");
+        ack_now = 0;
+      } else if(!RPL_ROUTE_IS_DAO_PENDING(rep) ||
+                rep->state.dao_seqno_in != sequence) {
+        /* not a retransmission */
+        rep->state.dao_seqno_in = sequence;
+        RPL_ROUTE_SET_DAO_PENDING(rep);
+      }
+    }
+  }
+
+#if RPL_DAO_PACKING
+  if(dao_pack_len >= RPL_DAO_PACKING_MAX_TARGETS) {
+    dao_pack_flush(NULL);
+  }
+#else /* RPL_DAO_PACKING */
+  /* Send the targets of this DAO on in a DAO of their own */
+  dao_pack_flush(NULL);
+#endif /* RPL_DAO_PACKING */
+
+  if((flags & RPL_DAO_K_FLAG) &&
+     (ack_now || status != RPL_DAO_ACK_UNCONDITIONAL_ACCEPT)) {
+    PRINTF("RPL: Sending DAO ACK\n");
+    uip_clear_buf();
+    dao_ack_output(instance, from, sequence, status);
+  }
+}
+#endif /* RPL_WITH_STORING */
+/*---------------------------------------------------------------------------*/
 static int
 get_global_addr(uip_ipaddr_t *addr)
 {
@@ -279,7 +638,7 @@ static void
 dio_input(void)
 {
   unsigned char *buffer;
-  uint8_t buffer_length;
+  uint16_t buffer_length;
   rpl_dio_t dio;
   uint8_t subopt_type;
   int i;
@@ -641,7 +1000,7 @@ dao_input_storing(void)
   */
   uip_ipaddr_t prefix;
   uip_ds6_route_t *rep;
-  uint8_t buffer_length;
+  uint16_t buffer_length;
   int pos;
   int len;
   int i;
@@ -713,8 +1072,14 @@ dao_input_storing(void)
       parent->flags |= RPL_PARENT_FLAG_UPDATED;
       return;
     }
+
+    dao_input_targets(instance, &dao_sender_addr, flags, sequence,
+                      buffer, pos, buffer_length);
+    return;
   }
 
+  /* A multicast DAO, with a single target */
+
   /* Check if there are any RPL options present. */
   for(i = pos; i < buffer_length; i += len) {
     subopt_type = buffer[i];
@@ -749,17 +1114,12 @@ dao_input_storing(void)
 
 #if RPL_WITH_MULTICAST
   if(uip_is_addr_mcast_global(&prefix)) {
-    /*
-     * "rep" is used for a unicast route which we don't need now; so set NULL so
-     * that operations on "rep" will be skipped.
-     */
-    rep = NULL;
     mcast_group = uip_mcast6_route_add(&prefix);
     if(mcast_group) {
       mcast_group->dag = dag;
       mcast_group->lifetime = RPL_LIFETIME(instance, lifetime);
     }
-    goto fwd_dao;
+    return;
   }
 #endif
 
@@ -841,60 +1201,6 @@ dao_input_storing(void)
   /* set lifetime and clear NOPATH bit */
   rep->state.lifetime = RPL_LIFETIME(instance, lifetime);
   RPL_ROUTE_CLEAR_NOPATH_RECEIVED(rep);
-
-#if RPL_WITH_MULTICAST
-fwd_dao:
-#endif
-
-  if(learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
-    int should_ack = 0;
-
-    if(flags & RPL_DAO_K_FLAG) {
-      if(rep != NULL) {
-        /*
-         * check if this route is already installed and we can ack now!
-         * not pending - and same seq-no means that we can ack.
-         * (e.g. the route is installed already so it will not take any
-         * more room that it already takes - so should be ok!)
-         */
-        if((!RPL_ROUTE_IS_DAO_PENDING(rep) &&
-            rep->state.dao_seqno_in == sequence) ||
-           dag->rank == ROOT_RANK(instance)) {
-          should_ack = 1;
-        }
-      }
-    }
-
-    if(dag->preferred_parent != NULL &&
-       rpl_get_parent_ipaddr(dag->preferred_parent) != NULL) {
-      uint8_t out_seq = 0;
-      if(rep != NULL) {
-        /* if this is pending and we get the same seq no it is a retrans */
-        if(RPL_ROUTE_IS_DAO_PENDING(rep) &&
-           rep->state.dao_seqno_in == sequence) {
-          /* keep the same seq-no as before for parent also */
-          out_seq = rep->state.dao_seqno_out;
-        } else {
-          out_seq = prepare_for_dao_fwd(sequence, rep);
-        }
-      }
-
-      PRINTF("RPL: Forwarding DAO to parent ");
-      PRINT6ADDR(rpl_get_parent_ipaddr(dag->preferred_parent));
-      PRINTF(" in seq: %d out seq: %d\n", sequence, out_seq);
-
-      buffer = UIP_ICMP_PAYLOAD;
-      buffer[3] = out_seq; /* add an outgoing seq no before fwd */
-      uip_icmp6_send(rpl_get_parent_ipaddr(dag->preferred_parent),
-                     ICMP6_RPL, RPL_CODE_DAO, buffer_length);
-    }
-    if(should_ack) {
-      PRINTF("RPL: Sending DAO ACK\n");
-      uip_clear_buf();
-      dao_ack_output(instance, &dao_sender_addr, sequence,
-                     RPL_DAO_ACK_UNCONDITIONAL_ACCEPT);
-    }
-  }
 #endif /* RPL_WITH_STORING */
 }
 /*---------------------------------------------------------------------------*/
@@ -914,7 +1220,7 @@ dao_input_nonstoring(void)
   uint8_t flags;
   uint8_t subopt_type;
   uip_ipaddr_t prefix;
-  uint8_t buffer_length;
+  uint16_t buffer_length;
   int pos;
   int len;
   int i;
@@ -1002,6 +1308,240 @@ dao_input_nonstoring(void)
 #endif /* RPL_WITH_NON_STORING */
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_DAO_QUEUE_SIZE
+/* A DAO waiting to be processed at the root */
+struct dao_entry {
+  struct dao_entry *next;
+  uip_ipaddr_t sender;
+  uip_ipaddr_t prefix;
+  uip_ipaddr_t parent;
+  uint8_t instance_id;
+  uint8_t flags;
+  uint8_t sequence;
+  uint8_t lifetime;
+  uint8_t prefixlen;
+};
+
+MEMB(dao_queue_memb, struct dao_entry, RPL_DAO_QUEUE_SIZE);
+LIST(dao_queue);
+static struct ctimer dao_queue_timer;
+/*---------------------------------------------------------------------------*/
+static void
+dao_queue_process(struct dao_entry *q)
+{
+  rpl_instance_t *instance;
+  rpl_dag_t *dag;
+  uint8_t status;
+
+  instance = rpl_get_instance(q->instance_id);
+  if(instance == NULL || instance->current_dag == NULL) {
+    return;
+  }
+  dag = instance->current_dag;
+  status = RPL_DAO_ACK_UNCONDITIONAL_ACCEPT;
+
+#if RPL_WITH_STORING
+  if(RPL_IS_STORING(instance)) {
+    uip_ds6_route_t *rep;
+
+    rep = uip_ds6_route_lookup(&q->prefix);
+    if(q->lifetime == RPL_ZERO_LIFETIME) {
+      PRINTF("RPL: No-Path DAO received\n");
+      if(rep != NULL &&
+         !RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
+         rep->length == q->prefixlen &&
+         uip_ds6_route_nexthop(rep) != NULL &&
+         uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &q->sender)) {
+        RPL_ROUTE_SET_NOPATH_RECEIVED(rep);
+        rep->state.lifetime = RPL_NOPATH_REMOVAL_DELAY;
+      }
+    } else {
+      rep = rpl_add_route(dag, &q->prefix, q->prefixlen, &q->sender);
+      if(rep == NULL) {
+        RPL_STAT(rpl_stats.mem_overflows++);
+        PRINTF("RPL: Could not add a route after receiving a DAO\n");
+        status = RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT;
+      } else {
+        rep->state.lifetime = RPL_LIFETIME(instance, q->lifetime);
+        RPL_ROUTE_CLEAR_NOPATH_RECEIVED(rep);
+      }
+    }
+  }
+#endif /* RPL_WITH_STORING */
+
+#if RPL_WITH_NON_STORING
+  if(RPL_IS_NON_STORING(instance)) {
+    if(q->lifetime == RPL_ZERO_LIFETIME) {
+      PRINTF("RPL: No-Path DAO received\n");
+      rpl_ns_expire_parent(dag, &q->prefix, &q->parent);
+    } else if(rpl_ns_update_node(dag, &q->prefix, &q->parent,
+                                  RPL_LIFETIME(instance, q->lifetime)) == NULL) {
+      PRINTF("RPL: failed to add link\n");
+      return;
+    }
+  }
+#endif /* RPL_WITH_NON_STORING */
+
+  if(q->flags & RPL_DAO_K_FLAG) {
+    dao_ack_output(instance, &q->sender, q->sequence, status);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+dao_queue_run(void *ptr)
+{
+  struct dao_entry *q;
+  int n;
+
+  for(n = 0; n < RPL_DAO_QUEUE_BATCH; n++) {
+    q = list_pop(dao_queue);
+    if(q == NULL) {
+      return;
+    }
+    dao_queue_process(q);
+    memb_free(&dao_queue_memb, q);
+  }
+
+  if(list_head(dao_queue) != NULL) {
+    ctimer_set(&dao_queue_timer, RPL_DAO_QUEUE_INTERVAL, dao_queue_run, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* The queued DAO from the sender of e for target t, if there is one */
+static struct dao_entry *
+dao_queue_lookup(struct dao_entry *e, struct dao_target *t)
+{
+  struct dao_entry *q;
+
+  for(q = list_head(dao_queue); q != NULL; q = list_item_next(q)) {
+    if(q->instance_id == e->instance_id && q->prefixlen == t->prefixlen &&
+       uip_ipaddr_cmp(&q->prefix, &t->prefix) &&
+       uip_ipaddr_cmp(&q->sender, &e->sender)) {
+      return q;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+/* Queue the DAO in uip_buf if we are the root. Returns 0 if the DAO is
+   to be processed right away. */
+static int
+dao_queue_input(rpl_instance_t *instance)
+{
+  struct dao_entry e;
+  struct dao_entry *q;
+  struct dao_target t;
+  rpl_dag_t *dag;
+  unsigned char *buffer;
+  uint16_t buffer_length;
+  uint8_t flags;
+  int targets;
+  int needed;
+  int start;
+  int pos;
+
+  dag = instance->current_dag;
+  if(dag == NULL || dag->rank != ROOT_RANK(instance) ||
+     (!RPL_IS_STORING(instance) && !RPL_IS_NON_STORING(instance))) {
+    return 0;
+  }
+
+  memset(&e, 0, sizeof(e));
+  uip_ipaddr_copy(&e.sender, &UIP_IP_BUF->srcipaddr);
+
+  buffer = UIP_ICMP_PAYLOAD;
+  buffer_length = uip_len - uip_l3_icmp_hdr_len;
+
+  pos = 0;
+  e.instance_id = buffer[pos++];
+  flags = buffer[pos++];
+  /* reserved */
+  pos++;
+  e.sequence = buffer[pos++];
+
+  /* Is the DAG ID present? */
+  if(flags & RPL_DAO_D_FLAG) {
+    if(memcmp(&dag->dag_id, &buffer[pos], sizeof(dag->dag_id))) {
+      PRINTF("RPL: Ignoring a DAO for a DAG different from ours\n");
+      return 1;
+    }
+    pos += 16;
+  }
+
+  /* Check the targets before queueing any of them */
+  start = pos;
+  targets = 0;
+  needed = 0;
+  while((pos = dao_next_target(buffer, pos, buffer_length,
+                               instance->default_lifetime, &t)) > 0) {
+#if RPL_WITH_MULTICAST
+    if(uip_is_addr_mcast_global(&t.prefix)) {
+      return 0;
+    }
+#endif /* RPL_WITH_MULTICAST */
+    /* The link-layer address of the sender is only known now */
+    if(RPL_IS_STORING(instance) && t.lifetime != RPL_ZERO_LIFETIME &&
+       rpl_icmp6_update_nbr_table(&e.sender, NBR_TABLE_REASON_RPL_DAO,
+                                  instance) == NULL) {
+      return 0;
+    }
+    targets++;
+    /* A target that is already queued for the sender takes no room */
+    if(dao_queue_lookup(&e, &t) == NULL) {
+      needed++;
+    }
+  }
+  if(pos < 0) {
+    return 1;
+  }
+  if(memb_numfree(&dao_queue_memb) < needed) {
+    PRINTF("RPL: DAO queue full, dropping DAO from ");
+    PRINT6ADDR(&e.sender);
+    PRINTF("\n");
+    RPL_STAT(rpl_stats.dao_queue_drops++);
+    return 1;
+  }
+
+  pos = start;
+  while((pos = dao_next_target(buffer, pos, buffer_length,
+                               instance->default_lifetime, &t)) > 0) {
+    uip_ipaddr_copy(&e.prefix, &t.prefix);
+    uip_ipaddr_copy(&e.parent, &t.parent);
+    e.prefixlen = t.prefixlen;
+    e.lifetime = t.lifetime;
+    /* The DAO is acknowledged once its last target is processed */
+    e.flags = --targets == 0 ? flags : flags & ~RPL_DAO_K_FLAG;
+
+    /* A newer DAO from the same sender for the same target replaces
+       the one in the queue */
+    q = dao_queue_lookup(&e, &t);
+    if(q != NULL) {
+      e.next = q->next;
+      memcpy(q, &e, sizeof(e));
+      RPL_STAT(rpl_stats.dao_queue_merged++);
+    } else {
+      q = memb_alloc(&dao_queue_memb);
+      memcpy(q, &e, sizeof(e));
+      list_add(dao_queue, q);
+    }
+  }
+  RPL_STAT(rpl_stats.dao_queue_max = MAX(rpl_stats.dao_queue_max,
+                                         list_length(dao_queue)));
+
+  if(ctimer_expired(&dao_queue_timer)) {
+    /* Process what has been queued once we are out of the input path */
+    ctimer_set(&dao_queue_timer, 0, dao_queue_run, NULL);
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_icmp6_dao_queue_length(void)
+{
+  return list_length(dao_queue);
+}
+#endif /* RPL_DAO_QUEUE_SIZE */
+/*---------------------------------------------------------------------------*/
 static void
 dao_input(void)
 {
@@ -1021,6 +1561,12 @@ dao_input(void)
     goto discard;
   }
 
+#if RPL_DAO_QUEUE_SIZE
+  if(dao_queue_input(instance)) {
+    goto discard;
+  }
+#endif /* RPL_DAO_QUEUE_SIZE */
+
   if(RPL_IS_STORING(instance)) {
     dao_input_storing();
   } else if(RPL_IS_NON_STORING(instance)) {
@@ -1313,19 +1859,37 @@ dao_ack_input(void)
     /* this DAO ACK should be forwarded to another recently registered route */
     uip_ds6_route_t *re;
     uip_ipaddr_t *nexthop;
-    if((re = find_route_entry_by_dao_ack(sequence)) != NULL) {
-      /* pick the recorded seq no from that node and forward DAO ACK - and
-         clear the pending flag*/
+    /* The DAO may have carried the targets of several DAOs: forward the
+       ACK once to each of their senders */
+    uip_ipaddr_t *acked_nexthop[RPL_DAO_PACKING_MAX_TARGETS];
+    uint8_t acked_seqno[RPL_DAO_PACKING_MAX_TARGETS];
+    int acked;
+    int i;
+
+    acked = 0;
+    while((re = find_route_entry_by_dao_ack(sequence)) != NULL) {
       RPL_ROUTE_CLEAR_DAO_PENDING(re);
-
       nexthop = uip_ds6_route_nexthop(re);
-      if(nexthop == NULL) {
-        PRINTF("RPL: No next hop to fwd DAO ACK to\n");
-      } else {
+      for(i = 0; i < acked; i++) {
+        if(acked_nexthop[i] == nexthop && acked_seqno[i] == re->state.dao_seqno_in) {
+          break;
+        }
+      }
+      if(nexthop != NULL && i == acked) {
+        if(acked < RPL_DAO_PACKING_MAX_TARGETS) {
+          acked_nexthop[acked] = nexthop;
+          acked_seqno[acked] = re->state.dao_seqno_in;
+          acked++;
+        }
         PRINTF("RPL: Fwd DAO ACK to:");
         PRINT6ADDR(nexthop);
         PRINTF("\n");
+        uip_clear_buf();
+        buffer = UIP_ICMP_PAYLOAD;
+        buffer[0] = instance_id;
+        buffer[1] = 0;
         buffer[2] = re->state.dao_seqno_in;
+        buffer[3] = status;
         uip_icmp6_send(nexthop, ICMP6_RPL, RPL_CODE_DAO_ACK, 4);
       }
 
@@ -1333,7 +1897,8 @@ dao_ack_input(void)
         /* this node did not get in to the routing tables above... - remove */
         uip_ds6_route_rm(re);
       }
-    } else {
+    }
+    if(acked == 0) {
       PRINTF("RPL: No route entry found to forward DAO ACK (seqno %u)\n", sequence);
     }
   }
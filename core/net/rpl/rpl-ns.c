@@ -63,6 +63,163 @@ static int num_nodes;
 LIST(nodelist);
 MEMB(nodememb, rpl_ns_node_t, RPL_NS_LINK_NUM);
 
+#if RPL_NS_HASH
+/* The nodes of nodelist, chained per bucket through hash_next */
+static rpl_ns_node_t *node_hash[RPL_NS_HASH_SIZE];
+#endif /* RPL_NS_HASH */
+
+#if RPL_NS_ROUTE_CACHE
+/* Incremented on every change that may change a source route */
+static uint16_t topology_version;
+#endif /* RPL_NS_ROUTE_CACHE */
+
+#if RPL_NS_SRH_CACHE_SIZE
+/* Headers of cached routes, most recently used first */
+LIST(srh_list);
+MEMB(srh_memb, rpl_ns_srh_t, RPL_NS_SRH_CACHE_SIZE);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
+/*---------------------------------------------------------------------------*/
+#if RPL_NS_HASH
+static rpl_ns_node_t **
+hash_bucket(const unsigned char *link_identifier)
+{
+  int i;
+  unsigned hash = 0;
+  for(i = 0; i < 8; i++) {
+    hash = hash * 31 + link_identifier[i];
+  }
+  return &node_hash[hash & (RPL_NS_HASH_SIZE - 1)];
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_add(rpl_ns_node_t *node)
+{
+  rpl_ns_node_t **bucket = hash_bucket(node->link_identifier);
+  node->hash_next = *bucket;
+  *bucket = node;
+}
+/*---------------------------------------------------------------------------*/
+static void
+hash_remove(rpl_ns_node_t *node)
+{
+  rpl_ns_node_t **l;
+  for(l = hash_bucket(node->link_identifier); *l != NULL; l = &(*l)->hash_next) {
+    if(*l == node) {
+      *l = node->hash_next;
+      return;
+    }
+  }
+}
+#endif /* RPL_NS_HASH */
+/*---------------------------------------------------------------------------*/
+#if RPL_NS_SRH_CACHE_SIZE
+static void
+srh_free(rpl_ns_node_t *node)
+{
+  if(node->route_srh != NULL) {
+    list_remove(srh_list, node->route_srh);
+    memb_free(&srh_memb, node->route_srh);
+    node->route_srh = NULL;
+  }
+}
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+/*---------------------------------------------------------------------------*/
+#if RPL_NS_ROUTE_CACHE
+static void
+invalidate_routes(void)
+{
+  rpl_ns_node_t *l;
+  if(++topology_version == 0) {
+    /* Wrapped around, make sure no old entry is taken for valid */
+    for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+      l->route_version = 0;
+#if RPL_NS_SRH_CACHE_SIZE
+      srh_free(l);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+    }
+    topology_version = 1;
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+rpl_ns_topology_version(void)
+{
+  return topology_version;
+}
+/*---------------------------------------------------------------------------*/
+int
+rpl_ns_get_cached_route(const rpl_ns_node_t *node, uint8_t *path_len, uint8_t *cmpr)
+{
+  if(node != NULL && node->route_version == topology_version) {
+    *path_len = node->route_len;
+    *cmpr = node->route_cmpr;
+    return 1;
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_set_cached_route(rpl_ns_node_t *node, uint8_t path_len, uint8_t cmpr)
+{
+  if(node != NULL) {
+    node->route_version = topology_version;
+    node->route_len = path_len;
+    node->route_cmpr = cmpr;
+#if RPL_NS_SRH_CACHE_SIZE
+    /* The header was built for the previous route */
+    srh_free(node);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+  }
+}
+#endif /* RPL_NS_ROUTE_CACHE */
+/*---------------------------------------------------------------------------*/
+#if RPL_NS_SRH_CACHE_SIZE
+const rpl_ns_srh_t *
+rpl_ns_get_cached_srh(rpl_ns_node_t *node)
+{
+  if(node == NULL || node->route_srh == NULL ||
+     node->route_version != topology_version) {
+    return NULL;
+  }
+  list_remove(srh_list, node->route_srh);
+  list_push(srh_list, node->route_srh);
+  return node->route_srh;
+}
+/*---------------------------------------------------------------------------*/
+void
+rpl_ns_set_cached_srh(rpl_ns_node_t *node, const uip_ipaddr_t *next_hop,
+                      const uint8_t *hdr, uint8_t ext_len)
+{
+  rpl_ns_srh_t *srh;
+
+  /* The header goes with the cached route of the node */
+  if(node == NULL || node->route_version != topology_version ||
+     ext_len > RPL_NS_SRH_CACHE_HDR_LEN) {
+    return;
+  }
+
+  srh = node->route_srh;
+  if(srh == NULL) {
+    srh = memb_alloc(&srh_memb);
+    if(srh == NULL) {
+      /* Take the header of the least recently used route */
+      srh = list_chop(srh_list);
+      srh->node->route_srh = NULL;
+    }
+  } else {
+    list_remove(srh_list, srh);
+  }
+
+  srh->node = node;
+  uip_ipaddr_copy(&srh->next_hop, next_hop);
+  srh->ext_len = ext_len;
+  memcpy(srh->hdr, hdr, ext_len);
+  node->route_srh = srh;
+  list_push(srh_list, srh);
+}
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
 /*---------------------------------------------------------------------------*/
 int
 rpl_ns_num_nodes(void)
@@ -85,7 +242,14 @@ rpl_ns_node_t *
 rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr)
 {
   rpl_ns_node_t *l;
+#if RPL_NS_HASH
+  if(addr == NULL) {
+    return NULL;
+  }
+  for(l = *hash_bucket(((const unsigned char *)addr) + 8); l != NULL; l = l->hash_next) {
+#else /* RPL_NS_HASH */
   for(l = list_head(nodelist); l != NULL; l = list_item_next(l)) {
+#endif /* RPL_NS_HASH */
     /* Compare prefix and node identifier */
     if(node_matches_address(dag, l, addr)) {
       return l;
@@ -114,6 +278,9 @@ rpl_ns_expire_parent(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr
   /* Check if parent matches */
   if(l != NULL && node_matches_address(dag, l->parent, parent)) {
     l->lifetime = RPL_NOPATH_REMOVAL_DELAY;
+#if RPL_NS_ROUTE_CACHE
+    invalidate_routes();
+#endif /* RPL_NS_ROUTE_CACHE */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -142,9 +309,23 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
       return NULL;
     }
     child_node->parent = NULL;
+#if RPL_NS_ROUTE_CACHE
+    child_node->route_version = 0;
+#endif /* RPL_NS_ROUTE_CACHE */
+#if RPL_NS_SRH_CACHE_SIZE
+    child_node->route_srh = NULL;
+#endif /* RPL_NS_SRH_CACHE_SIZE */
     list_add(nodelist, child_node);
     num_nodes++;
+#if RPL_NS_HASH
+    /* The link identifier is the hash key, set it before adding */
+    memcpy(child_node->link_identifier, ((const unsigned char *)child) + 8, 8);
+    hash_add(child_node);
+#endif /* RPL_NS_HASH */
   }
+#if RPL_NS_ROUTE_CACHE
+  old_parent_node = child_node->parent;
+#endif /* RPL_NS_ROUTE_CACHE */
 
   /* Initialize node */
   child_node->dag = dag;
@@ -167,6 +348,14 @@ rpl_ns_update_node(rpl_dag_t *dag, const uip_ipaddr_t *child, const uip_ipaddr_t
     child_node->parent = parent_node;
   }
 
+#if RPL_NS_ROUTE_CACHE
+  /* A new parent changes the routes to the node and to all nodes
+     below it. Refreshing an unchanged link does not. */
+  if(child_node->parent != old_parent_node) {
+    invalidate_routes();
+  }
+#endif /* RPL_NS_ROUTE_CACHE */
+
   return child_node;
 }
 /*---------------------------------------------------------------------------*/
@@ -176,6 +365,16 @@ rpl_ns_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+#if RPL_NS_HASH
+  memset(node_hash, 0, sizeof(node_hash));
+#endif /* RPL_NS_HASH */
+#if RPL_NS_SRH_CACHE_SIZE
+  memb_init(&srh_memb);
+  list_init(srh_list);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+#if RPL_NS_ROUTE_CACHE
+  invalidate_routes();
+#endif /* RPL_NS_ROUTE_CACHE */
 }
 /*---------------------------------------------------------------------------*/
 rpl_ns_node_t *
@@ -221,6 +420,15 @@ rpl_ns_periodic(void)
       }
       /* No child found, deallocate node */
       list_remove(nodelist, l);
+#if RPL_NS_HASH
+      hash_remove(l);
+#endif /* RPL_NS_HASH */
+#if RPL_NS_SRH_CACHE_SIZE
+      srh_free(l);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+#if RPL_NS_ROUTE_CACHE
+      invalidate_routes();
+#endif /* RPL_NS_ROUTE_CACHE */
       memb_free(&nodememb, l);
       num_nodes--;
     }
@@ -49,13 +49,84 @@
 #define RPL_NS_LINK_NUM 32
 #endif /* RPL_NS_CONF_LINK_NUM */
 
+/* Index the nodes in a hash table on their link identifier, so that
+ * rpl_ns_get_node() does not scan all nodes */
+#ifdef RPL_NS_CONF_HASH
+#define RPL_NS_HASH RPL_NS_CONF_HASH
+#else /* RPL_NS_CONF_HASH */
+#define RPL_NS_HASH 0
+#endif /* RPL_NS_CONF_HASH */
+
+/* Number of hash buckets, must be a power of two */
+#ifdef RPL_NS_CONF_HASH_SIZE
+#define RPL_NS_HASH_SIZE RPL_NS_CONF_HASH_SIZE
+#else /* RPL_NS_CONF_HASH_SIZE */
+#define RPL_NS_HASH_SIZE 32
+#endif /* RPL_NS_CONF_HASH_SIZE */
+
+/* Cache the length and compression of the source route to each node,
+ * so that the path does not have to be walked twice for every packet.
+ * The cache is invalidated by every change in the topology. */
+#ifdef RPL_NS_CONF_ROUTE_CACHE
+#define RPL_NS_ROUTE_CACHE RPL_NS_CONF_ROUTE_CACHE
+#else /* RPL_NS_CONF_ROUTE_CACHE */
+#define RPL_NS_ROUTE_CACHE 0
+#endif /* RPL_NS_CONF_ROUTE_CACHE */
+
+/* Number of destinations for which the root keeps the compiled source
+ * routing header along with the cached route, to insert it as is in the
+ * next packets. 0 disables it. It turns on the route cache and is
+ * invalidated with it. */
+#ifdef RPL_NS_CONF_SRH_CACHE_SIZE
+#define RPL_NS_SRH_CACHE_SIZE RPL_NS_CONF_SRH_CACHE_SIZE
+#else /* RPL_NS_CONF_SRH_CACHE_SIZE */
+#define RPL_NS_SRH_CACHE_SIZE 0
+#endif /* RPL_NS_CONF_SRH_CACHE_SIZE */
+
+/* Longest source routing header kept in the SRH cache, in bytes */
+#ifdef RPL_NS_CONF_SRH_CACHE_HDR_LEN
+#define RPL_NS_SRH_CACHE_HDR_LEN RPL_NS_CONF_SRH_CACHE_HDR_LEN
+#else /* RPL_NS_CONF_SRH_CACHE_HDR_LEN */
+#define RPL_NS_SRH_CACHE_HDR_LEN 64
+#endif /* RPL_NS_CONF_SRH_CACHE_HDR_LEN */
+
+#if RPL_NS_SRH_CACHE_SIZE && !RPL_NS_ROUTE_CACHE
+#undef RPL_NS_ROUTE_CACHE
+#define RPL_NS_ROUTE_CACHE 1
+#endif /* RPL_NS_SRH_CACHE_SIZE && !RPL_NS_ROUTE_CACHE */
+
+#if RPL_NS_SRH_CACHE_SIZE
+/* A source routing header as inserted in the last packet to a node */
+typedef struct rpl_ns_srh {
+  struct rpl_ns_srh *next;
+  struct rpl_ns_node *node;
+  /* The first hop, which replaces the IPv6 destination */
+  uip_ipaddr_t next_hop;
+  uint8_t ext_len; /* 0 if no header is needed */
+  uint8_t hdr[RPL_NS_SRH_CACHE_HDR_LEN];
+} rpl_ns_srh_t;
+#endif /* RPL_NS_SRH_CACHE_SIZE */
+
 typedef struct rpl_ns_node {
   struct rpl_ns_node *next;
+#if RPL_NS_HASH
+  struct rpl_ns_node *hash_next;
+#endif /* RPL_NS_HASH */
   uint32_t lifetime;
   rpl_dag_t *dag;
   /* Store only IPv6 link identifiers as all nodes in the DAG share the same prefix */
   unsigned char link_identifier[8];
   struct rpl_ns_node *parent;
+#if RPL_NS_ROUTE_CACHE
+  /* Topology version the cached route is valid for, 0 if none */
+  uint16_t route_version;
+  uint8_t route_len;
+  uint8_t route_cmpr;
+#endif /* RPL_NS_ROUTE_CACHE */
+#if RPL_NS_SRH_CACHE_SIZE
+  /* Header of the cached route, if kept */
+  rpl_ns_srh_t *route_srh;
+#endif /* RPL_NS_SRH_CACHE_SIZE */
 } rpl_ns_node_t;
 
 int rpl_ns_num_nodes(void);
@@ -68,5 +139,15 @@ rpl_ns_node_t *rpl_ns_get_node(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 int rpl_ns_is_node_reachable(const rpl_dag_t *dag, const uip_ipaddr_t *addr);
 void rpl_ns_get_node_global_addr(uip_ipaddr_t *addr, rpl_ns_node_t *node);
 void rpl_ns_periodic(void);
+#if RPL_NS_ROUTE_CACHE
+uint16_t rpl_ns_topology_version(void);
+int rpl_ns_get_cached_route(const rpl_ns_node_t *node, uint8_t *path_len, uint8_t *cmpr);
+void rpl_ns_set_cached_route(rpl_ns_node_t *node, uint8_t path_len, uint8_t cmpr);
+#endif /* RPL_NS_ROUTE_CACHE */
+#if RPL_NS_SRH_CACHE_SIZE
+const rpl_ns_srh_t *rpl_ns_get_cached_srh(rpl_ns_node_t *node);
+void rpl_ns_set_cached_srh(rpl_ns_node_t *node, const uip_ipaddr_t *next_hop,
+                           const uint8_t *hdr, uint8_t ext_len);
+#endif /* RPL_NS_SRH_CACHE_SIZE */
 
 #endif /* RPL_NS_H */
@@ -324,6 +324,14 @@ struct rpl_stats {
   uint16_t loop_errors;
   uint16_t loop_warnings;
   uint16_t root_repairs;
+#if RPL_WITH_PARENT_HEAP
+  uint16_t parent_switch_held;
+#endif /* RPL_WITH_PARENT_HEAP */
+#if RPL_DAO_QUEUE_SIZE
+  uint16_t dao_queue_drops;
+  uint16_t dao_queue_merged;
+  uint16_t dao_queue_max;
+#endif /* RPL_DAO_QUEUE_SIZE */
 };
 typedef struct rpl_stats rpl_stats_t;
 
@@ -351,6 +359,9 @@ void dao_output(rpl_parent_t *, uint8_t lifetime);
 void dao_output_target(rpl_parent_t *, uip_ipaddr_t *, uint8_t lifetime);
 void dao_ack_output(rpl_instance_t *, uip_ipaddr_t *, uint8_t, uint8_t);
 void rpl_icmp6_register_handlers(void);
+#if RPL_DAO_QUEUE_SIZE
+int rpl_icmp6_dao_queue_length(void);
+#endif /* RPL_DAO_QUEUE_SIZE */
 uip_ds6_nbr_t *rpl_icmp6_update_nbr_table(uip_ipaddr_t *from,
                                           nbr_table_reason_t r, void *data);
 
@@ -378,6 +389,9 @@ void rpl_move_parent(rpl_dag_t *dag_src, rpl_dag_t *dag_dst, rpl_parent_t *paren
 rpl_parent_t *rpl_select_parent(rpl_dag_t *dag);
 rpl_dag_t *rpl_select_dag(rpl_instance_t *instance,rpl_parent_t *parent);
 void rpl_recalculate_ranks(void);
+#if RPL_WITH_PARENT_HEAP
+void rpl_parent_heap_update(rpl_parent_t *p);
+#endif /* RPL_WITH_PARENT_HEAP */
 
 /* RPL routing table functions. */
 void rpl_remove_routes(rpl_dag_t *dag);
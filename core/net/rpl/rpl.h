@@ -111,6 +111,15 @@ struct rpl_dag;
 #define RPL_PARENT_FLAG_UPDATED           0x1
 #define RPL_PARENT_FLAG_LINK_METRIC_VALID 0x2
 
+#if RPL_WITH_PARENT_HEAP
+/* Large enough for a position in a heap of every neighbor, plus one */
+#if NBR_TABLE_MAX_NEIGHBORS < 255
+typedef uint8_t rpl_heap_index_t;
+#else
+typedef uint16_t rpl_heap_index_t;
+#endif /* NBR_TABLE_MAX_NEIGHBORS < 255 */
+#endif /* RPL_WITH_PARENT_HEAP */
+
 struct rpl_parent {
   struct rpl_dag *dag;
 #if RPL_WITH_MC
@@ -119,6 +128,12 @@ struct rpl_parent {
   rpl_rank_t rank;
   uint8_t dtsn;
   uint8_t flags;
+#if RPL_WITH_PARENT_HEAP
+  /* Path cost via this parent when it was last placed in the heap */
+  rpl_rank_t heap_key;
+  /* Position in the heap of the DAG plus one, zero if not in it */
+  rpl_heap_index_t heap_index;
+#endif /* RPL_WITH_PARENT_HEAP */
 };
 typedef struct rpl_parent rpl_parent_t;
 /*---------------------------------------------------------------------------*/
@@ -146,6 +161,11 @@ struct rpl_dag {
   struct rpl_instance *instance;
   rpl_prefix_t prefix_info;
   uint32_t lifetime;
+#if RPL_WITH_PARENT_HEAP
+  /* Candidate parents, with the lowest rank via parent first */
+  rpl_parent_t *parent_heap[NBR_TABLE_MAX_NEIGHBORS];
+  rpl_heap_index_t parent_heap_len;
+#endif /* RPL_WITH_PARENT_HEAP */
 };
 typedef struct rpl_dag rpl_dag_t;
 typedef struct rpl_instance rpl_instance_t;
@@ -44,11 +44,334 @@
  * Adam Dunkels <adam@sics.se>
  */
 
+#include <string.h>
+
 #include "contiki-conf.h"
 
 #include "sys/etimer.h"
 #include "sys/process.h"
 
+#if ETIMER_WHEEL
+
+#if ETIMER_WHEEL_BITS > 5
+#error "ETIMER_WHEEL_BITS must not be larger than 5"
+#endif
+
+#define WHEEL_SLOTS       (1 << ETIMER_WHEEL_BITS)
+#define WHEEL_MASK        (WHEEL_SLOTS - 1)
+#define NUM_SLOTS         (WHEEL_SLOTS * ETIMER_WHEEL_LEVELS)
+#define LEVEL_SHIFT(l)    ((l) * ETIMER_WHEEL_BITS)
+/* Number of ticks covered by one slot of level l */
+#define SLOT_TICKS(l)     ((unsigned long)1 << LEVEL_SHIFT(l))
+#define WHEEL_SPAN        SLOT_TICKS(ETIMER_WHEEL_LEVELS)
+#define SLOT_ID(l, i)     ((l) * WHEEL_SLOTS + (i))
+#define NO_WORK           ((unsigned long)-1)
+
+#if NUM_SLOTS > 255
+#error "Too many etimer wheel slots"
+#endif
+
+/* One list of timers per slot, and one bitmap of non-empty slots
+   per level. */
+static struct etimer *slots[NUM_SLOTS];
+static uint32_t occupied[ETIMER_WHEEL_LEVELS];
+
+/* The last tick that the wheel has been advanced to. All timers
+   that expire at this tick have been processed, except for timers
+   that were added later; these are found when the tick is processed
+   again. */
+static clock_time_t wheel_time;
+
+static clock_time_t next_expiration;
+static uint8_t next_expiration_valid;
+
+PROCESS(etimer_process, "Event timer");
+/*---------------------------------------------------------------------------*/
+static uint8_t
+slot_index(uint8_t level, clock_time_t time)
+{
+  return ((unsigned long)time >> LEVEL_SHIFT(level)) & WHEEL_MASK;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+first_occupied(uint8_t level, uint8_t from)
+{
+  uint8_t n;
+
+  /* Distance, in slots, from slot "from" to the first non-empty slot
+     of the level, wrapping around. The level must not be empty. */
+  for(n = 0; !(occupied[level] & ((uint32_t)1 << ((from + n) & WHEEL_MASK)));
+      n++);
+  return n;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_insert(struct etimer *t)
+{
+  clock_time_t now;
+  unsigned long diff;
+  uint8_t level;
+  uint8_t index;
+
+  now = clock_time();
+  if(timer_expired(&t->timer)) {
+    /* Due timers go to the slot of the current tick. */
+    diff = 0;
+  } else {
+    diff = (clock_time_t)(now - wheel_time) +
+      (unsigned long)(clock_time_t)(t->timer.start + t->timer.interval - now);
+  }
+
+  for(level = 0; level < ETIMER_WHEEL_LEVELS - 1; level++) {
+    if(diff < SLOT_TICKS(level + 1)) {
+      break;
+    }
+  }
+  if(diff >= WHEEL_SPAN) {
+    /* Too far ahead: park the timer in the slot that the top level
+       reaches last. */
+    index = slot_index(level, wheel_time);
+  } else {
+    index = slot_index(level, wheel_time + diff);
+  }
+
+  t->slot = SLOT_ID(level, index);
+  t->next = slots[t->slot];
+  slots[t->slot] = t;
+  occupied[level] |= (uint32_t)1 << index;
+  next_expiration_valid = 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+wheel_remove(struct etimer *et)
+{
+  struct etimer **tp;
+
+  if(et->slot >= NUM_SLOTS) {
+    return 0;
+  }
+
+  /* Only unlink the timer if it is actually on the list of its slot,
+     as timers that have never been set hold no valid slot. */
+  for(tp = &slots[et->slot]; *tp != NULL; tp = &(*tp)->next) {
+    if(*tp == et) {
+      *tp = et->next;
+      if(slots[et->slot] == NULL) {
+        occupied[et->slot / WHEEL_SLOTS] &=
+          ~((uint32_t)1 << (et->slot & WHEEL_MASK));
+      }
+      et->next = NULL;
+      next_expiration_valid = 0;
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned long
+ticks_to_next_work(clock_time_t t)
+{
+  unsigned long dist;
+  unsigned long min_dist;
+  unsigned long offset;
+  uint8_t level;
+  uint8_t from;
+  uint8_t n;
+
+  /* Number of ticks from tick t (which has not been processed yet) to
+     the first tick at which a slot has to be cascaded or a timer
+     expires. */
+  min_dist = NO_WORK;
+  for(level = 0; level < ETIMER_WHEEL_LEVELS; level++) {
+    if(occupied[level] == 0) {
+      continue;
+    }
+    offset = (unsigned long)t & (SLOT_TICKS(level) - 1);
+    /* Unless t is at the start of a slot of this level, the slot of t
+       has already been cascaded and only holds timers for the next
+       round of the wheel. */
+    from = slot_index(level, t) + (offset != 0);
+    n = first_occupied(level, from) + (offset != 0);
+    dist = n * SLOT_TICKS(level) - offset;
+    if(dist < min_dist) {
+      min_dist = dist;
+    }
+  }
+  return min_dist;
+}
+/*---------------------------------------------------------------------------*/
+static void
+cascade(uint8_t level)
+{
+  struct etimer *t, *next;
+  uint8_t index;
+
+  index = slot_index(level, wheel_time);
+  t = slots[SLOT_ID(level, index)];
+  slots[SLOT_ID(level, index)] = NULL;
+  occupied[level] &= ~((uint32_t)1 << index);
+
+  /* Place the timers again, now that they are closer to expiring.
+     They end up on a lower level, or on the top level again if they
+     are still further ahead than the wheel spans. */
+  for(; t != NULL; t = next) {
+    next = t->next;
+    wheel_insert(t);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+process_tick(void)
+{
+  struct etimer *t;
+  uint8_t level;
+  uint8_t slot;
+
+  /* At slot boundaries, move the timers of the upper levels' slots
+     down, starting with the highest level. */
+  for(level = ETIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+    if(((unsigned long)wheel_time & (SLOT_TICKS(level) - 1)) == 0) {
+      cascade(level);
+    }
+  }
+
+  slot = SLOT_ID(0, slot_index(0, wheel_time));
+  while((t = slots[slot]) != NULL) {
+    if(!timer_expired(&t->timer)) {
+      /* The timer was changed after it was placed. */
+      wheel_remove(t);
+      wheel_insert(t);
+      continue;
+    }
+    if(process_post(t->p, PROCESS_EVENT_TIMER, t) != PROCESS_ERR_OK) {
+      return 0;
+    }
+    /* Reset the process ID of the event timer, to signal that the
+       etimer has expired. This is later checked in the
+       etimer_expired() function. */
+    wheel_remove(t);
+    t->p = PROCESS_NONE;
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+update_time(void)
+{
+  struct etimer *t;
+  clock_time_t now;
+  clock_time_t remaining;
+  unsigned long tdist;
+  unsigned long lag;
+  unsigned long bound;
+  unsigned long offset;
+  uint8_t level;
+  uint8_t index;
+  uint8_t n;
+  uint8_t found;
+
+  now = clock_time();
+  lag = (clock_time_t)(now - wheel_time);
+  found = 0;
+  tdist = 0;
+  for(level = 0; level < ETIMER_WHEEL_LEVELS; level++) {
+    if(occupied[level] == 0) {
+      continue;
+    }
+    /* Visit the slots of the level in the order in which the wheel
+       reaches them. No timer in a slot expires before the slot is
+       reached, so we can stop as soon as that happens after the
+       earliest expiration found so far. This usually happens after
+       the first non-empty slot; only timers that have been parked on
+       the top level can be out of order. */
+    offset = (unsigned long)wheel_time & (SLOT_TICKS(level) - 1);
+    for(n = (level != 0); n < WHEEL_SLOTS + (level != 0); n++) {
+      index = (slot_index(level, wheel_time) + n) & WHEEL_MASK;
+      if(!(occupied[level] & ((uint32_t)1 << index))) {
+        continue;
+      }
+      bound = n * SLOT_TICKS(level) - offset;
+      bound = bound > lag ? bound - lag : 0;
+      if(found && bound >= tdist) {
+        break;
+      }
+      for(t = slots[SLOT_ID(level, index)]; t != NULL; t = t->next) {
+        if(timer_expired(&t->timer)) {
+          remaining = 0;
+        } else {
+          remaining = t->timer.start + t->timer.interval - now;
+        }
+        if(!found || remaining < tdist) {
+          tdist = remaining;
+          found = 1;
+        }
+      }
+    }
+  }
+  next_expiration = now + tdist;
+  next_expiration_valid = 1;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_process, ev, data)
+{
+  struct etimer **tp;
+  clock_time_t now;
+  unsigned long dist;
+  int i;
+
+  PROCESS_BEGIN();
+
+  memset(slots, 0, sizeof(slots));
+  memset(occupied, 0, sizeof(occupied));
+  wheel_time = clock_time();
+  next_expiration_valid = 0;
+
+  while(1) {
+    PROCESS_YIELD();
+
+    if(ev == PROCESS_EVENT_EXITED) {
+      struct process *p = data;
+
+      for(i = 0; i < NUM_SLOTS; i++) {
+        for(tp = &slots[i]; *tp != NULL;) {
+          if((*tp)->p == p) {
+            wheel_remove(*tp);
+          } else {
+            tp = &(*tp)->next;
+          }
+        }
+      }
+      continue;
+    } else if(ev != PROCESS_EVENT_POLL) {
+      continue;
+    }
+
+    /* Advance the wheel to the current time, skipping over ticks at
+       which there is nothing to do. */
+    now = clock_time();
+    while(1) {
+      if(!process_tick()) {
+        /* The event queue is full, try again later. */
+        etimer_request_poll();
+        break;
+      }
+      if(wheel_time == now) {
+        break;
+      }
+      dist = ticks_to_next_work(wheel_time + 1);
+      if(dist >= (clock_time_t)(now - wheel_time)) {
+        wheel_time = now;
+        break;
+      }
+      wheel_time += 1 + dist;
+    }
+  }
+
+  PROCESS_END();
+}
+
+#else /* ETIMER_WHEEL */
+
 static struct etimer *timerlist;
 static clock_time_t next_expiration;
 
@@ -140,12 +463,29 @@ PROCESS_THREAD(etimer_process, ev, data)
   
   PROCESS_END();
 }
+#endif /* ETIMER_WHEEL */
 /*---------------------------------------------------------------------------*/
 void
 etimer_request_poll(void)
 {
   process_poll(&etimer_process);
 }
+#if ETIMER_WHEEL
+/*---------------------------------------------------------------------------*/
+static void
+add_timer(struct etimer *timer)
+{
+  etimer_request_poll();
+
+  if(timer->p != PROCESS_NONE) {
+    /* The timer may already be on the wheel. */
+    wheel_remove(timer);
+  }
+
+  timer->p = PROCESS_CURRENT();
+  wheel_insert(timer);
+}
+#else /* ETIMER_WHEEL */
 /*---------------------------------------------------------------------------*/
 static void
 add_timer(struct etimer *timer)
@@ -172,6 +512,7 @@ add_timer(struct etimer *timer)
 
   update_time();
 }
+#endif /* ETIMER_WHEEL */
 /*---------------------------------------------------------------------------*/
 void
 etimer_set(struct etimer *et, clock_time_t interval)
@@ -206,7 +547,13 @@ void
 etimer_adjust(struct etimer *et, int timediff)
 {
   et->timer.start += timediff;
+#if ETIMER_WHEEL
+  if(et->p != PROCESS_NONE && wheel_remove(et)) {
+    wheel_insert(et);
+  }
+#else /* ETIMER_WHEEL */
   update_time();
+#endif /* ETIMER_WHEEL */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -227,6 +574,43 @@ etimer_start_time(struct etimer *et)
   return et->timer.start;
 }
 /*---------------------------------------------------------------------------*/
+#if ETIMER_WHEEL
+int
+etimer_pending(void)
+{
+  uint8_t level;
+
+  for(level = 0; level < ETIMER_WHEEL_LEVELS; level++) {
+    if(occupied[level] != 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
+etimer_next_expiration_time(void)
+{
+  if(!etimer_pending()) {
+    return 0;
+  }
+  if(!next_expiration_valid) {
+    update_time();
+  }
+  return next_expiration;
+}
+/*---------------------------------------------------------------------------*/
+void
+etimer_stop(struct etimer *et)
+{
+  wheel_remove(et);
+
+  /* Remove the next pointer from the item to be removed. */
+  et->next = NULL;
+  /* Set the timer as expired */
+  et->p = PROCESS_NONE;
+}
+#else /* ETIMER_WHEEL */
 int
 etimer_pending(void)
 {
@@ -268,5 +652,6 @@ etimer_stop(struct etimer *et)
   /* Set the timer as expired */
   et->p = PROCESS_NONE;
 }
+#endif /* ETIMER_WHEEL */
 /*---------------------------------------------------------------------------*/
 /** @} */
@@ -62,9 +62,50 @@
 #ifndef ETIMER_H_
 #define ETIMER_H_
 
+#include "contiki-conf.h"
 #include "sys/timer.h"
 #include "sys/process.h"
 
+/**
+ * \brief Enables the timing wheel backend
+ *
+ * By default, all pending event timers are kept on a single unsorted
+ * list that is traversed on every timer insertion and expiration. With
+ * this option set, pending timers are instead kept in a hierarchical
+ * timing wheel of ETIMER_WHEEL_LEVELS levels with 2^ETIMER_WHEEL_BITS
+ * slots each. Setting a timer then takes constant time, expiring
+ * timers takes amortized constant time, and finding the next
+ * expiration time only looks at the first occupied slot of each
+ * level. Callback timers, which are built on event timers, use the
+ * same backend.
+ *
+ * ETIMER_WHEEL_BITS * ETIMER_WHEEL_LEVELS must not be larger than the
+ * width of clock_time_t. Timers that expire further ahead than the
+ * wheel spans are parked in the last slot of the top level and are
+ * placed again when the wheel reaches them.
+ *
+ * To enable, define ETIMER_CONF_WHEEL to 1 in contiki-conf.h
+ */
+#ifdef ETIMER_CONF_WHEEL
+#define ETIMER_WHEEL ETIMER_CONF_WHEEL
+#else /* ETIMER_CONF_WHEEL */
+#define ETIMER_WHEEL 0
+#endif /* ETIMER_CONF_WHEEL */
+
+/** Number of slots per level of the timing wheel, as a power of two (max 5) */
+#ifdef ETIMER_CONF_WHEEL_BITS
+#define ETIMER_WHEEL_BITS ETIMER_CONF_WHEEL_BITS
+#else /* ETIMER_CONF_WHEEL_BITS */
+#define ETIMER_WHEEL_BITS 4
+#endif /* ETIMER_CONF_WHEEL_BITS */
+
+/** Number of levels of the timing wheel */
+#ifdef ETIMER_CONF_WHEEL_LEVELS
+#define ETIMER_WHEEL_LEVELS ETIMER_CONF_WHEEL_LEVELS
+#else /* ETIMER_CONF_WHEEL_LEVELS */
+#define ETIMER_WHEEL_LEVELS 4
+#endif /* ETIMER_CONF_WHEEL_LEVELS */
+
 /**
  * A timer.
  *
@@ -77,6 +118,9 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if ETIMER_WHEEL
+  uint8_t slot;
+#endif /* ETIMER_WHEEL */
 };
 
 /**
@@ -44,6 +44,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "sys/process.h"
 #include "sys/arg.h"
@@ -63,13 +64,45 @@ struct event_data {
   process_event_t ev;
   process_data_t data;
   struct process *p;
+#if PROCESS_PRIORITIES > 1
+  process_num_events_t next;
+#endif /* PROCESS_PRIORITIES > 1 */
 };
 
+#if PROCESS_PRIORITIES > 1
+
+#if (PROCESS_PRIORITIES - 1) * PROCESS_RESERVED_EVENTS >= PROCESS_CONF_NUMEVENTS
+#error "PROCESS_CONF_NUMEVENTS too small for the reserved events of all priorities"
+#endif
+
+/* Marks the end of an event list */
+#define EVENT_NONE PROCESS_CONF_NUMEVENTS
+
+#define EVENT_PRIORITY(p) \
+  ((p) == PROCESS_BROADCAST ? PROCESS_PRIORITY_NORMAL : (p)->priority)
+
+/*
+ * The event slots are shared by all priority levels. Each level has
+ * its own FIFO list of events, and unused slots are kept on a free
+ * list.
+ */
+struct event_queue {
+  process_num_events_t first, last, n;
+};
+
+static process_num_events_t nevents, free_events;
+static struct event_data events[PROCESS_CONF_NUMEVENTS];
+static struct event_queue queues[PROCESS_PRIORITIES];
+#else /* PROCESS_PRIORITIES > 1 */
+#define EVENT_PRIORITY(p) 0
+
 static process_num_events_t nevents, fevent;
 static struct event_data events[PROCESS_CONF_NUMEVENTS];
+#endif /* PROCESS_PRIORITIES > 1 */
 
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
+struct process_stats process_stats;
 #endif
 
 static volatile unsigned char poll_requested;
@@ -198,6 +231,14 @@ call_process(struct process *p, process_event_t ev, process_data_t data)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_PRIORITIES > 1
+void
+process_set_priority(struct process *p, unsigned char priority)
+{
+  p->priority = priority < PROCESS_PRIORITIES ? priority : PROCESS_PRIORITY_HIGH;
+}
+#endif /* PROCESS_PRIORITIES > 1 */
+/*---------------------------------------------------------------------------*/
 void
 process_exit(struct process *p)
 {
@@ -207,11 +248,28 @@ process_exit(struct process *p)
 void
 process_init(void)
 {
+#if PROCESS_PRIORITIES > 1
+  process_num_events_t i;
+#endif /* PROCESS_PRIORITIES > 1 */
+
   lastevent = PROCESS_EVENT_MAX;
 
+#if PROCESS_PRIORITIES > 1
+  nevents = 0;
+  for(i = 0; i < PROCESS_CONF_NUMEVENTS; i++) {
+    events[i].next = i + 1;
+  }
+  free_events = 0;
+  for(i = 0; i < PROCESS_PRIORITIES; i++) {
+    queues[i].first = queues[i].last = EVENT_NONE;
+    queues[i].n = 0;
+  }
+#else /* PROCESS_PRIORITIES > 1 */
   nevents = fevent = 0;
+#endif /* PROCESS_PRIORITIES > 1 */
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
+  memset(&process_stats, 0, sizeof(process_stats));
 #endif /* PROCESS_CONF_STATS */
 
   process_current = process_list = NULL;
@@ -260,6 +318,26 @@ do_event(void)
 
   if(nevents > 0) {
     
+#if PROCESS_PRIORITIES > 1
+    process_num_events_t e;
+    struct event_queue *q;
+
+    /* Take the first event of the highest priority level that has
+       events queued, and put its slot back on the free list. */
+    for(q = &queues[PROCESS_PRIORITIES - 1]; q->n == 0; q--);
+    e = q->first;
+    ev = events[e].ev;
+    data = events[e].data;
+    receiver = events[e].p;
+
+    q->first = events[e].next;
+    if(--q->n == 0) {
+      q->last = EVENT_NONE;
+    }
+    events[e].next = free_events;
+    free_events = e;
+    --nevents;
+#else /* PROCESS_PRIORITIES > 1 */
     /* There are events that we should deliver. */
     ev = events[fevent].ev;
     
@@ -270,6 +348,7 @@ do_event(void)
        and decrease the number of events. */
     fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
     --nevents;
+#endif /* PROCESS_PRIORITIES > 1 */
 
     /* If this is a broadcast event, we deliver it to all events, in
        order of their priority. */
@@ -318,10 +397,35 @@ process_nevents(void)
   return nevents + poll_requested;
 }
 /*---------------------------------------------------------------------------*/
+#if PROCESS_COALESCE_EVENTS
+static int
+is_queued(struct process *p, process_event_t ev, process_data_t data)
+{
+  process_num_events_t i;
+  struct event_data *e;
+
+#if PROCESS_PRIORITIES > 1
+  for(i = queues[EVENT_PRIORITY(p)].first; i != EVENT_NONE; i = e->next) {
+    e = &events[i];
+#else /* PROCESS_PRIORITIES > 1 */
+  for(i = 0; i < nevents; i++) {
+    e = &events[(process_num_events_t)(fevent + i) % PROCESS_CONF_NUMEVENTS];
+#endif /* PROCESS_PRIORITIES > 1 */
+    if(e->p == p && e->ev == ev && e->data == data) {
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif /* PROCESS_COALESCE_EVENTS */
+/*---------------------------------------------------------------------------*/
 int
 process_post(struct process *p, process_event_t ev, process_data_t data)
 {
   process_num_events_t snum;
+#if PROCESS_PRIORITIES > 1
+  struct event_queue *q = &queues[EVENT_PRIORITY(p)];
+#endif /* PROCESS_PRIORITIES > 1 */
 
   if(PROCESS_CURRENT() == NULL) {
     PRINTF("process_post: NULL process posts event %d to process '%s', nevents %d\n",
@@ -331,8 +435,25 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
 	   PROCESS_NAME_STRING(PROCESS_CURRENT()), ev,
 	   p == PROCESS_BROADCAST? "<broadcast>": PROCESS_NAME_STRING(p), nevents);
   }
+
+#if PROCESS_COALESCE_EVENTS
+  /* If the same event is already waiting to be delivered, there is
+     no need to queue it again. */
+  if(is_queued(p, ev, data)) {
+#if PROCESS_CONF_STATS
+    process_stats.coalesced++;
+#endif /* PROCESS_CONF_STATS */
+    return PROCESS_ERR_OK;
+  }
+#endif /* PROCESS_COALESCE_EVENTS */
   
+#if PROCESS_PRIORITIES > 1
+  /* Leave the slots that are reserved for higher levels free. */
+  if(PROCESS_CONF_NUMEVENTS - nevents <=
+     (PROCESS_PRIORITIES - 1 - EVENT_PRIORITY(p)) * PROCESS_RESERVED_EVENTS) {
+#else /* PROCESS_PRIORITIES > 1 */
   if(nevents == PROCESS_CONF_NUMEVENTS) {
+#endif /* PROCESS_PRIORITIES > 1 */
 #if DEBUG
     if(p == PROCESS_BROADCAST) {
       printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
@@ -340,10 +461,26 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
       printf("soft panic: event queue is full when event %d was posted to %s from %s\n", ev, PROCESS_NAME_STRING(p), PROCESS_NAME_STRING(process_current));
     }
 #endif /* DEBUG */
+#if PROCESS_CONF_STATS
+    process_stats.dropped[EVENT_PRIORITY(p)]++;
+#endif /* PROCESS_CONF_STATS */
     return PROCESS_ERR_FULL;
   }
   
+#if PROCESS_PRIORITIES > 1
+  snum = free_events;
+  free_events = events[snum].next;
+  events[snum].next = EVENT_NONE;
+  if(q->n == 0) {
+    q->first = snum;
+  } else {
+    events[q->last].next = snum;
+  }
+  q->last = snum;
+  ++q->n;
+#else /* PROCESS_PRIORITIES > 1 */
   snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
+#endif /* PROCESS_PRIORITIES > 1 */
   events[snum].ev = ev;
   events[snum].data = data;
   events[snum].p = p;
@@ -353,6 +490,13 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
   if(nevents > process_maxevents) {
     process_maxevents = nevents;
   }
+#if PROCESS_PRIORITIES > 1
+  if(q->n > process_stats.maxevents[EVENT_PRIORITY(p)]) {
+    process_stats.maxevents[EVENT_PRIORITY(p)] = q->n;
+  }
+#else /* PROCESS_PRIORITIES > 1 */
+  process_stats.maxevents[0] = process_maxevents;
+#endif /* PROCESS_PRIORITIES > 1 */
 #endif /* PROCESS_CONF_STATS */
   
   return PROCESS_ERR_OK;
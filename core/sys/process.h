@@ -88,6 +88,50 @@ typedef unsigned char process_num_events_t;
 #define PROCESS_CONF_NUMEVENTS 32
 #endif /* PROCESS_CONF_NUMEVENTS */
 
+/**
+ * \brief Number of event priority levels
+ *
+ * With more than one level, events are queued per priority level and
+ * the scheduler always delivers the oldest event of the highest
+ * non-empty level first. The priority of an event is the priority of
+ * the process it is posted to, see process_set_priority(); broadcast
+ * events have the lowest priority. All levels share the
+ * PROCESS_CONF_NUMEVENTS event slots, but the last
+ * PROCESS_RESERVED_EVENTS slots per level above it can only be used
+ * by events of higher levels, so that a busy low-priority process
+ * cannot make process_post() fail for high-priority ones.
+ *
+ * To enable, define PROCESS_CONF_PRIORITIES in contiki-conf.h
+ */
+#ifdef PROCESS_CONF_PRIORITIES
+#define PROCESS_PRIORITIES PROCESS_CONF_PRIORITIES
+#else /* PROCESS_CONF_PRIORITIES */
+#define PROCESS_PRIORITIES 1
+#endif /* PROCESS_CONF_PRIORITIES */
+
+/** Number of event slots reserved for each priority level above the lowest */
+#ifdef PROCESS_CONF_RESERVED_EVENTS
+#define PROCESS_RESERVED_EVENTS PROCESS_CONF_RESERVED_EVENTS
+#else /* PROCESS_CONF_RESERVED_EVENTS */
+#define PROCESS_RESERVED_EVENTS 4
+#endif /* PROCESS_CONF_RESERVED_EVENTS */
+
+/**
+ * \brief Coalesce duplicate events
+ *
+ * When set, posting an event that is already queued for the same
+ * process with the same data does not queue it a second time. The
+ * receiving process will then see the event once.
+ */
+#ifdef PROCESS_CONF_COALESCE_EVENTS
+#define PROCESS_COALESCE_EVENTS PROCESS_CONF_COALESCE_EVENTS
+#else /* PROCESS_CONF_COALESCE_EVENTS */
+#define PROCESS_COALESCE_EVENTS 0
+#endif /* PROCESS_CONF_COALESCE_EVENTS */
+
+#define PROCESS_PRIORITY_NORMAL 0
+#define PROCESS_PRIORITY_HIGH   (PROCESS_PRIORITIES - 1)
+
 #define PROCESS_EVENT_NONE            0x80
 #define PROCESS_EVENT_INIT            0x81
 #define PROCESS_EVENT_POLL            0x82
@@ -323,6 +367,9 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if PROCESS_PRIORITIES > 1
+  unsigned char priority;
+#endif /* PROCESS_PRIORITIES > 1 */
 };
 
 /**
@@ -377,6 +424,21 @@ CCIF int process_post(struct process *p, process_event_t ev, process_data_t data
 CCIF void process_post_synch(struct process *p,
 			     process_event_t ev, process_data_t data);
 
+#if PROCESS_PRIORITIES > 1
+/**
+ * \brief      Set the priority of a process
+ * \param p    The process
+ * \param priority The priority, from PROCESS_PRIORITY_NORMAL (the
+ *             default) to PROCESS_PRIORITY_HIGH
+ *
+ *             Events that are posted to the process after this call
+ *             are queued with the new priority.
+ */
+CCIF void process_set_priority(struct process *p, unsigned char priority);
+#else /* PROCESS_PRIORITIES > 1 */
+#define process_set_priority(p, priority)
+#endif /* PROCESS_PRIORITIES > 1 */
+
 /**
  * \brief      Cause a process to exit
  * \param p    The process that is to be exited
@@ -519,6 +581,22 @@ CCIF int process_is_running(struct process *p);
  */
 int process_nevents(void);
 
+#if PROCESS_CONF_STATS
+/**
+ * Event queue statistics, updated when PROCESS_CONF_STATS is set.
+ */
+struct process_stats {
+  /** Highest number of queued events, per priority level */
+  process_num_events_t maxevents[PROCESS_PRIORITIES];
+  /** Events that could not be posted, per priority level */
+  unsigned short dropped[PROCESS_PRIORITIES];
+  /** Events that were coalesced with an already queued event */
+  unsigned short coalesced;
+};
+
+extern struct process_stats process_stats;
+#endif /* PROCESS_CONF_STATS */
+
 /** @} */
 
 CCIF extern struct process *process_list;
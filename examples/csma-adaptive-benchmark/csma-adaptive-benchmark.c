@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Native benchmark of the adaptive retransmission budget of
+ *         CSMA. The sender keeps a few packets queued for each of two
+ *         neighbors, and sends a packet every PERIOD to a third one.
+ *         The packets that they acknowledge in a fixed time are
+ *         counted. The radio takes a fixed airtime per frame and the
+ *         channel is always clear. The first two neighbors acknowledge
+ *         every frame, the last one loses LOSS percent of them.
+ *
+ *         Build with "make ADAPTIVE=1" to enable CSMA_CONF_ADAPTIVE,
+ *         with MIN_BE=<n> to set macMinBE (3 by default) and with
+ *         LOSS=<n> to set the loss rate of the last neighbor (90 by
+ *         default). Run "make TARGET=native clean" when changing them.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "dev/radio.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DURATION        (10 * CLOCK_SECOND)
+#define FRAME_AIRTIME   (5 * CLOCK_SECOND / 1000)
+#define PAYLOAD_LEN     100
+#define NUM_NEIGHBORS   3
+#define WINDOW          2
+#define PERIOD          (CLOCK_SECOND / 10)
+
+static struct {
+  linkaddr_t addr;
+  unsigned long transmissions;
+  unsigned long acked;
+  int to_queue;
+} neighbors[NUM_NEIGHBORS];
+
+PROCESS(csma_adaptive_benchmark_process, "CSMA adaptive benchmark");
+AUTOSTART_PROCESSES(&csma_adaptive_benchmark_process);
+
+/*---------------------------------------------------------------------------*/
+/* A radio that takes the airtime of each frame, always finds the
+   channel clear, and loses frames to the last neighbor */
+static int
+init(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+prepare(const void *payload, unsigned short payload_len)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+transmit(unsigned short transmit_len)
+{
+  return RADIO_TX_ERR;
+}
+/*---------------------------------------------------------------------------*/
+static int
+send(const void *payload, unsigned short payload_len)
+{
+  clock_time_t start;
+  int i;
+
+  start = clock_time();
+  while(clock_time() - start < FRAME_AIRTIME);
+
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    if(linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &neighbors[i].addr)) {
+      neighbors[i].transmissions++;
+      if(i == NUM_NEIGHBORS - 1 && random_rand() % 100 < BENCHMARK_LOSS) {
+        return RADIO_TX_NOACK;
+      }
+    }
+  }
+  return RADIO_TX_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+read(void *buf, unsigned short buf_len)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+channel_clear(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+receiving_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+pending_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_value(radio_param_t param, radio_value_t *value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_value(radio_param_t param, radio_value_t value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_object(radio_param_t param, void *dest, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_object(radio_param_t param, const void *src, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+const struct radio_driver benchmark_radio_driver = {
+  init,
+  prepare,
+  transmit,
+  send,
+  read,
+  channel_clear,
+  receiving_packet,
+  pending_packet,
+  on,
+  off,
+  get_value,
+  set_value,
+  get_object,
+  set_object
+};
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int num_transmissions)
+{
+  int i = (int)(uintptr_t)ptr;
+
+  if(status == MAC_TX_OK) {
+    neighbors[i].acked++;
+  }
+  if(i < NUM_NEIGHBORS - 1) {
+    /* Queue a new packet. The poll events of several callbacks are
+       merged, so count them. */
+    neighbors[i].to_queue++;
+    process_poll(&csma_adaptive_benchmark_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+queue_packet(int i)
+{
+  static uint8_t payload[PAYLOAD_LEN];
+
+  packetbuf_clear();
+  packetbuf_copyfrom(payload, sizeof(payload));
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &neighbors[i].addr);
+  NETSTACK_MAC.send(packet_sent, (void *)(uintptr_t)i);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(csma_adaptive_benchmark_process, ev, data)
+{
+  static struct etimer et;
+  static struct etimer period;
+  static clock_time_t start;
+  unsigned long acked;
+  int i, j;
+
+  PROCESS_BEGIN();
+
+  /* Let the network stack settle */
+  PROCESS_PAUSE();
+
+  printf("CSMA adaptive benchmark: adaptive %u, macMinBE %u, %u%% loss to the last neighbor, %u-byte packets, %u ms airtime\n",
+         CSMA_CONF_ADAPTIVE, CSMA_CONF_MIN_BE, BENCHMARK_LOSS, PAYLOAD_LEN,
+         (unsigned)(FRAME_AIRTIME * 1000 / CLOCK_SECOND));
+
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    memset(&neighbors[i].addr, 0, sizeof(linkaddr_t));
+    neighbors[i].addr.u8[LINKADDR_SIZE - 1] = 0x0a + i;
+  }
+
+  start = clock_time();
+  etimer_set(&et, DURATION);
+
+  etimer_set(&period, PERIOD);
+
+  for(i = 0; i < NUM_NEIGHBORS - 1; i++) {
+    for(j = 0; j < WINDOW; j++) {
+      queue_packet(i);
+    }
+  }
+  while(!etimer_expired(&et)) {
+    PROCESS_WAIT_EVENT();
+    if(etimer_expired(&period)) {
+      etimer_reset(&period);
+      queue_packet(NUM_NEIGHBORS - 1);
+    }
+    for(i = 0; i < NUM_NEIGHBORS - 1; i++) {
+      /* A packet that cannot be queued is reported at once, and
+         counted again */
+      j = neighbors[i].to_queue;
+      neighbors[i].to_queue = 0;
+      while(j-- > 0) {
+        queue_packet(i);
+      }
+    }
+  }
+
+  acked = 0;
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    printf("neighbor %u: %lu packets acknowledged, %lu transmissions\n",
+           i, neighbors[i].acked, neighbors[i].transmissions);
+    acked += neighbors[i].acked;
+  }
+  printf("%lu packets acknowledged in %lu ms\n",
+         acked, (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND);
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Native benchmark of frame bursting in CSMA and nullrdc. The
+ *         sender keeps a few packets queued for one neighbor, queuing a
+ *         new one each time the MAC layer reports a packet as sent, and
+ *         the frames that the radio sends in a fixed time are counted.
+ *         The radio takes a fixed airtime per frame and the channel is
+ *         always clear.
+ *
+ *         Build with "make BURST=1" to enable CSMA_CONF_BURST and
+ *         NULLRDC_CONF_BURST, with MIN_BE=<n> to set macMinBE (3 by
+ *         default) and with WINDOW=<n> to set the number of queued
+ *         packets (4 by default). Run "make TARGET=native clean" when
+ *         changing them.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/mac.h"
+#include "dev/radio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DURATION        (3 * CLOCK_SECOND)
+#define FRAME_AIRTIME   (5 * CLOCK_SECOND / 1000)
+#define PAYLOAD_LEN     100
+
+static unsigned long frames_sent;
+static unsigned long frames_pending;
+static unsigned long packets_sent;
+static int to_queue;
+
+PROCESS(csma_burst_benchmark_process, "CSMA burst benchmark");
+AUTOSTART_PROCESSES(&csma_burst_benchmark_process);
+
+/*---------------------------------------------------------------------------*/
+/* A radio that takes the airtime of each frame and always finds the
+   channel clear */
+static void
+airtime(const void *payload)
+{
+  clock_time_t start;
+
+  frames_sent++;
+  /* The frame pending bit of the frame control field */
+  if(((const uint8_t *)payload)[0] & 0x10) {
+    frames_pending++;
+  }
+  start = clock_time();
+  while(clock_time() - start < FRAME_AIRTIME);
+}
+/*---------------------------------------------------------------------------*/
+static const void *prepared;
+
+static int
+init(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+prepare(const void *payload, unsigned short payload_len)
+{
+  prepared = payload;
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+transmit(unsigned short transmit_len)
+{
+  airtime(prepared);
+  return RADIO_TX_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+send(const void *payload, unsigned short payload_len)
+{
+  airtime(payload);
+  return RADIO_TX_OK;
+}
+/*---------------------------------------------------------------------------*/
+static int
+read(void *buf, unsigned short buf_len)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+channel_clear(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+receiving_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+pending_packet(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_value(radio_param_t param, radio_value_t *value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_value(radio_param_t param, radio_value_t value)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+get_object(radio_param_t param, void *dest, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+static radio_result_t
+set_object(radio_param_t param, const void *src, size_t size)
+{
+  return RADIO_RESULT_NOT_SUPPORTED;
+}
+/*---------------------------------------------------------------------------*/
+const struct radio_driver benchmark_radio_driver = {
+  init,
+  prepare,
+  transmit,
+  send,
+  read,
+  channel_clear,
+  receiving_packet,
+  pending_packet,
+  on,
+  off,
+  get_value,
+  set_value,
+  get_object,
+  set_object
+};
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int num_transmissions)
+{
+  if(status == MAC_TX_OK) {
+    packets_sent++;
+  }
+  /* Queue a new packet. The poll events of several callbacks are
+     merged, so count them. */
+  to_queue++;
+  process_poll(&csma_burst_benchmark_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+queue_packet(void)
+{
+  static uint8_t payload[PAYLOAD_LEN];
+  linkaddr_t receiver;
+
+  memset(&receiver, 0, sizeof(receiver));
+  receiver.u8[LINKADDR_SIZE - 1] = 0x0b;
+
+  packetbuf_clear();
+  packetbuf_copyfrom(payload, sizeof(payload));
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &receiver);
+  NETSTACK_MAC.send(packet_sent, NULL);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(csma_burst_benchmark_process, ev, data)
+{
+  static struct etimer et;
+  static clock_time_t start;
+  int i;
+
+  PROCESS_BEGIN();
+
+  /* Let the network stack settle */
+  PROCESS_PAUSE();
+
+  printf("CSMA burst benchmark: burst %u, macMinBE %u, window %u, %u-byte packets, %u ms airtime\n",
+         CSMA_CONF_BURST, CSMA_CONF_MIN_BE, BENCHMARK_WINDOW, PAYLOAD_LEN,
+         (unsigned)(FRAME_AIRTIME * 1000 / CLOCK_SECOND));
+
+  frames_sent = 0;
+  frames_pending = 0;
+  packets_sent = 0;
+  start = clock_time();
+  etimer_set(&et, DURATION);
+
+  for(i = 0; i < BENCHMARK_WINDOW; i++) {
+    queue_packet();
+  }
+  while(!etimer_expired(&et)) {
+    PROCESS_WAIT_EVENT();
+    while(to_queue > 0) {
+      to_queue--;
+      queue_packet();
+    }
+  }
+
+  printf("%lu frames sent in %lu ms, %lu with the frame pending bit, %lu packets acknowledged\n",
+         frames_sent, (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND,
+         frames_pending, packets_sent);
+
+  exit(0);
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
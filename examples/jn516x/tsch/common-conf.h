@@ -76,6 +76,7 @@
 #define TSCH_CALLBACK_PACKET_READY orchestra_callback_packet_ready
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_ADDED_CALLBACK orchestra_callback_child_added
 #define NETSTACK_CONF_ROUTING_NEIGHBOR_REMOVED_CALLBACK orchestra_callback_child_removed
+#define RPL_CALLBACK_NEW_RANK orchestra_callback_new_rank
 
 /* Dimensioning */
 #define ORCHESTRA_CONF_EBSF_PERIOD                     41
@@ -234,6 +234,11 @@ typedef unsigned long clock_time_t;
 
 #define CLOCK_CONF_SECOND 1000
 
+/* The clock is the host's, so it keeps counting while the node is down */
+#ifndef PHASE_CONF_PERSIST_CLOCK
+#define PHASE_CONF_PERSIST_CLOCK() clock_time()
+#endif /* PHASE_CONF_PERSIST_CLOCK */
+
 #define LOG_CONF_ENABLED 1
 
 #define PROGRAM_HANDLER_CONF_MAX_NUMDSCS 10
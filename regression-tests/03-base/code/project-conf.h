@@ -34,4 +34,51 @@
 
 #define UNIT_TEST_PRINT_FUNCTION test_print_report
 
+#if WITH_MEMB_FREELIST
+/* Exercise the constant-time memb allocator */
+#define MEMB_CONF_WITH_FREELIST 1
+#endif /* WITH_MEMB_FREELIST */
+
+#if WITH_ETIMER_WHEEL
+/* Exercise the timing wheel backend of etimer */
+#define ETIMER_CONF_WHEEL 1
+#endif /* WITH_ETIMER_WHEEL */
+
+#if WITH_MMEM_DEFERRED_COMPACTION
+/* Exercise deferred compaction of mmem, on a small memory */
+#define MMEM_CONF_DEFERRED_COMPACTION 1
+#define MMEM_CONF_SIZE 256
+#define MMEM_CONF_COMPACT_THRESHOLD 64
+#define MMEM_CONF_COMPACT_STEP 32
+#endif /* WITH_MMEM_DEFERRED_COMPACTION */
+
+#if WITH_PACKETBUF_REFERENCE
+/* Exercise zero-copy references from packetbuf to queuebuf data */
+#define PACKETBUF_CONF_WITH_REFERENCE 1
+#endif /* WITH_PACKETBUF_REFERENCE */
+
+#if WITH_PROCESS_PRIORITIES
+/* Exercise event priorities and coalescing */
+#define PROCESS_CONF_PRIORITIES 3
+#define PROCESS_CONF_COALESCE_EVENTS 1
+#define PROCESS_CONF_STATS 1
+#endif /* WITH_PROCESS_PRIORITIES */
+
+#if WITH_CSMA_DRR
+/* Exercise the deficit round robin of CSMA and its queue statistics,
+   over an RDC layer that the test controls */
+#undef NETSTACK_CONF_MAC
+#define NETSTACK_CONF_MAC csma_driver
+#undef NETSTACK_CONF_RDC
+#define NETSTACK_CONF_RDC test_rdc_driver
+#define CSMA_CONF_DRR 1
+#define CSMA_CONF_DRR_QUANTUM 100
+#define CSMA_CONF_QUEUE_STATS 1
+#define CSMA_CONF_MIN_BE 0
+#define CSMA_CONF_MAX_FRAME_RETRIES 7
+#define CSMA_CONF_MAX_NEIGHBOR_QUEUES 4
+#undef QUEUEBUF_CONF_NUM
+#define QUEUEBUF_CONF_NUM 24
+#endif /* WITH_CSMA_DRR */
+
 #endif /* !_PROJECT_CONF_H_ */
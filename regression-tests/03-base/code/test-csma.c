@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+#include "net/mac/csma.h"
+
+#if !CSMA_DRR || !CSMA_QUEUE_STATS
+#error "Build with TEST_CONFIG_TYPE=CSMA_DRR"
+#endif
+
+PROCESS(test_process, "csma.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* The neighbors the test sends to, and how the RDC layer below
+   answers for each of them */
+#define NUM_NEIGHBORS 3
+static struct {
+  linkaddr_t addr;
+  int status;
+  int num_transmissions;
+} neighbors[NUM_NEIGHBORS];
+
+/* The transmissions of the RDC layer to these neighbors, in order */
+#define MAX_RECORDS 64
+struct record {
+  uint8_t neighbor;
+  uint8_t len;
+  uint8_t num_transmissions;
+};
+static struct record records[MAX_RECORDS];
+static uint8_t num_records;
+
+/* Packets queued, and packets that CSMA reported done */
+static uint8_t num_queued;
+static uint8_t num_done;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* An RDC layer that sends the first packet of each list at once, with
+   the outcome set for its receiver */
+static void
+send_list(mac_callback_t sent, void *ptr, struct rdc_buf_list *list)
+{
+  int status = MAC_TX_OK;
+  int num_transmissions = 1;
+  int i;
+
+  queuebuf_to_packetbuf(list->buf);
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    if(linkaddr_cmp(packetbuf_addr(PACKETBUF_ADDR_RECEIVER), &neighbors[i].addr)) {
+      status = neighbors[i].status;
+      num_transmissions = neighbors[i].num_transmissions;
+      if(num_records < MAX_RECORDS) {
+        records[num_records].neighbor = i;
+        records[num_records].len = packetbuf_datalen();
+        records[num_records].num_transmissions = num_transmissions;
+        num_records++;
+      }
+    }
+  }
+  mac_call_sent_callback(sent, ptr, status, num_transmissions);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send(mac_callback_t sent, void *ptr)
+{
+  mac_call_sent_callback(sent, ptr, MAC_TX_OK, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static int
+on(void)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+off(int keep_radio_on)
+{
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned short
+channel_check_interval(void)
+{
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+const struct rdc_driver test_rdc_driver = {
+  "test-rdc",
+  init,
+  send,
+  send_list,
+  input,
+  on,
+  off,
+  channel_check_interval,
+};
+/*---------------------------------------------------------------------------*/
+static void
+packet_sent(void *ptr, int status, int num_transmissions)
+{
+  num_done++;
+  process_poll(&test_process);
+}
+/*---------------------------------------------------------------------------*/
+static void
+queue_packet(int neighbor, int len)
+{
+  static uint8_t payload[PACKETBUF_SIZE];
+
+  packetbuf_clear();
+  packetbuf_copyfrom(payload, len);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &neighbors[neighbor].addr);
+  num_queued++;
+  NETSTACK_MAC.send(packet_sent, NULL);
+}
+/*---------------------------------------------------------------------------*/
+/* The airtime charged to neighbors 0 and 1, in bytes times
+   transmissions, while both of them had packets queued */
+static void
+backlogged_airtime(int total0, int total1, long *airtime0, long *airtime1)
+{
+  int count[2] = { 0, 0 };
+  long airtime[2] = { 0, 0 };
+  int i;
+
+  for(i = 0; i < num_records && count[0] < total0 && count[1] < total1; i++) {
+    if(records[i].neighbor < 2) {
+      count[records[i].neighbor]++;
+      airtime[records[i].neighbor] +=
+        (long)records[i].len * records[i].num_transmissions;
+    }
+  }
+  *airtime0 = airtime[0];
+  *airtime1 = airtime[1];
+}
+/*---------------------------------------------------------------------------*/
+/* Results of the tests */
+static long fair_airtime[2];
+static long charged_airtime[2];
+static uint8_t fair_records;
+static uint8_t charged_records;
+static uint8_t noack_records;
+
+UNIT_TEST_REGISTER(test_csma_fairness, "Byte fairness");
+UNIT_TEST(test_csma_fairness)
+{
+  UNIT_TEST_BEGIN();
+
+  /* A neighbor with large packets gets no more bytes through than one
+     with small packets, give or take a quantum and a packet */
+  UNIT_TEST_ASSERT(fair_records == 16);
+  UNIT_TEST_ASSERT(fair_airtime[0] > 0 && fair_airtime[1] > 0);
+  UNIT_TEST_ASSERT(fair_airtime[0] - fair_airtime[1] <= CSMA_CONF_DRR_QUANTUM + 100);
+  UNIT_TEST_ASSERT(fair_airtime[1] - fair_airtime[0] <= CSMA_CONF_DRR_QUANTUM + 100);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_csma_deficit, "Retransmissions charged");
+UNIT_TEST(test_csma_deficit)
+{
+  UNIT_TEST_BEGIN();
+
+  /* A neighbor whose packets take three transmissions gets a third of
+     the packets through, so that both use the same airtime */
+  UNIT_TEST_ASSERT(charged_records == 16);
+  UNIT_TEST_ASSERT(charged_airtime[0] > 0 && charged_airtime[1] > 0);
+  UNIT_TEST_ASSERT(charged_airtime[0] - charged_airtime[1] <= CSMA_CONF_DRR_QUANTUM + 150);
+  UNIT_TEST_ASSERT(charged_airtime[1] - charged_airtime[0] <= CSMA_CONF_DRR_QUANTUM + 150);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_csma_stats, "Queue statistics");
+UNIT_TEST(test_csma_stats)
+{
+  const struct csma_queue_stats *stats;
+
+  UNIT_TEST_BEGIN();
+
+  /* All packets to the first two neighbors were acknowledged */
+  stats = csma_queue_stats(&neighbors[0].addr);
+  UNIT_TEST_ASSERT(stats != NULL);
+  UNIT_TEST_ASSERT(stats->packets == 16);
+  UNIT_TEST_ASSERT(stats->drops == 0);
+  stats = csma_queue_stats(&neighbors[1].addr);
+  UNIT_TEST_ASSERT(stats != NULL);
+  UNIT_TEST_ASSERT(stats->packets == 16);
+  UNIT_TEST_ASSERT(stats->drops == 0);
+
+  /* The packet that was never acknowledged used all its
+     transmissions, and is counted once, as a drop */
+  UNIT_TEST_ASSERT(noack_records == CSMA_CONF_MAX_FRAME_RETRIES + 1);
+  stats = csma_queue_stats(&neighbors[2].addr);
+  UNIT_TEST_ASSERT(stats != NULL);
+  UNIT_TEST_ASSERT(stats->packets == 1);
+  UNIT_TEST_ASSERT(stats->drops == 1);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static int i;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < NUM_NEIGHBORS; i++) {
+    memset(&neighbors[i].addr, 0, sizeof(linkaddr_t));
+    neighbors[i].addr.u8[LINKADDR_SIZE - 1] = 0x0a + i;
+    neighbors[i].status = MAC_TX_OK;
+    neighbors[i].num_transmissions = 1;
+  }
+
+  /* Let the network stack settle */
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  /* Packets of 100 bytes to the first neighbor, of 25 to the second.
+     Nothing is sent before we yield. */
+  num_records = num_queued = num_done = 0;
+  for(i = 0; i < 8; i++) {
+    queue_packet(0, 100);
+    queue_packet(1, 25);
+  }
+  etimer_set(&et, 10 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(num_done == num_queued || etimer_expired(&et));
+  fair_records = num_records;
+  backlogged_airtime(8, 8, &fair_airtime[0], &fair_airtime[1]);
+  UNIT_TEST_RUN(test_csma_fairness);
+
+  /* Packets of 50 bytes to both, with three transmissions each for the
+     first neighbor */
+  neighbors[0].num_transmissions = 3;
+  num_records = num_queued = num_done = 0;
+  for(i = 0; i < 8; i++) {
+    queue_packet(0, 50);
+    queue_packet(1, 50);
+  }
+  etimer_set(&et, 10 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(num_done == num_queued || etimer_expired(&et));
+  charged_records = num_records;
+  backlogged_airtime(8, 8, &charged_airtime[0], &charged_airtime[1]);
+  UNIT_TEST_RUN(test_csma_deficit);
+
+  /* A packet that is never acknowledged */
+  neighbors[2].status = MAC_TX_NOACK;
+  num_records = num_queued = num_done = 0;
+  queue_packet(2, 50);
+  etimer_set(&et, 10 * CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(num_done == num_queued || etimer_expired(&et));
+  noack_records = num_records;
+  UNIT_TEST_RUN(test_csma_stats);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "sys/etimer.h"
+
+PROCESS(test_process, "etimer.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Intervals chosen to fall into the slots and levels of the default
+   timing wheel (16 slots per level), both on and next to slot
+   boundaries, and with two timers expiring at the same tick */
+static const clock_time_t intervals[] = {
+  300, 1, 17, 16, 255, 256, 15, 4100, 17, 1000
+};
+#define NUM_TIMERS (sizeof(intervals) / sizeof(intervals[0]))
+
+/* Expiration times may lag behind by a few ticks when the system is
+   busy, but never more */
+#define MAX_LATENESS 5
+
+static struct etimer timers[NUM_TIMERS];
+static clock_time_t expected[NUM_TIMERS];
+static clock_time_t fired_at[NUM_TIMERS];
+static uint8_t fired_count[NUM_TIMERS];
+static uint8_t fired_order[NUM_TIMERS];
+static uint8_t num_fired;
+
+/* Timers of the stop/restart test */
+static struct etimer stopped;
+static struct etimer moved_down;
+static struct etimer moved_up;
+static struct etimer periodic;
+static struct etimer guard;
+static struct etimer never_set;
+static clock_time_t moved_down_expected;
+static clock_time_t moved_up_expected;
+static clock_time_t periodic_expected[2];
+static clock_time_t moved_down_fired_at;
+static clock_time_t moved_up_fired_at;
+static clock_time_t periodic_fired_at[2];
+static uint8_t stopped_count;
+static uint8_t moved_down_count;
+static uint8_t moved_up_count;
+static uint8_t periodic_count;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static int
+on_time(clock_time_t fired, clock_time_t expiration)
+{
+  return (clock_time_t)(fired - expiration) <= MAX_LATENESS;
+}
+
+UNIT_TEST_REGISTER(test_etimer_expiry, "Expiry");
+UNIT_TEST(test_etimer_expiry)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_fired == NUM_TIMERS);
+  for(i = 0; i < NUM_TIMERS; i++) {
+    UNIT_TEST_ASSERT(fired_count[i] == 1);
+    UNIT_TEST_ASSERT(on_time(fired_at[i], expected[i]));
+  }
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_etimer_order, "Expiry ordering");
+UNIT_TEST(test_etimer_order)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 1; i < NUM_TIMERS; i++) {
+    UNIT_TEST_ASSERT(intervals[fired_order[i - 1]] <= intervals[fired_order[i]]);
+  }
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_etimer_stop_restart, "Stop and restart");
+UNIT_TEST(test_etimer_stop_restart)
+{
+  UNIT_TEST_BEGIN();
+
+  /* A stopped timer never expires */
+  UNIT_TEST_ASSERT(stopped_count == 0);
+  UNIT_TEST_ASSERT(etimer_expired(&stopped));
+
+  /* A timer set again expires once, at its new expiration time,
+     whether it moved to a closer or to a farther slot */
+  UNIT_TEST_ASSERT(moved_down_count == 1);
+  UNIT_TEST_ASSERT(on_time(moved_down_fired_at, moved_down_expected));
+  UNIT_TEST_ASSERT(moved_up_count == 1);
+  UNIT_TEST_ASSERT(on_time(moved_up_fired_at, moved_up_expected));
+
+  /* A reset timer keeps its period */
+  UNIT_TEST_ASSERT(periodic_count == 2);
+  UNIT_TEST_ASSERT(on_time(periodic_fired_at[0], periodic_expected[0]));
+  UNIT_TEST_ASSERT(on_time(periodic_fired_at[1], periodic_expected[1]));
+
+  /* Stopping a timer that has never been set does nothing */
+  etimer_stop(&never_set);
+  UNIT_TEST_ASSERT(etimer_expired(&never_set));
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static int i;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Expiry ordering: all timers are set at the same tick */
+  for(i = 0; i < NUM_TIMERS; i++) {
+    etimer_set(&timers[i], intervals[i]);
+    expected[i] = etimer_expiration_time(&timers[i]);
+  }
+  while(num_fired < NUM_TIMERS) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    for(i = 0; i < NUM_TIMERS; i++) {
+      if(data == &timers[i]) {
+        fired_at[i] = clock_time();
+        fired_count[i]++;
+        fired_order[num_fired++] = i;
+      }
+    }
+  }
+
+  /* Stop and restart, across slots and levels */
+  etimer_set(&stopped, 1000);
+  etimer_set(&moved_down, 900);
+  etimer_set(&moved_up, 20);
+  etimer_set(&periodic, 100);
+  etimer_set(&guard, 1200);
+  periodic_expected[0] = etimer_expiration_time(&periodic);
+  periodic_expected[1] = periodic_expected[0] + 100;
+
+  etimer_set(&moved_down, 40);
+  moved_down_expected = etimer_expiration_time(&moved_down);
+  etimer_set(&moved_up, 800);
+  moved_up_expected = etimer_expiration_time(&moved_up);
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+    if(data == &stopped) {
+      stopped_count++;
+    } else if(data == &moved_down) {
+      moved_down_fired_at = clock_time();
+      moved_down_count++;
+    } else if(data == &moved_up) {
+      moved_up_fired_at = clock_time();
+      moved_up_count++;
+      /* Stop the far timer while it is pending, possibly after it has
+         been moved to a lower level of the wheel */
+      etimer_stop(&stopped);
+    } else if(data == &periodic) {
+      if(periodic_count < 2) {
+        periodic_fired_at[periodic_count] = clock_time();
+      }
+      if(++periodic_count == 1) {
+        etimer_reset(&periodic);
+      }
+    } else if(data == &guard) {
+      break;
+    }
+  }
+
+  UNIT_TEST_RUN(test_etimer_expiry);
+  UNIT_TEST_RUN(test_etimer_order);
+  UNIT_TEST_RUN(test_etimer_stop_restart);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
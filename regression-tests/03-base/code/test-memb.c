@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "lib/memb.h"
+
+PROCESS(test_process, "memb.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_BLOCKS 4
+
+struct test_block {
+  uint16_t a;
+  uint8_t b;
+};
+
+MEMB(test_memb, struct test_block, NUM_BLOCKS);
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+UNIT_TEST_REGISTER(test_memb_uninitialized, "Uninitialized");
+UNIT_TEST(test_memb_uninitialized)
+{
+  struct test_block *b;
+
+  UNIT_TEST_BEGIN();
+
+  /* A statically declared memb is usable before memb_init() */
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == NUM_BLOCKS);
+  b = memb_alloc(&test_memb);
+  UNIT_TEST_ASSERT(b != NULL && memb_inmemb(&test_memb, b));
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == NUM_BLOCKS - 1);
+  UNIT_TEST_ASSERT(memb_free(&test_memb, b) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == NUM_BLOCKS);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_memb_alloc, "Alloc");
+UNIT_TEST(test_memb_alloc)
+{
+  struct test_block *b[NUM_BLOCKS];
+  int i, j;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&test_memb);
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    b[i] = memb_alloc(&test_memb);
+    UNIT_TEST_ASSERT(b[i] != NULL);
+    UNIT_TEST_ASSERT(memb_numfree(&test_memb) == NUM_BLOCKS - i - 1);
+    for(j = 0; j < i; j++) {
+      UNIT_TEST_ASSERT(b[i] != b[j]);
+    }
+  }
+
+  /* All blocks are in use */
+  UNIT_TEST_ASSERT(memb_alloc(&test_memb) == NULL);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 0);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_memb_free, "Free");
+UNIT_TEST(test_memb_free)
+{
+  struct test_block *b[NUM_BLOCKS];
+  struct test_block *r;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&test_memb);
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    b[i] = memb_alloc(&test_memb);
+  }
+
+  /* Pointers that do not point to the start of a block are rejected */
+  UNIT_TEST_ASSERT(memb_free(&test_memb, (char *)b[1] + 1) == -1);
+  UNIT_TEST_ASSERT(memb_free(&test_memb, &r) == -1);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 0);
+
+  UNIT_TEST_ASSERT(memb_free(&test_memb, b[1]) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 1);
+
+  /* Freeing a free block does not change anything */
+  UNIT_TEST_ASSERT(memb_free(&test_memb, b[1]) == 0);
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 1);
+
+  /* The freed block is the only one that can be allocated again */
+  r = memb_alloc(&test_memb);
+  UNIT_TEST_ASSERT(r == b[1]);
+  UNIT_TEST_ASSERT(memb_alloc(&test_memb) == NULL);
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    UNIT_TEST_ASSERT(memb_free(&test_memb, b[i]) == 0);
+  }
+  UNIT_TEST_ASSERT(memb_numfree(&test_memb) == NUM_BLOCKS);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_memb_reuse, "Reuse");
+UNIT_TEST(test_memb_reuse)
+{
+  struct test_block *b[NUM_BLOCKS];
+  struct test_block *r;
+  int i, round;
+
+  UNIT_TEST_BEGIN();
+
+  memb_init(&test_memb);
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    b[i] = memb_alloc(&test_memb);
+  }
+
+  /* Repeatedly free and reallocate blocks in a different order */
+  for(round = 0; round < 3; round++) {
+    for(i = NUM_BLOCKS - 1; i >= 0; i -= 2) {
+      UNIT_TEST_ASSERT(memb_free(&test_memb, b[i]) == 0);
+    }
+    UNIT_TEST_ASSERT(memb_numfree(&test_memb) == NUM_BLOCKS / 2);
+    for(i = NUM_BLOCKS - 1; i >= 0; i -= 2) {
+      r = memb_alloc(&test_memb);
+      UNIT_TEST_ASSERT(r != NULL && memb_inmemb(&test_memb, r));
+      b[i] = r;
+    }
+    UNIT_TEST_ASSERT(memb_numfree(&test_memb) == 0);
+    UNIT_TEST_ASSERT(memb_alloc(&test_memb) == NULL);
+  }
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test_memb_uninitialized);
+  UNIT_TEST_RUN(test_memb_alloc);
+  UNIT_TEST_RUN(test_memb_free);
+  UNIT_TEST_RUN(test_memb_reuse);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "lib/mmem.h"
+
+#if !MMEM_DEFERRED_COMPACTION
+#error "Build with TEST_CONFIG_TYPE=MMEM_DEFERRED_COMPACTION"
+#endif /* !MMEM_DEFERRED_COMPACTION */
+
+PROCESS(test_process, "mmem.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define BLOCK_SIZE 16
+#define NUM_BLOCKS (MMEM_CONF_SIZE / BLOCK_SIZE)
+
+static struct mmem blocks[NUM_BLOCKS];
+static struct mmem extra;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+fill(struct mmem *m, uint8_t pattern)
+{
+  memset(m->ptr, pattern, m->size);
+}
+
+static int
+check(struct mmem *m, uint8_t pattern)
+{
+  unsigned int i;
+
+  for(i = 0; i < m->size; i++) {
+    if(((uint8_t *)m->ptr)[i] != pattern) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Allocates all blocks, each filled with its own index */
+static int
+alloc_all(void)
+{
+  int i;
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    if(!mmem_alloc(&blocks[i], BLOCK_SIZE)) {
+      return 0;
+    }
+    fill(&blocks[i], i);
+  }
+  return 1;
+}
+
+/* Checks that the blocks that are not in the freed bitmap are intact */
+static int
+check_all(uint32_t freed)
+{
+  int i;
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    if(!(freed & ((uint32_t)1 << i)) && !check(&blocks[i], i)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Frees the blocks that are in the bitmap */
+static void
+free_blocks(uint32_t which)
+{
+  int i;
+
+  for(i = 0; i < NUM_BLOCKS; i++) {
+    if(which & ((uint32_t)1 << i)) {
+      mmem_free(&blocks[i]);
+    }
+  }
+}
+
+UNIT_TEST_REGISTER(test_mmem_holes, "Hole reuse");
+UNIT_TEST(test_mmem_holes)
+{
+  struct mmem_stats stats;
+  unsigned long compacted;
+  void *ptr[4];
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.avail == MMEM_CONF_SIZE);
+  compacted = stats.compacted;
+
+  for(i = 0; i < 4; i++) {
+    UNIT_TEST_ASSERT(mmem_alloc(&blocks[i], 2 * BLOCK_SIZE));
+    fill(&blocks[i], i);
+    ptr[i] = blocks[i].ptr;
+  }
+
+  /* Freeing a block moves nothing, and leaves a hole */
+  mmem_free(&blocks[1]);
+  UNIT_TEST_ASSERT(blocks[0].ptr == ptr[0]);
+  UNIT_TEST_ASSERT(blocks[2].ptr == ptr[2] && check(&blocks[2], 2));
+  UNIT_TEST_ASSERT(blocks[3].ptr == ptr[3] && check(&blocks[3], 3));
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.compacted == compacted);
+  UNIT_TEST_ASSERT(stats.avail == MMEM_CONF_SIZE - 6 * BLOCK_SIZE);
+  UNIT_TEST_ASSERT(stats.largest_free == MMEM_CONF_SIZE - 8 * BLOCK_SIZE);
+  UNIT_TEST_ASSERT(stats.fragmentation > 0);
+
+  /* The hole is reused in place of the free memory at the end */
+  UNIT_TEST_ASSERT(mmem_alloc(&extra, BLOCK_SIZE));
+  UNIT_TEST_ASSERT(extra.ptr == ptr[1]);
+
+  /* Freeing the last block gives its memory back to the end */
+  mmem_free(&blocks[3]);
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.largest_free == MMEM_CONF_SIZE - 6 * BLOCK_SIZE);
+
+  mmem_free(&extra);
+  mmem_free(&blocks[0]);
+  mmem_free(&blocks[2]);
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.avail == MMEM_CONF_SIZE);
+  UNIT_TEST_ASSERT(stats.largest_free == MMEM_CONF_SIZE);
+  UNIT_TEST_ASSERT(stats.compacted == compacted);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_mmem_full_compaction, "Compaction on allocation");
+UNIT_TEST(test_mmem_full_compaction)
+{
+  struct mmem_stats stats;
+  unsigned long compacted;
+  uint32_t freed;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(alloc_all());
+  UNIT_TEST_ASSERT(!mmem_alloc(&extra, 1));
+
+  /* Leave holes that add up to the threshold, none of them larger
+     than a block */
+  freed = 0x55555555 & (((uint32_t)1 << (MMEM_COMPACT_THRESHOLD / BLOCK_SIZE * 2)) - 1);
+  free_blocks(freed);
+  mmem_stats(&stats);
+  compacted = stats.compacted;
+  UNIT_TEST_ASSERT(stats.avail == MMEM_COMPACT_THRESHOLD);
+  UNIT_TEST_ASSERT(stats.largest_free == BLOCK_SIZE);
+
+  /* An allocation that fits in no hole compacts the memory */
+  UNIT_TEST_ASSERT(mmem_alloc(&extra, 2 * BLOCK_SIZE));
+  fill(&extra, 0xff);
+  UNIT_TEST_ASSERT(check_all(freed));
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.compacted > compacted);
+  UNIT_TEST_ASSERT(stats.largest_free == stats.avail);
+  UNIT_TEST_ASSERT(stats.fragmentation == 0);
+
+  mmem_free(&extra);
+  free_blocks(~freed);
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.avail == MMEM_CONF_SIZE);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_mmem_incremental, "Incremental compaction");
+UNIT_TEST(test_mmem_incremental)
+{
+  struct mmem_stats stats;
+  unsigned long compacted;
+  uint32_t freed;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(alloc_all());
+
+  /* Free every other block, up to the threshold: nothing moves */
+  freed = 0;
+  for(i = 0; i < MMEM_COMPACT_THRESHOLD / BLOCK_SIZE; i++) {
+    mmem_free(&blocks[2 * i]);
+    freed |= (uint32_t)1 << (2 * i);
+  }
+  mmem_stats(&stats);
+  compacted = stats.compacted;
+  UNIT_TEST_ASSERT(stats.largest_free == BLOCK_SIZE);
+
+  /* One more hole goes over the threshold: one bounded step of
+     compaction */
+  mmem_free(&blocks[2 * i]);
+  freed |= (uint32_t)1 << (2 * i);
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.compacted > compacted);
+  UNIT_TEST_ASSERT(stats.compacted - compacted <= MMEM_COMPACT_STEP);
+  UNIT_TEST_ASSERT(stats.largest_free < stats.avail);
+  UNIT_TEST_ASSERT(check_all(freed));
+
+  /* Explicit compaction closes all holes */
+  UNIT_TEST_ASSERT(mmem_compact(0) > 0);
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.largest_free == stats.avail);
+  UNIT_TEST_ASSERT(check_all(freed));
+  UNIT_TEST_ASSERT(mmem_compact(0) == 0);
+
+  free_blocks(~freed);
+  mmem_stats(&stats);
+  UNIT_TEST_ASSERT(stats.avail == MMEM_CONF_SIZE);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  mmem_init();
+
+  UNIT_TEST_RUN(test_mmem_holes);
+  UNIT_TEST_RUN(test_mmem_full_compaction);
+  UNIT_TEST_RUN(test_mmem_incremental);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#if PROCESS_PRIORITIES < 3 || !PROCESS_COALESCE_EVENTS || !PROCESS_CONF_STATS
+#error "Build with TEST_CONFIG_TYPE=PROCESS_PRIORITIES"
+#endif
+
+PROCESS(test_process, "process.c test");
+PROCESS(low_process, "low priority receiver");
+PROCESS(mid_process, "mid priority receiver");
+PROCESS(high_process, "high priority receiver");
+AUTOSTART_PROCESSES(&test_process);
+
+/* Events are recorded in the order they are delivered */
+#define MAX_RECORDS 16
+struct record {
+  struct process *p;
+  process_event_t ev;
+  process_data_t data;
+};
+static struct record records[MAX_RECORDS];
+static uint8_t num_records;
+
+static process_event_t test_event;
+static process_event_t flood_event;
+static unsigned num_flooded;
+
+/* Tags passed as event data */
+static char tag[6];
+static char flood[PROCESS_CONF_NUMEVENTS];
+
+/* Results of the posts of a test */
+static int post_results;
+static unsigned short coalesced;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+static void
+record(process_event_t ev, process_data_t data)
+{
+  if(ev == flood_event) {
+    num_flooded++;
+  } else if(ev == test_event && num_records < MAX_RECORDS) {
+    records[num_records].p = PROCESS_CURRENT();
+    records[num_records].ev = ev;
+    records[num_records].data = data;
+    num_records++;
+  }
+}
+
+PROCESS_THREAD(low_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT();
+    record(ev, data);
+  }
+  PROCESS_END();
+}
+
+PROCESS_THREAD(mid_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT();
+    record(ev, data);
+  }
+  PROCESS_END();
+}
+
+PROCESS_THREAD(high_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1) {
+    PROCESS_WAIT_EVENT();
+    record(ev, data);
+  }
+  PROCESS_END();
+}
+
+static int
+is_record(int i, struct process *p, process_data_t data)
+{
+  return i < num_records && records[i].p == p && records[i].data == data;
+}
+
+UNIT_TEST_REGISTER(test_process_priority, "Priority order");
+UNIT_TEST(test_process_priority)
+{
+  static struct process * const order[] = {
+    &high_process, &high_process, &mid_process, &mid_process,
+    &low_process, &low_process
+  };
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  /* The highest level is served first */
+  UNIT_TEST_ASSERT(num_records == 6);
+  for(i = 0; i < num_records; i++) {
+    UNIT_TEST_ASSERT(records[i].p == order[i]);
+  }
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_process_fifo, "FIFO order within a priority");
+UNIT_TEST(test_process_fifo)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Within a level, events are delivered in the order of the posts */
+  UNIT_TEST_ASSERT(num_records == 6);
+  UNIT_TEST_ASSERT(is_record(0, &mid_process, &tag[0]));
+  UNIT_TEST_ASSERT(is_record(1, &mid_process, &tag[2]));
+  UNIT_TEST_ASSERT(is_record(2, &mid_process, &tag[4]));
+  UNIT_TEST_ASSERT(is_record(3, &low_process, &tag[1]));
+  UNIT_TEST_ASSERT(is_record(4, &low_process, &tag[3]));
+  UNIT_TEST_ASSERT(is_record(5, &low_process, &tag[5]));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_process_coalesce, "Coalesced events");
+UNIT_TEST(test_process_coalesce)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The duplicates were accepted, but queued once */
+  UNIT_TEST_ASSERT(post_results == 0);
+  UNIT_TEST_ASSERT(coalesced == 2);
+  UNIT_TEST_ASSERT(num_records == 4);
+  UNIT_TEST_ASSERT(is_record(0, &high_process, &tag[0]));
+  UNIT_TEST_ASSERT(is_record(1, &low_process, &tag[0]));
+  UNIT_TEST_ASSERT(is_record(2, &low_process, &tag[1]));
+  /* Once delivered, the event was queued again */
+  UNIT_TEST_ASSERT(is_record(3, &low_process, &tag[0]));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_process_reserved, "Reserved event slots");
+UNIT_TEST(test_process_reserved)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The low level ran out of slots before the queue was full */
+  UNIT_TEST_ASSERT(num_flooded > 0);
+  UNIT_TEST_ASSERT(num_flooded <=
+                   PROCESS_CONF_NUMEVENTS - (PROCESS_PRIORITIES - 1) * PROCESS_RESERVED_EVENTS);
+  /* Higher levels still got their slots */
+  UNIT_TEST_ASSERT(post_results == 0);
+  UNIT_TEST_ASSERT(num_records == 2);
+  UNIT_TEST_ASSERT(is_record(0, &high_process, &tag[2]));
+  UNIT_TEST_ASSERT(is_record(1, &mid_process, &tag[1]));
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static unsigned short stats_coalesced;
+  static int i;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  test_event = process_alloc_event();
+  flood_event = process_alloc_event();
+
+  process_start(&low_process, NULL);
+  process_start(&mid_process, NULL);
+  process_start(&high_process, NULL);
+  process_set_priority(&low_process, PROCESS_PRIORITY_NORMAL);
+  process_set_priority(&mid_process, PROCESS_PRIORITY_NORMAL + 1);
+  process_set_priority(&high_process, PROCESS_PRIORITY_HIGH);
+
+  /* Events posted while we run are queued. Our own timer event has the
+     lowest priority and comes after them. */
+
+  num_records = 0;
+  process_post(&low_process, test_event, &tag[0]);
+  process_post(&mid_process, test_event, &tag[1]);
+  process_post(&high_process, test_event, &tag[2]);
+  process_post(&low_process, test_event, &tag[3]);
+  process_post(&high_process, test_event, &tag[4]);
+  process_post(&mid_process, test_event, &tag[5]);
+  etimer_set(&et, 1);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+  UNIT_TEST_RUN(test_process_priority);
+
+  num_records = 0;
+  process_post(&mid_process, test_event, &tag[0]);
+  process_post(&low_process, test_event, &tag[1]);
+  process_post(&mid_process, test_event, &tag[2]);
+  process_post(&low_process, test_event, &tag[3]);
+  process_post(&mid_process, test_event, &tag[4]);
+  process_post(&low_process, test_event, &tag[5]);
+  etimer_set(&et, 1);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+  UNIT_TEST_RUN(test_process_fifo);
+
+  num_records = 0;
+  post_results = 0;
+  stats_coalesced = process_stats.coalesced;
+  /* The same event and data, to the same process */
+  post_results |= process_post(&low_process, test_event, &tag[0]);
+  post_results |= process_post(&low_process, test_event, &tag[0]);
+  post_results |= process_post(&low_process, test_event, &tag[0]);
+  /* Other data, or another process */
+  post_results |= process_post(&low_process, test_event, &tag[1]);
+  post_results |= process_post(&high_process, test_event, &tag[0]);
+  coalesced = process_stats.coalesced - stats_coalesced;
+  etimer_set(&et, 1);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+  post_results |= process_post(&low_process, test_event, &tag[0]);
+  etimer_set(&et, 1);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+  UNIT_TEST_RUN(test_process_coalesce);
+
+  num_records = 0;
+  num_flooded = 0;
+  /* Fill the low level, with distinct data so that the events are
+     not coalesced */
+  for(i = 0; i < PROCESS_CONF_NUMEVENTS; i++) {
+    if(process_post(&low_process, flood_event, &flood[i]) != PROCESS_ERR_OK) {
+      break;
+    }
+  }
+  post_results = 0;
+  post_results |= process_post(&mid_process, test_event, &tag[1]);
+  post_results |= process_post(&high_process, test_event, &tag[2]);
+  /* Our timer event waits for a free slot at the low level */
+  etimer_set(&et, 1);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+  UNIT_TEST_RUN(test_process_reserved);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "net/packetbuf.h"
+#include "net/queuebuf.h"
+
+#if !PACKETBUF_WITH_REFERENCE
+#error "Build with TEST_CONFIG_TYPE=PACKETBUF_REFERENCE"
+#endif /* !PACKETBUF_WITH_REFERENCE */
+
+PROCESS(test_process, "queuebuf.c test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define FRAME_LEN 60
+
+static uint8_t frame[FRAME_LEN];
+static uint8_t out[PACKETBUF_SIZE];
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+/* Queues the test frame, with an attribute to check that it follows */
+static struct queuebuf *
+queue_frame(void)
+{
+  packetbuf_copyfrom(frame, FRAME_LEN);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 3);
+  return queuebuf_new_from_packetbuf();
+}
+
+static int
+queued_frame_intact(struct queuebuf *q)
+{
+  return queuebuf_datalen(q) == FRAME_LEN
+    && memcmp(queuebuf_dataptr(q), frame, FRAME_LEN) == 0;
+}
+
+UNIT_TEST_REGISTER(test_reference, "Reference");
+UNIT_TEST(test_reference)
+{
+  struct queuebuf *q;
+
+  UNIT_TEST_BEGIN();
+
+  q = queue_frame();
+  UNIT_TEST_ASSERT(q != NULL);
+  packetbuf_clear();
+
+  /* The packetbuf points to the queued frame */
+  queuebuf_to_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_referenced() == queuebuf_dataptr(q));
+  UNIT_TEST_ASSERT(packetbuf_datalen() == FRAME_LEN);
+  UNIT_TEST_ASSERT(packetbuf_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS) == 3);
+
+  /* Copying out and reading lengths does not copy the frame in */
+  UNIT_TEST_ASSERT(packetbuf_copyto(out) == FRAME_LEN);
+  UNIT_TEST_ASSERT(memcmp(out, frame, FRAME_LEN) == 0);
+  UNIT_TEST_ASSERT(packetbuf_referenced() == queuebuf_dataptr(q));
+
+  packetbuf_clear();
+  UNIT_TEST_ASSERT(packetbuf_referenced() == NULL);
+  queuebuf_free(q);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_reference_header, "Header in headroom");
+UNIT_TEST(test_reference_header)
+{
+  struct queuebuf *q;
+  uint8_t *hdr;
+
+  UNIT_TEST_BEGIN();
+
+  q = queue_frame();
+  UNIT_TEST_ASSERT(q != NULL);
+
+  /* Two transmission attempts, as CSMA makes them */
+  queuebuf_to_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_hdralloc(PACKETBUF_REFERENCE_HEADROOM - 4));
+  UNIT_TEST_ASSERT(packetbuf_hdralloc(4));
+  hdr = packetbuf_hdrptr();
+  memset(hdr, 0xaa, PACKETBUF_REFERENCE_HEADROOM);
+
+  /* The headers went in front of the frame, without copying it */
+  UNIT_TEST_ASSERT(packetbuf_referenced() == queuebuf_dataptr(q));
+  UNIT_TEST_ASSERT(hdr + PACKETBUF_REFERENCE_HEADROOM == queuebuf_dataptr(q));
+  UNIT_TEST_ASSERT(packetbuf_totlen() == PACKETBUF_REFERENCE_HEADROOM + FRAME_LEN);
+  UNIT_TEST_ASSERT(packetbuf_copyto(out) == PACKETBUF_REFERENCE_HEADROOM + FRAME_LEN);
+  UNIT_TEST_ASSERT(out[0] == 0xaa && out[PACKETBUF_REFERENCE_HEADROOM - 1] == 0xaa);
+  UNIT_TEST_ASSERT(memcmp(out + PACKETBUF_REFERENCE_HEADROOM, frame, FRAME_LEN) == 0);
+  UNIT_TEST_ASSERT(queued_frame_intact(q));
+
+  queuebuf_to_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_totlen() == FRAME_LEN);
+  UNIT_TEST_ASSERT(packetbuf_hdralloc(8));
+  UNIT_TEST_ASSERT(packetbuf_referenced() == queuebuf_dataptr(q));
+
+  /* A header that does not fit in the headroom copies the frame */
+  UNIT_TEST_ASSERT(packetbuf_hdralloc(PACKETBUF_REFERENCE_HEADROOM));
+  UNIT_TEST_ASSERT(packetbuf_referenced() == NULL);
+  UNIT_TEST_ASSERT(packetbuf_hdrlen() == PACKETBUF_REFERENCE_HEADROOM + 8);
+  UNIT_TEST_ASSERT(memcmp((uint8_t *)packetbuf_hdrptr() + packetbuf_hdrlen(),
+                          frame, FRAME_LEN) == 0);
+  UNIT_TEST_ASSERT(queued_frame_intact(q));
+
+  packetbuf_clear();
+  queuebuf_free(q);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_reference_write, "Copy on write");
+UNIT_TEST(test_reference_write)
+{
+  struct queuebuf *q;
+  uint8_t *data;
+
+  UNIT_TEST_BEGIN();
+
+  q = queue_frame();
+  UNIT_TEST_ASSERT(q != NULL);
+
+  /* Writing to the data goes to a copy */
+  queuebuf_to_packetbuf(q);
+  data = packetbuf_dataptr();
+  UNIT_TEST_ASSERT(packetbuf_referenced() == NULL);
+  UNIT_TEST_ASSERT(data != queuebuf_dataptr(q));
+  UNIT_TEST_ASSERT(memcmp(data, frame, FRAME_LEN) == 0);
+  data[0] ^= 0xff;
+  UNIT_TEST_ASSERT(queued_frame_intact(q));
+
+  /* So does writing to the frame before any header is allocated */
+  queuebuf_to_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_hdrptr() != queuebuf_dataptr(q));
+  UNIT_TEST_ASSERT(packetbuf_referenced() == NULL);
+
+  /* Compacting copies too */
+  queuebuf_to_packetbuf(q);
+  packetbuf_hdrreduce(4);
+  packetbuf_compact();
+  UNIT_TEST_ASSERT(packetbuf_referenced() == NULL);
+  UNIT_TEST_ASSERT(packetbuf_datalen() == FRAME_LEN - 4);
+  UNIT_TEST_ASSERT(memcmp(packetbuf_dataptr(), frame + 4, FRAME_LEN - 4) == 0);
+  UNIT_TEST_ASSERT(queued_frame_intact(q));
+
+  /* Updating the queuebuf that the packetbuf references keeps the
+     packetbuf contents */
+  queuebuf_to_packetbuf(q);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS, 5);
+  queuebuf_update_from_packetbuf(q);
+  UNIT_TEST_ASSERT(packetbuf_referenced() == NULL);
+  UNIT_TEST_ASSERT(memcmp(packetbuf_dataptr(), frame, FRAME_LEN) == 0);
+  UNIT_TEST_ASSERT(queued_frame_intact(q));
+  UNIT_TEST_ASSERT(queuebuf_attr(q, PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS) == 5);
+
+  packetbuf_clear();
+  queuebuf_free(q);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_reference_free, "Free while referenced");
+UNIT_TEST(test_reference_free)
+{
+  struct queuebuf *q[QUEUEBUF_NUM];
+  int num_free;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  num_free = queuebuf_numfree();
+  UNIT_TEST_ASSERT(num_free > 1);
+
+  /* The data outlives its queuebuf while the packetbuf references it */
+  q[0] = queue_frame();
+  UNIT_TEST_ASSERT(q[0] != NULL);
+  queuebuf_to_packetbuf(q[0]);
+  queuebuf_free(q[0]);
+  UNIT_TEST_ASSERT(queuebuf_numfree() == num_free);
+  UNIT_TEST_ASSERT(packetbuf_copyto(out) == FRAME_LEN);
+  UNIT_TEST_ASSERT(memcmp(out, frame, FRAME_LEN) == 0);
+
+  /* Once the packetbuf has moved on, the data is reclaimed */
+  packetbuf_clear();
+  for(i = 0; i < num_free; i++) {
+    q[i] = queue_frame();
+    UNIT_TEST_ASSERT(q[i] != NULL);
+  }
+  for(i = 0; i < num_free; i++) {
+    queuebuf_free(q[i]);
+  }
+  UNIT_TEST_ASSERT(queuebuf_numfree() == num_free);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  int i;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  for(i = 0; i < FRAME_LEN; i++) {
+    frame[i] = i;
+  }
+
+  UNIT_TEST_RUN(test_reference);
+  UNIT_TEST_RUN(test_reference_header);
+  UNIT_TEST_RUN(test_reference_write);
+  UNIT_TEST_RUN(test_reference_free);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
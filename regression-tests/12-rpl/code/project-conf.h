@@ -28,3 +28,25 @@
  */
 #define TCPIP_CONF_ANNOTATE_TRANSMISSIONS 1
 
+
+#if WITH_PARENT_HEAP
+#define UNIT_TEST_PRINT_FUNCTION test_print_report
+/* Select parents through the heap, without probing */
+#define RPL_CONF_WITH_PARENT_HEAP 1
+#define RPL_CONF_WITH_PROBING 0
+#endif /* WITH_PARENT_HEAP */
+
+#if WITH_DAO_QUEUE
+#define UNIT_TEST_PRINT_FUNCTION test_print_report
+/* Queue four DAOs at the root, and count what becomes of them */
+#define RPL_CONF_DAO_QUEUE_SIZE 4
+#define RPL_CONF_STATS 1
+#endif /* WITH_DAO_QUEUE */
+
+#if WITH_DAO_TARGETS
+#define UNIT_TEST_PRINT_FUNCTION test_print_report
+/* Receive DAOs with several targets, without packing the DAOs we send */
+#define RPL_CONF_DAO_PACKING 0
+/* A root, and a router in an instance of its own */
+#define RPL_CONF_MAX_INSTANCES 2
+#endif /* WITH_DAO_TARGETS */
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "net/packetbuf.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-icmp6.h"
+#include "net/rpl/rpl-private.h"
+
+#if !RPL_DAO_QUEUE_SIZE || !RPL_CONF_STATS
+#error "Build with TEST_CONFIG_TYPE=DAO_QUEUE"
+#endif /* !RPL_DAO_QUEUE_SIZE || !RPL_CONF_STATS */
+
+PROCESS(test_process, "DAO queue test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define IP_BUF      ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define DAO_BUF     (&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN + UIP_ICMPH_LEN])
+
+#define NUM_SENDERS 2
+#define NUM_TARGETS 8
+
+static rpl_dag_t *dag;
+static uip_ipaddr_t root;
+static uip_ipaddr_t senders[NUM_SENDERS];
+static linkaddr_t sender_lladdrs[NUM_SENDERS];
+static uip_ipaddr_t targets[NUM_TARGETS];
+static int dao_len;
+static uint8_t dao_sequence;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Start a DAO to the root in uip_buf */
+static void
+dao_begin(void)
+{
+  dao_len = 0;
+  DAO_BUF[dao_len++] = RPL_DEFAULT_INSTANCE;
+  DAO_BUF[dao_len++] = 0; /* flags */
+  DAO_BUF[dao_len++] = 0; /* reserved */
+  DAO_BUF[dao_len++] = ++dao_sequence;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dao_add_target(int target)
+{
+  DAO_BUF[dao_len++] = RPL_OPTION_TARGET;
+  DAO_BUF[dao_len++] = 2 + 16;
+  DAO_BUF[dao_len++] = 0; /* reserved */
+  DAO_BUF[dao_len++] = 128;
+  memcpy(&DAO_BUF[dao_len], &targets[target], 16);
+  dao_len += 16;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dao_add_transit(uint8_t lifetime)
+{
+  DAO_BUF[dao_len++] = RPL_OPTION_TRANSIT;
+  DAO_BUF[dao_len++] = 4;
+  DAO_BUF[dao_len++] = 0; /* flags */
+  DAO_BUF[dao_len++] = 0; /* path control */
+  DAO_BUF[dao_len++] = 0; /* path sequence */
+  DAO_BUF[dao_len++] = lifetime;
+}
+/*---------------------------------------------------------------------------*/
+/* Pass the DAO in uip_buf to RPL as if it came from the sender */
+static void
+dao_input(int sender)
+{
+  memset(IP_BUF, 0, UIP_IPH_LEN);
+  IP_BUF->vtc = 0x60;
+  IP_BUF->len[1] = UIP_ICMPH_LEN + dao_len;
+  IP_BUF->proto = UIP_PROTO_ICMP6;
+  IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&IP_BUF->srcipaddr, &senders[sender]);
+  uip_ipaddr_copy(&IP_BUF->destipaddr, &root);
+  uip_len = UIP_IPH_LEN + UIP_ICMPH_LEN + dao_len;
+  uip_ext_len = 0;
+
+  packetbuf_clear();
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &sender_lladdrs[sender]);
+  uip_icmp6_input(ICMP6_RPL, RPL_CODE_DAO);
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_dao(int sender, int target, uint8_t lifetime)
+{
+  dao_begin();
+  dao_add_target(target);
+  dao_add_transit(lifetime);
+  dao_input(sender);
+}
+/*---------------------------------------------------------------------------*/
+/* Whether the root routes to the target through the sender */
+static int
+routed(int target, int sender)
+{
+  uip_ds6_route_t *rep = uip_ds6_route_lookup(&targets[target]);
+
+  return rep != NULL && rep->length == 128 &&
+    uip_ipaddr_cmp(&rep->ipaddr, &targets[target]) &&
+    uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &senders[sender]);
+}
+/*---------------------------------------------------------------------------*/
+/* Results of the tests */
+static int merged_queued;
+static uint16_t merged_count;
+static int merged_routed;
+static int merged_nopath_ignored;
+static int merged_lifetime;
+static int full_queued;
+static uint16_t full_drops;
+static uint16_t full_merged;
+static int full_routed;
+static int full_dropped_routed;
+static uint16_t malformed_count;
+static int malformed_queued;
+
+UNIT_TEST_REGISTER(test_dao_merged, "Merged DAOs");
+UNIT_TEST(test_dao_merged)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The second DAO from the first sender for the first target replaced
+     the first one, the DAOs of the second sender or for another target
+     were queued apart */
+  UNIT_TEST_ASSERT(merged_queued == 3);
+  UNIT_TEST_ASSERT(merged_count == 1);
+
+  /* The route has the lifetime of the newer DAO, and the No-Path DAO
+     of the other sender did not remove it */
+  UNIT_TEST_ASSERT(merged_routed);
+  UNIT_TEST_ASSERT(merged_nopath_ignored);
+  UNIT_TEST_ASSERT(merged_lifetime);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_dao_full, "Full queue");
+UNIT_TEST(test_dao_full)
+{
+  UNIT_TEST_BEGIN();
+
+  /* A DAO for a new target is dropped when the queue is full, a newer
+     DAO for a queued one is not */
+  UNIT_TEST_ASSERT(full_queued == RPL_DAO_QUEUE_SIZE);
+  UNIT_TEST_ASSERT(full_drops == 1);
+  UNIT_TEST_ASSERT(full_merged == 1);
+
+  /* Only the queued targets are routed */
+  UNIT_TEST_ASSERT(full_routed);
+  UNIT_TEST_ASSERT(!full_dropped_routed);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_dao_malformed, "Malformed options");
+UNIT_TEST(test_dao_malformed)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Options that do not fit in the DAO are not read past its end */
+  UNIT_TEST_ASSERT(malformed_count == 4);
+  UNIT_TEST_ASSERT(malformed_queued == 0);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  uip_ds6_route_t *rep;
+  uint16_t count;
+  int i;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  uip_ip6addr(&root, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 1);
+  for(i = 0; i < NUM_SENDERS; i++) {
+    memset(&sender_lladdrs[i], 0, sizeof(linkaddr_t));
+    sender_lladdrs[i].u8[LINKADDR_SIZE - 1] = 0x0a + i;
+    uip_ip6addr(&senders[i], 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(&senders[i], (uip_lladdr_t *)&sender_lladdrs[i]);
+  }
+  for(i = 0; i < NUM_TARGETS; i++) {
+    uip_ip6addr(&targets[i], UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0x212, 0x7400, 0, i + 2);
+  }
+
+  uip_ds6_addr_add(&root, 0, ADDR_MANUAL);
+  dag = rpl_set_root(RPL_DEFAULT_INSTANCE, &root);
+  rpl_set_prefix(dag, &root, 64);
+
+  /* Nothing is processed before we yield */
+  count = rpl_stats.dao_queue_merged;
+  send_dao(0, 0, 10);
+  send_dao(0, 0, 20);
+  send_dao(1, 0, RPL_ZERO_LIFETIME);
+  send_dao(0, 1, 10);
+  merged_queued = rpl_icmp6_dao_queue_length();
+  merged_count = rpl_stats.dao_queue_merged - count;
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  rep = uip_ds6_route_lookup(&targets[0]);
+  merged_routed = routed(0, 0) && routed(1, 0);
+  merged_nopath_ignored = rep != NULL && !RPL_ROUTE_IS_NOPATH_RECEIVED(rep);
+  merged_lifetime = rep != NULL &&
+    rep->state.lifetime > RPL_LIFETIME(dag->instance, 10);
+  UNIT_TEST_RUN(test_dao_merged);
+
+  /* One DAO more than the queue holds, then a newer one for a queued
+     target */
+  count = rpl_stats.dao_queue_merged;
+  full_drops = rpl_stats.dao_queue_drops;
+  for(i = 2; i < 3 + RPL_DAO_QUEUE_SIZE; i++) {
+    send_dao(i % NUM_SENDERS, i, 10);
+  }
+  send_dao(2 % NUM_SENDERS, 2, 20);
+  full_queued = rpl_icmp6_dao_queue_length();
+  full_drops = rpl_stats.dao_queue_drops - full_drops;
+  full_merged = rpl_stats.dao_queue_merged - count;
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  full_routed = 1;
+  for(i = 2; i < 2 + RPL_DAO_QUEUE_SIZE; i++) {
+    full_routed = full_routed && routed(i, i % NUM_SENDERS);
+  }
+  full_dropped_routed = uip_ds6_route_lookup(&targets[2 + RPL_DAO_QUEUE_SIZE]) != NULL;
+  UNIT_TEST_RUN(test_dao_full);
+
+  /* A target option longer than the DAO, a truncated option header, a
+     target with a prefix longer than its option, and a truncated
+     Transit Information option */
+  count = rpl_stats.malformed_msgs;
+  dao_begin();
+  dao_add_target(NUM_TARGETS - 1);
+  dao_add_transit(10);
+  dao_len -= 8;
+  dao_input(0);
+  dao_begin();
+  dao_add_transit(10);
+  DAO_BUF[dao_len++] = RPL_OPTION_TARGET;
+  dao_input(0);
+  dao_begin();
+  dao_add_target(NUM_TARGETS - 1);
+  DAO_BUF[5] = 2 + 8;
+  dao_len -= 10;
+  dao_input(0);
+  dao_begin();
+  dao_add_target(NUM_TARGETS - 1);
+  DAO_BUF[dao_len++] = RPL_OPTION_TRANSIT;
+  DAO_BUF[dao_len++] = 2;
+  DAO_BUF[dao_len++] = 0;
+  DAO_BUF[dao_len++] = 0;
+  dao_input(0);
+  malformed_count = rpl_stats.malformed_msgs - count;
+  malformed_queued = rpl_icmp6_dao_queue_length();
+  UNIT_TEST_RUN(test_dao_malformed);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
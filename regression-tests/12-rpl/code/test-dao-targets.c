@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "net/packetbuf.h"
+#include "net/link-stats.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ipv6/uip-icmp6.h"
+#include "net/rpl/rpl-private.h"
+
+#if RPL_DAO_PACKING || RPL_DAO_QUEUE_SIZE
+#error "Build with TEST_CONFIG_TYPE=DAO_TARGETS"
+#endif /* RPL_DAO_PACKING || RPL_DAO_QUEUE_SIZE */
+
+PROCESS(test_process, "DAO targets test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define IP_BUF      ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define DAO_BUF     (&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN + UIP_ICMPH_LEN])
+
+/* The instance of which we are the root, and the one in which we are
+   a router below a parent */
+#define ROOT_INSTANCE   RPL_DEFAULT_INSTANCE
+#define ROUTER_INSTANCE (RPL_DEFAULT_INSTANCE + 1)
+
+#define NUM_SENDERS 2
+#define NUM_TARGETS 8
+
+static rpl_dag_t *root_dag;
+static rpl_dag_t *router_dag;
+static uip_ipaddr_t root;
+static uip_ipaddr_t senders[NUM_SENDERS];
+static linkaddr_t sender_lladdrs[NUM_SENDERS];
+static uip_ipaddr_t targets[NUM_TARGETS];
+static int dao_len;
+static uint8_t dao_sequence;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Start a DAO for the instance in uip_buf */
+static void
+dao_begin(uint8_t instance_id)
+{
+  dao_len = 0;
+  DAO_BUF[dao_len++] = instance_id;
+  DAO_BUF[dao_len++] = 0; /* flags */
+  DAO_BUF[dao_len++] = 0; /* reserved */
+  DAO_BUF[dao_len++] = ++dao_sequence;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dao_add_target(int target)
+{
+  DAO_BUF[dao_len++] = RPL_OPTION_TARGET;
+  DAO_BUF[dao_len++] = 2 + 16;
+  DAO_BUF[dao_len++] = 0; /* reserved */
+  DAO_BUF[dao_len++] = 128;
+  memcpy(&DAO_BUF[dao_len], &targets[target], 16);
+  dao_len += 16;
+}
+/*---------------------------------------------------------------------------*/
+static void
+dao_add_transit(uint8_t lifetime)
+{
+  DAO_BUF[dao_len++] = RPL_OPTION_TRANSIT;
+  DAO_BUF[dao_len++] = 4;
+  DAO_BUF[dao_len++] = 0; /* flags */
+  DAO_BUF[dao_len++] = 0; /* path control */
+  DAO_BUF[dao_len++] = 0; /* path sequence */
+  DAO_BUF[dao_len++] = lifetime;
+}
+/*---------------------------------------------------------------------------*/
+/* Pass the DAO in uip_buf to RPL as if it came from the sender */
+static void
+dao_input(int sender)
+{
+  memset(IP_BUF, 0, UIP_IPH_LEN);
+  IP_BUF->vtc = 0x60;
+  IP_BUF->len[1] = UIP_ICMPH_LEN + dao_len;
+  IP_BUF->proto = UIP_PROTO_ICMP6;
+  IP_BUF->ttl = 64;
+  uip_ipaddr_copy(&IP_BUF->srcipaddr, &senders[sender]);
+  uip_ipaddr_copy(&IP_BUF->destipaddr, &root);
+  uip_len = UIP_IPH_LEN + UIP_ICMPH_LEN + dao_len;
+  uip_ext_len = 0;
+
+  packetbuf_clear();
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &sender_lladdrs[sender]);
+  uip_icmp6_input(ICMP6_RPL, RPL_CODE_DAO);
+}
+/*---------------------------------------------------------------------------*/
+/* The route to the target, if it goes through the sender */
+static uip_ds6_route_t *
+route(int target, int sender)
+{
+  uip_ds6_route_t *rep = uip_ds6_route_lookup(&targets[target]);
+
+  if(rep == NULL || rep->length != 128 ||
+     !uip_ipaddr_cmp(&rep->ipaddr, &targets[target]) ||
+     uip_ds6_route_nexthop(rep) == NULL ||
+     !uip_ipaddr_cmp(uip_ds6_route_nexthop(rep), &senders[sender])) {
+    return NULL;
+  }
+  return rep;
+}
+/*---------------------------------------------------------------------------*/
+/* Join a DAG below a parent, as if we had received its DIO */
+static rpl_dag_t *
+join_router_dag(void)
+{
+  rpl_instance_t *instance;
+  rpl_dag_t *dag;
+  uip_ipaddr_t dag_id;
+  uip_ipaddr_t ipaddr;
+  linkaddr_t lladdr;
+  rpl_dio_t dio;
+
+  uip_ip6addr(&dag_id, 0xfd01, 0, 0, 0, 0, 0, 0, 1);
+  instance = rpl_alloc_instance(ROUTER_INSTANCE);
+  dag = rpl_alloc_dag(ROUTER_INSTANCE, &dag_id);
+  if(instance == NULL || dag == NULL) {
+    return NULL;
+  }
+  instance->of = rpl_find_of(RPL_OCP_MRHOF);
+  instance->mop = RPL_MOP_STORING_NO_MULTICAST;
+  instance->min_hoprankinc = RPL_MIN_HOPRANKINC;
+  instance->max_rankinc = RPL_MAX_RANKINC;
+  instance->default_lifetime = RPL_DEFAULT_LIFETIME;
+  instance->lifetime_unit = RPL_DEFAULT_LIFETIME_UNIT;
+  instance->current_dag = dag;
+  dag->joined = 1;
+
+  memset(&lladdr, 0, sizeof(linkaddr_t));
+  lladdr.u8[LINKADDR_SIZE - 1] = 0x01;
+  uip_ip6addr(&ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&ipaddr, (uip_lladdr_t *)&lladdr);
+  if(uip_ds6_nbr_add(&ipaddr, (uip_lladdr_t *)&lladdr, 1, NBR_REACHABLE,
+                     NBR_TABLE_REASON_RPL_DIO, NULL) == NULL) {
+    return NULL;
+  }
+  link_stats_packet_sent(&lladdr, MAC_TX_OK, 1);
+
+  memset(&dio, 0, sizeof(dio));
+  dio.rank = ROOT_RANK(instance);
+  if(rpl_add_parent(dag, &dio, &ipaddr) == NULL ||
+     rpl_select_parent(dag) == NULL) {
+    return NULL;
+  }
+  return dag;
+}
+/*---------------------------------------------------------------------------*/
+/* Results of the tests */
+static int root_routed;
+static int root_lifetime;
+static int root_nopath;
+static int router_joined;
+static int router_routed;
+static int router_forwarded;
+
+UNIT_TEST_REGISTER(test_dao_root, "Targets at the root");
+UNIT_TEST(test_dao_root)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Every target of the DAOs is routed through their sender, with the
+     lifetime of the Transit Information option that follows it */
+  UNIT_TEST_ASSERT(root_routed);
+  UNIT_TEST_ASSERT(root_lifetime);
+  UNIT_TEST_ASSERT(root_nopath);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_dao_router, "Targets at a router");
+UNIT_TEST(test_dao_router)
+{
+  UNIT_TEST_BEGIN();
+
+  /* Every target is routed, and sent on to the parent in one DAO */
+  UNIT_TEST_ASSERT(router_joined);
+  UNIT_TEST_ASSERT(router_routed);
+  UNIT_TEST_ASSERT(router_forwarded);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  uip_ds6_route_t *rep;
+  uint8_t seqno_out;
+  int i;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  uip_ip6addr(&root, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 1);
+  for(i = 0; i < NUM_SENDERS; i++) {
+    memset(&sender_lladdrs[i], 0, sizeof(linkaddr_t));
+    sender_lladdrs[i].u8[LINKADDR_SIZE - 1] = 0x0a + i;
+    uip_ip6addr(&senders[i], 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+    uip_ds6_set_addr_iid(&senders[i], (uip_lladdr_t *)&sender_lladdrs[i]);
+  }
+  for(i = 0; i < NUM_TARGETS; i++) {
+    uip_ip6addr(&targets[i], UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0x212, 0x7400, 0, i + 2);
+  }
+
+  uip_ds6_addr_add(&root, 0, ADDR_MANUAL);
+  root_dag = rpl_set_root(ROOT_INSTANCE, &root);
+  rpl_set_prefix(root_dag, &root, 64);
+
+  /* Three targets sharing a Transit Information option */
+  dao_begin(ROOT_INSTANCE);
+  dao_add_target(0);
+  dao_add_target(1);
+  dao_add_target(2);
+  dao_add_transit(20);
+  dao_input(0);
+
+  /* Then a target with a Transit Information option of its own, and a
+     No-Path for one of the targets above */
+  dao_begin(ROOT_INSTANCE);
+  dao_add_target(3);
+  dao_add_transit(10);
+  dao_add_target(1);
+  dao_add_transit(RPL_ZERO_LIFETIME);
+  dao_input(0);
+
+  root_routed = 1;
+  root_lifetime = 1;
+  for(i = 0; i < 4; i++) {
+    rep = route(i, 0);
+    root_routed = root_routed && rep != NULL;
+    if(rep != NULL && i != 1) {
+      root_lifetime = root_lifetime &&
+        rep->state.lifetime == RPL_LIFETIME(root_dag->instance, i < 3 ? 20 : 10);
+    }
+  }
+  rep = route(1, 0);
+  root_nopath = rep != NULL && RPL_ROUTE_IS_NOPATH_RECEIVED(rep) &&
+    (rep = route(0, 0)) != NULL && !RPL_ROUTE_IS_NOPATH_RECEIVED(rep);
+  UNIT_TEST_RUN(test_dao_root);
+
+  /* Four targets from another sender, to a router */
+  router_dag = join_router_dag();
+  router_joined = router_dag != NULL && router_dag->preferred_parent != NULL &&
+    router_dag->rank != ROOT_RANK(router_dag->instance);
+  if(router_joined) {
+    dao_begin(ROUTER_INSTANCE);
+    for(i = 4; i < NUM_TARGETS; i++) {
+      dao_add_target(i);
+    }
+    dao_add_transit(20);
+    dao_input(1);
+  }
+  router_routed = 1;
+  router_forwarded = 1;
+  seqno_out = 0;
+  for(i = 4; i < NUM_TARGETS; i++) {
+    rep = route(i, 1);
+    router_routed = router_routed && rep != NULL;
+    if(rep != NULL) {
+      if(i == 4) {
+        seqno_out = rep->state.dao_seqno_out;
+      }
+      router_forwarded = router_forwarded && RPL_ROUTE_IS_DAO_PENDING(rep) &&
+        rep->state.dao_seqno_out == seqno_out;
+    }
+  }
+  UNIT_TEST_RUN(test_dao_router);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "net/link-stats.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/rpl/rpl-private.h"
+
+#if !RPL_WITH_PARENT_HEAP
+#error "Build with TEST_CONFIG_TYPE=PARENT_HEAP"
+#endif /* !RPL_WITH_PARENT_HEAP */
+
+PROCESS(test_process, "Parent heap test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define NUM_PARENTS 5
+static linkaddr_t lladdrs[NUM_PARENTS];
+static rpl_parent_t *parents[NUM_PARENTS];
+static rpl_dag_t *dag;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_etx(int i, uint16_t etx)
+{
+  ((struct link_stats *)link_stats_from_lladdr(&lladdrs[i]))->etx = etx;
+}
+/*---------------------------------------------------------------------------*/
+static rpl_parent_t *
+add_parent(int i, rpl_rank_t rank, uint16_t etx)
+{
+  uip_ipaddr_t ipaddr;
+  rpl_dio_t dio;
+
+  memset(&lladdrs[i], 0, sizeof(linkaddr_t));
+  lladdrs[i].u8[LINKADDR_SIZE - 1] = 0x0a + i;
+  uip_ip6addr(&ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&ipaddr, (uip_lladdr_t *)&lladdrs[i]);
+  if(uip_ds6_nbr_add(&ipaddr, (uip_lladdr_t *)&lladdrs[i], 1, NBR_REACHABLE,
+                     NBR_TABLE_REASON_RPL_DIO, NULL) == NULL) {
+    return NULL;
+  }
+  link_stats_packet_sent(&lladdrs[i], MAC_TX_OK, 1);
+  set_etx(i, etx);
+
+  memset(&dio, 0, sizeof(dio));
+  dio.rank = rank;
+  return rpl_add_parent(dag, &dio, &ipaddr);
+}
+/*---------------------------------------------------------------------------*/
+/* The parent that best_parent() picks when it scans the parent table */
+static rpl_parent_t *
+linear_best_parent(void)
+{
+  rpl_parent_t *p;
+  rpl_parent_t *best = NULL;
+
+  for(p = nbr_table_head(rpl_parents); p != NULL; p = nbr_table_next(rpl_parents, p)) {
+    if(p->dag == dag && p->rank != INFINITE_RANK &&
+       p->rank >= ROOT_RANK(dag->instance)) {
+      best = dag->instance->of->best_parent(best, p);
+    }
+  }
+  return best;
+}
+/*---------------------------------------------------------------------------*/
+/* Whether the heap is ordered, and holds every parent the OF accepts */
+static int
+heap_is_valid(void)
+{
+  rpl_parent_t *p;
+  int i;
+
+  for(i = 0; i < dag->parent_heap_len; i++) {
+    if(dag->parent_heap[i]->heap_index != i + 1) {
+      return 0;
+    }
+    if(i > 0 && dag->parent_heap[(i - 1) / 2]->heap_key > dag->parent_heap[i]->heap_key) {
+      return 0;
+    }
+  }
+  for(p = nbr_table_head(rpl_parents); p != NULL; p = nbr_table_next(rpl_parents, p)) {
+    if(p->dag == dag && p->rank != INFINITE_RANK &&
+       p->rank >= ROOT_RANK(dag->instance) &&
+       dag->instance->of->best_parent(NULL, p) != NULL &&
+       p->heap_index == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Select a parent through the heap, and compare with a scan of the
+   parent table from the same preferred parent */
+static int
+select_matches_scan(void)
+{
+  rpl_parent_t *expected = linear_best_parent();
+
+  return rpl_select_parent(dag) == expected && heap_is_valid();
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_rank(int i, rpl_rank_t rank)
+{
+  parents[i]->rank = rank;
+  rpl_parent_heap_update(parents[i]);
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test_heap_init, "Initial selection");
+UNIT_TEST(test_heap_init)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  for(i = 0; i < NUM_PARENTS; i++) {
+    UNIT_TEST_ASSERT(parents[i] != NULL);
+  }
+  UNIT_TEST_ASSERT(dag->parent_heap_len == NUM_PARENTS);
+
+  /* The first parent has the lowest path cost, though not the lowest
+     rank via it */
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[0]);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_heap_rank, "Rank updates");
+UNIT_TEST(test_heap_rank)
+{
+  UNIT_TEST_BEGIN();
+
+  /* A parent that gets much better is switched to */
+  set_rank(2, 256);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[2]);
+
+  /* It leaves the heap with an infinite rank, and the next best is
+     switched to */
+  set_rank(2, INFINITE_RANK);
+  UNIT_TEST_ASSERT(parents[2]->heap_index == 0);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[0]);
+
+  /* A parent that gets slightly better is not switched to, even if it
+     is the first in the heap */
+  set_rank(1, 260);
+  UNIT_TEST_ASSERT(dag->parent_heap[0] == parents[1]);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[0]);
+
+  /* A rank below the root rank is not accepted */
+  set_rank(4, 128);
+  UNIT_TEST_ASSERT(parents[4]->heap_index == 0);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[0]);
+
+  /* A parent that comes back is placed in the heap again */
+  set_rank(2, 300);
+  set_rank(4, 1024);
+  UNIT_TEST_ASSERT(parents[2]->heap_index != 0);
+  UNIT_TEST_ASSERT(parents[4]->heap_index != 0);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[2]);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_heap_link, "Link updates");
+UNIT_TEST(test_heap_link)
+{
+  UNIT_TEST_BEGIN();
+
+  /* The preferred parent leaves the heap when its link is not usable */
+  set_etx(2, 1100);
+  rpl_parent_heap_update(parents[2]);
+  UNIT_TEST_ASSERT(parents[2]->heap_index == 0);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[1]);
+
+  /* And comes back when its link gets better, though not enough to
+     be switched to */
+  set_etx(2, 128);
+  rpl_parent_heap_update(parents[2]);
+  UNIT_TEST_ASSERT(dag->parent_heap[0] == parents[2]);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[1]);
+
+  /* The preferred parent is left when its link gets worse */
+  set_etx(1, 600);
+  rpl_parent_heap_update(parents[1]);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[2]);
+
+  /* The first parent of the heap is put back in place when its link
+     got worse without the heap being told */
+  set_etx(2, 700);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->parent_heap[0] == parents[0]);
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[0]);
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_heap_remove, "Parent removal");
+UNIT_TEST(test_heap_remove)
+{
+  int i;
+  int removed;
+
+  UNIT_TEST_BEGIN();
+
+  /* Removing the preferred parent */
+  rpl_remove_parent(parents[0]);
+  parents[0] = NULL;
+  UNIT_TEST_ASSERT(dag->parent_heap_len == NUM_PARENTS - 1);
+  UNIT_TEST_ASSERT(select_matches_scan());
+  UNIT_TEST_ASSERT(dag->preferred_parent == parents[1]);
+
+  /* Removing the last parent of the heap */
+  for(i = 0; i < NUM_PARENTS; i++) {
+    if(parents[i] != NULL &&
+       parents[i]->heap_index == dag->parent_heap_len &&
+       parents[i] != dag->preferred_parent) {
+      rpl_remove_parent(parents[i]);
+      parents[i] = NULL;
+      break;
+    }
+  }
+  UNIT_TEST_ASSERT(i < NUM_PARENTS);
+  UNIT_TEST_ASSERT(dag->parent_heap_len == NUM_PARENTS - 2);
+  UNIT_TEST_ASSERT(select_matches_scan());
+
+  /* Removing the others, the first of the heap first */
+  for(removed = 2; removed < NUM_PARENTS; removed++) {
+    for(i = 0; i < NUM_PARENTS; i++) {
+      if(parents[i] != NULL && parents[i]->heap_index == 1) {
+        rpl_remove_parent(parents[i]);
+        parents[i] = NULL;
+        break;
+      }
+    }
+    UNIT_TEST_ASSERT(i < NUM_PARENTS);
+    UNIT_TEST_ASSERT(dag->parent_heap_len == NUM_PARENTS - removed - 1);
+    UNIT_TEST_ASSERT(select_matches_scan());
+  }
+  UNIT_TEST_ASSERT(dag->preferred_parent == NULL);
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  uip_ipaddr_t dag_id;
+  rpl_instance_t *instance;
+
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  /* Let the network stack settle */
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  /* A DAG without downward routes, joined but not announced: the tests
+     below only select parents, and do not yield */
+  uip_ip6addr(&dag_id, 0xfd00, 0, 0, 0, 0, 0, 0, 1);
+  instance = rpl_alloc_instance(0x1e);
+  dag = rpl_alloc_dag(0x1e, &dag_id);
+  instance->of = rpl_find_of(RPL_OCP_MRHOF);
+  instance->min_hoprankinc = 256;
+  instance->mop = RPL_MOP_NO_DOWNWARD_ROUTES;
+  instance->current_dag = dag;
+  dag->joined = 1;
+
+  /* Ordered on the rank via each parent, the second parent would come
+     first */
+  parents[0] = add_parent(0, 400, 128);
+  parents[1] = add_parent(1, 300, 250);
+  parents[2] = add_parent(2, 512, 128);
+  parents[3] = add_parent(3, 768, 200);
+  parents[4] = add_parent(4, 1024, 128);
+
+  UNIT_TEST_RUN(test_heap_init);
+  UNIT_TEST_RUN(test_heap_rank);
+  UNIT_TEST_RUN(test_heap_link);
+  UNIT_TEST_RUN(test_heap_remove);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
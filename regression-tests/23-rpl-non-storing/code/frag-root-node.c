@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * RPL root that sends datagrams that need fragmentation down a source
+ * route, to test per-hop fragment forwarding at the nodes on the way.
+ */
+
+#include "contiki.h"
+#include "sys/etimer.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/ip/uip-debug.h"
+
+#include "simple-udp.h"
+
+#include "net/rpl/rpl.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define UDP_PORT 1234
+
+#define SEND_INTERVAL		(10 * CLOCK_SECOND)
+/* Too long for one frame, including the source routing header */
+#define MESSAGE_LEN		200
+/* The node at the end of the source route */
+#define DESTINATION_ID		3
+
+static struct simple_udp_connection unicast_connection;
+
+/*---------------------------------------------------------------------------*/
+PROCESS(frag_root_process, "Fragmenting root process");
+AUTOSTART_PROCESSES(&frag_root_process);
+/*---------------------------------------------------------------------------*/
+static uip_ipaddr_t *
+set_global_address(void)
+{
+  static uip_ipaddr_t ipaddr;
+
+  uip_ip6addr(&ipaddr, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 0);
+  uip_ds6_set_addr_iid(&ipaddr, &uip_lladdr);
+  uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
+
+  return &ipaddr;
+}
+/*---------------------------------------------------------------------------*/
+static void
+create_rpl_dag(uip_ipaddr_t *ipaddr)
+{
+  rpl_dag_t *dag;
+  uip_ipaddr_t prefix;
+
+  rpl_set_root(RPL_DEFAULT_INSTANCE, ipaddr);
+  dag = rpl_get_any_dag();
+  uip_ip6addr(&prefix, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 0);
+  rpl_set_prefix(dag, &prefix, 64);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(frag_root_process, ev, data)
+{
+  static struct etimer periodic_timer;
+  static unsigned int message_number;
+  static char buf[MESSAGE_LEN];
+  uip_ipaddr_t addr;
+  int i;
+
+  PROCESS_BEGIN();
+
+  create_rpl_dag(set_global_address());
+
+  simple_udp_register(&unicast_connection, UDP_PORT,
+                      NULL, UDP_PORT, NULL);
+
+  etimer_set(&periodic_timer, SEND_INTERVAL);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&periodic_timer));
+    etimer_reset(&periodic_timer);
+
+    uip_ip6addr(&addr, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0,
+                0x0200 | DESTINATION_ID, DESTINATION_ID,
+                DESTINATION_ID, DESTINATION_ID);
+
+    /* "Message <n> " followed by the alphabet, up to the end */
+    i = sprintf(buf, "Message %u ", message_number);
+    for(; i < MESSAGE_LEN - 1; i++) {
+      buf[i] = 'a' + i % 26;
+    }
+    buf[MESSAGE_LEN - 1] = '\0';
+
+    printf("Sending %u bytes to ", MESSAGE_LEN);
+    uip_debug_ipaddr_print(&addr);
+    printf("\n");
+    simple_udp_sendto(&unicast_connection, buf, MESSAGE_LEN, &addr);
+    message_number++;
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
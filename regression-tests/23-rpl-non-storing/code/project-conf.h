@@ -34,3 +34,14 @@
 /* Add a bit of extra probing in the non-storing case to compensate for reduced DAO traffic */
 #undef RPL_CONF_PROBING_INTERVAL
 #define RPL_CONF_PROBING_INTERVAL (60 * CLOCK_SECOND)
+
+#if WITH_FRAG_FWD
+/* Forward fragments hop by hop, across the source routes of the root */
+#define SICSLOWPAN_CONF_FRAG_FWD 1
+#endif /* WITH_FRAG_FWD */
+
+#if WITH_SRH_CACHE
+#define UNIT_TEST_PRINT_FUNCTION test_print_report
+/* Keep the source routing headers of two destinations */
+#define RPL_NS_CONF_SRH_CACHE_SIZE 2
+#endif /* WITH_SRH_CACHE */
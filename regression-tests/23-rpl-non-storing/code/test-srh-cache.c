@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "unit-test.h"
+
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/rpl/rpl-private.h"
+#include "net/rpl/rpl-ns.h"
+
+#if !RPL_NS_SRH_CACHE_SIZE
+#error "Build with TEST_CONFIG_TYPE=SRH_CACHE"
+#endif /* !RPL_NS_SRH_CACHE_SIZE */
+
+PROCESS(test_process, "SRH cache test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define IP_BUF   ((struct uip_ip_hdr *)&uip_buf[UIP_LLH_LEN])
+#define RH_BUF   ((struct uip_routing_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN])
+#define SRH_BUF  ((struct uip_rpl_srh_hdr *)&uip_buf[UIP_LLH_LEN + UIP_IPH_LEN + RPL_RH_LEN])
+
+#define LIFETIME 0xffffffff
+
+static rpl_dag_t *dag;
+static uip_ipaddr_t root, a, b, c, d, e;
+
+static void
+test_print_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+/* Builds a UDP packet from the root to dest in uip_buf and lets RPL
+   insert its source routing header */
+static int
+send_to(const uip_ipaddr_t *dest)
+{
+  memset(uip_buf, 0, UIP_LLH_LEN + UIP_IPH_LEN + UIP_UDPH_LEN);
+  IP_BUF->vtc = 0x60;
+  IP_BUF->len[1] = UIP_UDPH_LEN;
+  IP_BUF->proto = UIP_PROTO_UDP;
+  IP_BUF->ttl = uip_ds6_if.cur_hop_limit;
+  uip_ipaddr_copy(&IP_BUF->srcipaddr, &root);
+  uip_ipaddr_copy(&IP_BUF->destipaddr, dest);
+  uip_len = UIP_IPH_LEN + UIP_UDPH_LEN;
+  uip_ext_len = 0;
+  return rpl_update_header();
+}
+
+/* Checks that the packet in uip_buf goes to dest through first_hop and
+   hops - 1 other nodes */
+static int
+routed(const uip_ipaddr_t *dest, const uip_ipaddr_t *first_hop, int hops)
+{
+  uint8_t *last;
+  int cmpre;
+
+  if(!uip_ipaddr_cmp(&IP_BUF->destipaddr, first_hop)) {
+    return 0;
+  }
+  if(hops == 0) {
+    return IP_BUF->proto == UIP_PROTO_UDP && uip_ext_len == 0;
+  }
+  if(IP_BUF->proto != UIP_PROTO_ROUTING || RH_BUF->seg_left != hops ||
+     uip_ext_len != RH_BUF->len * 8 + 8 ||
+     uip_len != UIP_IPH_LEN + uip_ext_len + UIP_UDPH_LEN) {
+    return 0;
+  }
+  /* The destination is the last address of the header */
+  cmpre = SRH_BUF->cmpr & 0x0f;
+  last = (uint8_t *)RH_BUF + uip_ext_len - (SRH_BUF->pad >> 4) - (16 - cmpre);
+  return memcmp(last, (uint8_t *)dest + cmpre, 16 - cmpre) == 0;
+}
+
+static int
+cached(const uip_ipaddr_t *dest)
+{
+  return rpl_ns_get_cached_srh(rpl_ns_get_node(dag, dest)) != NULL;
+}
+
+UNIT_TEST_REGISTER(test_cached, "Cached header");
+UNIT_TEST(test_cached)
+{
+  UNIT_TEST_BEGIN();
+
+  /* root <- a <- b */
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &a, &root, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &b, &a, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(!cached(&b));
+
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &a, 1));
+  UNIT_TEST_ASSERT(cached(&b));
+
+  /* The second packet gets the same header from the cache */
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &a, 1));
+
+  /* So do packets to the neighbors of the root, without a header */
+  UNIT_TEST_ASSERT(send_to(&a));
+  UNIT_TEST_ASSERT(routed(&a, &a, 0));
+  UNIT_TEST_ASSERT(cached(&a));
+  UNIT_TEST_ASSERT(send_to(&a));
+  UNIT_TEST_ASSERT(routed(&a, &a, 0));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_topology_change, "Topology change");
+UNIT_TEST(test_topology_change)
+{
+  UNIT_TEST_BEGIN();
+
+  /* root <- c <- b */
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &c, &root, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &b, &c, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(!cached(&b));
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &c, 1));
+
+  /* root <- c <- a <- b */
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &a, &c, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &b, &a, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &c, 2));
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &c, 2));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_version_wrap, "Version wrap");
+UNIT_TEST(test_version_wrap)
+{
+  uint16_t version;
+  long i;
+
+  UNIT_TEST_BEGIN();
+
+  /* root <- a <- b */
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &a, &root, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &a, 1));
+  version = rpl_ns_topology_version();
+
+  /* root <- c <- b, then change the topology until the version comes
+     back to the one the header of b was cached with */
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &b, &c, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &d, &a, LIFETIME) != NULL);
+  for(i = 0; i < 0x20000 && rpl_ns_topology_version() != version; i++) {
+    rpl_ns_update_node(dag, &d, (i & 1) ? &a : &c, LIFETIME);
+  }
+  UNIT_TEST_ASSERT(rpl_ns_topology_version() == version);
+
+  UNIT_TEST_ASSERT(!cached(&b));
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &c, 1));
+
+  UNIT_TEST_END();
+}
+
+UNIT_TEST_REGISTER(test_eviction, "Eviction");
+UNIT_TEST(test_eviction)
+{
+  UNIT_TEST_BEGIN();
+
+  /* root <- a <- b, root <- c <- d, root <- c <- e */
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &b, &a, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &d, &c, LIFETIME) != NULL);
+  UNIT_TEST_ASSERT(rpl_ns_update_node(dag, &e, &c, LIFETIME) != NULL);
+
+  /* The cache holds RPL_NS_SRH_CACHE_SIZE headers */
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &a, 1));
+  UNIT_TEST_ASSERT(send_to(&d));
+  UNIT_TEST_ASSERT(routed(&d, &c, 1));
+  UNIT_TEST_ASSERT(send_to(&b));
+  UNIT_TEST_ASSERT(routed(&b, &a, 1));
+  UNIT_TEST_ASSERT(send_to(&e));
+  UNIT_TEST_ASSERT(routed(&e, &c, 1));
+
+  /* d was the least recently used */
+  UNIT_TEST_ASSERT(cached(&b));
+  UNIT_TEST_ASSERT(!cached(&d));
+  UNIT_TEST_ASSERT(cached(&e));
+  UNIT_TEST_ASSERT(send_to(&d));
+  UNIT_TEST_ASSERT(routed(&d, &c, 1));
+  UNIT_TEST_ASSERT(!cached(&b));
+
+  UNIT_TEST_END();
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  uip_ip6addr(&root, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 1);
+  uip_ip6addr(&a, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0x212, 0x7402, 2, 2);
+  uip_ip6addr(&b, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0x212, 0x7403, 3, 3);
+  uip_ip6addr(&c, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0x212, 0x7404, 4, 4);
+  uip_ip6addr(&d, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0x212, 0x7405, 5, 5);
+  uip_ip6addr(&e, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0x212, 0x7406, 6, 6);
+
+  uip_ds6_addr_add(&root, 0, ADDR_MANUAL);
+  dag = rpl_set_root(RPL_DEFAULT_INSTANCE, &root);
+  rpl_set_prefix(dag, &root, 64);
+
+  UNIT_TEST_RUN(test_cached);
+  UNIT_TEST_RUN(test_topology_change);
+  UNIT_TEST_RUN(test_version_wrap);
+  UNIT_TEST_RUN(test_eviction);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -25,7 +25,8 @@
       <identifier>mtype476</identifier>
       <description>Cooja Mote Type #1</description>
       <source>[CONTIKI_DIR]/regression-tests/27-tsch/code/test-flush-nbr-queue.c</source>
-      <commands>make test-flush-nbr-queue.cooja TARGET=cooja</commands>
+      <commands>make TARGET=cooja clean
+      make test-flush-nbr-queue.cooja TARGET=cooja</commands>
       <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
       <moteinterface>org.contikios.cooja.interfaces.Battery</moteinterface>
       <moteinterface>org.contikios.cooja.contikimote.interfaces.ContikiVib</moteinterface>
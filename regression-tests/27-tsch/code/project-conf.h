@@ -38,6 +38,18 @@
 #undef QUEUEBUF_CONF_NUM
 #define QUEUEBUF_CONF_NUM   1
 
+#if WITH_SCHEDULE_COMPILED
+/* Check the sorted link index in the schedule lookup test */
+#undef TSCH_SCHEDULE_CONF_COMPILED
+#define TSCH_SCHEDULE_CONF_COMPILED 1
+#endif /* WITH_SCHEDULE_COMPILED */
+
+#if WITH_SLOT_TRACE
+/* Trace the slot phases for the slot timing benchmark */
+#undef TSCH_CONF_WITH_SLOT_TRACE
+#define TSCH_CONF_WITH_SLOT_TRACE 1
+#endif /* WITH_SLOT_TRACE */
+
 #undef TSCH_LOG_CONF_LEVEL
 #define TSCH_LOG_CONF_LEVEL 2
 
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "contiki-lib.h"
+#include "lib/assert.h"
+#include "lib/random.h"
+
+#include "net/linkaddr.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-schedule.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+PROCESS(test_process, "tsch_schedule_get_next_active_link() test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define TEST_LOOKUPS 2000
+
+static const uint16_t slotframe_sizes[] = { 7, 31, 101, 397 };
+#define TEST_SLOTFRAMES (sizeof(slotframe_sizes) / sizeof(slotframe_sizes[0]))
+
+/* Handles of the slotframes in the order they were added, which is the
+ * order in which overlapping links are compared */
+static uint16_t slotframe_order[TEST_SLOTFRAMES];
+
+/* The lookup of tsch_schedule_get_next_active_link(), as a scan of all
+ * links, to check the result against */
+static struct tsch_link *
+reference_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset,
+                           struct tsch_link **backup_link)
+{
+  uint16_t time_to_curr_best = 0;
+  struct tsch_link *curr_best = NULL;
+  struct tsch_link *curr_backup = NULL;
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  int i;
+
+  for(i = 0; i < TEST_SLOTFRAMES; i++) {
+    uint16_t timeslot;
+    sf = tsch_schedule_get_slotframe_by_handle(slotframe_order[i]);
+    timeslot = TSCH_ASN_MOD(*asn, sf->size);
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      uint16_t time_to_timeslot =
+        l->timeslot > timeslot ?
+        l->timeslot - timeslot :
+        sf->size.val + l->timeslot - timeslot;
+      if(curr_best == NULL || time_to_timeslot < time_to_curr_best) {
+        time_to_curr_best = time_to_timeslot;
+        curr_best = l;
+        curr_backup = NULL;
+      } else if(time_to_timeslot == time_to_curr_best) {
+        struct tsch_link *new_best = NULL;
+        if((curr_best->link_options & LINK_OPTION_TX) == (l->link_options & LINK_OPTION_TX)) {
+          if(l->slotframe_handle < curr_best->slotframe_handle) {
+            new_best = l;
+          }
+        } else if(l->link_options & LINK_OPTION_TX) {
+          new_best = l;
+        }
+        if(curr_backup == NULL) {
+          if(new_best != l && (l->link_options & LINK_OPTION_RX)) {
+            curr_backup = l;
+          }
+          if(new_best != curr_best && (curr_best->link_options & LINK_OPTION_RX)) {
+            curr_backup = curr_best;
+          }
+        }
+        if(new_best != NULL) {
+          curr_best = new_best;
+        }
+      }
+    }
+  }
+  *time_offset = time_to_curr_best;
+  *backup_link = curr_backup;
+  return curr_best;
+}
+
+static void
+add_random_links(int n)
+{
+  struct tsch_slotframe *sf;
+  linkaddr_t addr;
+  int i;
+
+  for(i = 0; i < n; i++) {
+    sf = tsch_schedule_get_slotframe_by_handle(random_rand() % TEST_SLOTFRAMES);
+    memset(&addr, 0, sizeof(addr));
+    addr.u8[0] = random_rand() % 8;
+    tsch_schedule_add_link(sf, 1 + random_rand() % 3, LINK_TYPE_NORMAL, &addr,
+                           random_rand() % sf->size.val, random_rand() % 16);
+  }
+}
+
+static int
+check_lookups(void)
+{
+  struct tsch_asn_t asn;
+  struct tsch_link *l1, *l2, *b1, *b2;
+  uint16_t t1, t2;
+  int i;
+
+  TSCH_ASN_INIT(asn, 0, random_rand());
+  for(i = 0; i < TEST_LOOKUPS; i++) {
+    l1 = tsch_schedule_get_next_active_link(&asn, &t1, &b1);
+    l2 = reference_next_active_link(&asn, &t2, &b2);
+    if(l1 != l2 || t1 != t2 || b1 != b2) {
+      printf("Mismatch at ASN %lu\n", (unsigned long)asn.ls4b);
+      return 0;
+    }
+    /* Move to the next active slot, or just after it */
+    TSCH_ASN_INC(asn, t1 - random_rand() % 2);
+  }
+  return 1;
+}
+
+UNIT_TEST_REGISTER(test,
+                   "get_next_active_link() should find the same link as a scan");
+UNIT_TEST(test)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  tsch_schedule_remove_all_slotframes();
+  for(i = 0; i < TEST_SLOTFRAMES; i++) {
+    UNIT_TEST_ASSERT(tsch_schedule_add_slotframe(i, slotframe_sizes[i]) != NULL);
+    slotframe_order[i] = i;
+  }
+
+  /* Fill the schedule, with overlaps between slotframes */
+  add_random_links(TSCH_SCHEDULE_MAX_LINKS);
+  UNIT_TEST_ASSERT(check_lookups());
+
+  /* Change it and check again */
+  for(i = 0; i < TSCH_SCHEDULE_MAX_LINKS / 2; i++) {
+    tsch_schedule_remove_link(tsch_schedule_get_slotframe_by_handle(1),
+                              list_head(tsch_schedule_get_slotframe_by_handle(1)->links_list));
+  }
+  add_random_links(TSCH_SCHEDULE_MAX_LINKS / 4);
+  UNIT_TEST_ASSERT(check_lookups());
+
+  UNIT_TEST_ASSERT(tsch_schedule_remove_slotframe(tsch_schedule_get_slotframe_by_handle(2)));
+  UNIT_TEST_ASSERT(tsch_schedule_add_slotframe(2, slotframe_sizes[2]) != NULL);
+  for(i = 2; i < TEST_SLOTFRAMES - 1; i++) {
+    slotframe_order[i] = slotframe_order[i + 1];
+  }
+  slotframe_order[TEST_SLOTFRAMES - 1] = 2;
+  add_random_links(TSCH_SCHEDULE_MAX_LINKS / 4);
+  UNIT_TEST_ASSERT(check_lookups());
+
+  UNIT_TEST_END();
+}
+
+/* Reports the longest lookup, in rtimer ticks, for a full schedule */
+static void
+benchmark(void)
+{
+  struct tsch_asn_t asn;
+  struct tsch_link *backup;
+  rtimer_clock_t start, duration, worst;
+  uint16_t offset;
+  int i;
+
+  worst = 0;
+  TSCH_ASN_INIT(asn, 0, 0);
+  for(i = 0; i < TEST_LOOKUPS; i++) {
+    start = RTIMER_NOW();
+    tsch_schedule_get_next_active_link(&asn, &offset, &backup);
+    duration = RTIMER_NOW() - start;
+    if(duration > worst) {
+      worst = duration;
+    }
+    TSCH_ASN_INC(asn, offset);
+  }
+  printf("Worst-case lookup with %u links: %lu rtimer ticks (compiled %u)\n",
+         TSCH_SCHEDULE_MAX_LINKS, (unsigned long)worst, TSCH_SCHEDULE_COMPILED);
+}
+
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test);
+
+  benchmark();
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Slot timing benchmark. Runs a coordinator with Tx, Rx and idle slots,
+ * and reports the distribution of the slack of every slot phase, as
+ * recorded with TSCH_WITH_SLOT_TRACE.
+ */
+
+#include <stdio.h>
+
+#include "contiki.h"
+#include "contiki-net.h"
+#include "contiki-lib.h"
+
+#include "net/linkaddr.h"
+#include "net/netstack.h"
+#include "net/packetbuf.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-queue.h"
+#include "net/mac/tsch/tsch-schedule.h"
+#include "net/mac/tsch/tsch-slot-operation.h"
+
+#include "unit-test.h"
+#include "common.h"
+
+#if !TSCH_WITH_SLOT_TRACE
+#error "Build with TEST_CONFIG_TYPE=SLOT_TRACE"
+#endif /* !TSCH_WITH_SLOT_TRACE */
+
+PROCESS(test_process, "TSCH slot timing benchmark");
+AUTOSTART_PROCESSES(&test_process);
+
+#define BENCHMARK_DURATION (5 * CLOCK_SECOND)
+
+/* A neighbor that never answers: unicast slots wait for an ACK in vain */
+static linkaddr_t test_nbr_addr = {{ 0x01 }};
+
+static const char *phase_names[TSCH_SLOT_NUM_PHASES] = {
+  "packet", "prepare", "txrx", "post", "schedule"
+};
+
+/* Slack distribution, in shares of the deadline: missed, < 10%,
+ * < 25%, < 50% and above */
+#define NUM_BUCKETS 5
+struct phase_stats {
+  uint32_t count;
+  int32_t slack_min;
+  int32_t slack_max;
+  int32_t slack_sum;
+  uint32_t buckets[NUM_BUCKETS];
+};
+static struct phase_stats stats[TSCH_SLOT_NUM_PHASES];
+static uint32_t num_traces;
+
+/*---------------------------------------------------------------------------*/
+static void
+add_trace(const struct tsch_slot_trace *trace)
+{
+  int i;
+
+  num_traces++;
+  for(i = 0; i < TSCH_SLOT_NUM_PHASES; i++) {
+    if(trace->phases & (1 << i)) {
+      struct phase_stats *s = &stats[i];
+      int32_t deadline = trace->deadline[i];
+      int32_t slack = deadline - (int32_t)trace->end[i];
+      int bucket;
+
+      if(s->count == 0 || slack < s->slack_min) {
+        s->slack_min = slack;
+      }
+      if(s->count == 0 || slack > s->slack_max) {
+        s->slack_max = slack;
+      }
+      s->count++;
+      s->slack_sum += slack;
+
+      if(slack < 0) {
+        bucket = 0;
+      } else if(slack * 10 < deadline) {
+        bucket = 1;
+      } else if(slack * 4 < deadline) {
+        bucket = 2;
+      } else if(slack * 2 < deadline) {
+        bucket = 3;
+      } else {
+        bucket = 4;
+      }
+      s->buckets[bucket]++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_report(void)
+{
+  int i;
+
+  printf("Slot timing: %lu slots traced, %lu dropped\n",
+         (unsigned long)num_traces, (unsigned long)tsch_slot_trace_dropped());
+  printf("Slot timing: phase count slack-min slack-avg slack-max (ticks) "
+         "missed <10%% <25%% <50%% >=50%%\n");
+  for(i = 0; i < TSCH_SLOT_NUM_PHASES; i++) {
+    struct phase_stats *s = &stats[i];
+    printf("Slot timing: %s %lu %ld %ld %ld %lu %lu %lu %lu %lu\n",
+           phase_names[i], (unsigned long)s->count,
+           (long)s->slack_min, s->count ? (long)(s->slack_sum / (int32_t)s->count) : 0L,
+           (long)s->slack_max,
+           (unsigned long)s->buckets[0], (unsigned long)s->buckets[1],
+           (unsigned long)s->buckets[2], (unsigned long)s->buckets[3],
+           (unsigned long)s->buckets[4]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Keep a unicast packet in the queue of the test neighbor */
+static void
+feed_queue(void)
+{
+  static uint8_t payload[32];
+
+  if(tsch_queue_packet_count(&test_nbr_addr) == 0) {
+    packetbuf_clear();
+    packetbuf_copyfrom(payload, sizeof(payload));
+    packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &test_nbr_addr);
+    NETSTACK_MAC.send(NULL, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(test,
+                   "slot operation should meet the deadlines of all phases");
+UNIT_TEST(test)
+{
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  UNIT_TEST_ASSERT(num_traces > 0);
+  for(i = 0; i < TSCH_SLOT_NUM_PHASES; i++) {
+    UNIT_TEST_ASSERT(stats[i].count > 0);
+    UNIT_TEST_ASSERT(stats[i].buckets[0] == 0);
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  static struct etimer et;
+  static struct tsch_slot_trace trace;
+  static clock_time_t start;
+  struct tsch_slotframe *sf;
+
+  PROCESS_BEGIN();
+
+  tsch_set_coordinator(1);
+
+  etimer_set(&et, CLOCK_SECOND);
+  while(tsch_is_associated == 0) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+  }
+
+  /* Next to the minimal schedule: a Tx, a Rx and an idle slot */
+  sf = tsch_schedule_add_slotframe(1, 4);
+  tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_NORMAL, &test_nbr_addr, 1, 1);
+  tsch_schedule_add_link(sf, LINK_OPTION_RX, LINK_TYPE_NORMAL, &test_nbr_addr, 2, 1);
+  tsch_schedule_add_link(sf, LINK_OPTION_TX, LINK_TYPE_NORMAL, &tsch_broadcast_address, 3, 1);
+
+  /* Discard the slots before the schedule was complete */
+  while(tsch_slot_trace_get(&trace));
+
+  start = clock_time();
+  etimer_set(&et, CLOCK_SECOND / 20);
+  while(clock_time() - start < BENCHMARK_DURATION) {
+    PROCESS_YIELD_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+    feed_queue();
+    while(tsch_slot_trace_get(&trace)) {
+      add_trace(&trace);
+    }
+  }
+
+  print_report();
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(test);
+
+  printf("=check-me= DONE\n");
+  PROCESS_END();
+}
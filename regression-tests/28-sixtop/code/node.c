@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026, Contiki contributors.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Traffic test for 6top. Node 1 is the RPL root and collects UDP
+ *         packets from all other nodes, and reports their end-to-end
+ *         latency. Every node periodically reports its negotiated cells.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "node-id.h"
+#include "simple-udp.h"
+#include "net/ip/uip.h"
+#include "net/ipv6/uip-ds6.h"
+#include "net/rpl/rpl.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/tsch-private.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+
+#define UDP_PORT 1234
+#define SEND_INTERVAL (CLOCK_SECOND / 2)
+#define NUM_PACKETS 300
+
+struct app_msg {
+  uint32_t seqno;
+  struct tsch_asn_t asn;
+};
+
+static struct simple_udp_connection udp_conn;
+
+PROCESS(node_process, "6top traffic test");
+AUTOSTART_PROCESSES(&node_process);
+
+/*---------------------------------------------------------------------------*/
+static void
+udp_rx_callback(struct simple_udp_connection *c,
+                const uip_ipaddr_t *sender_addr, uint16_t sender_port,
+                const uip_ipaddr_t *receiver_addr, uint16_t receiver_port,
+                const uint8_t *data, uint16_t datalen)
+{
+  struct app_msg msg;
+  unsigned long latency;
+
+  if(datalen != sizeof(msg)) {
+    return;
+  }
+  memcpy(&msg, data, sizeof(msg));
+  latency = TSCH_ASN_DIFF(tsch_current_asn, msg.asn)
+    * (TSCH_CONF_DEFAULT_TIMESLOT_LENGTH / 1000);
+  printf("App: rx from %u seqno %lu latency %lu ms\n",
+         sender_addr->u8[15], (unsigned long)msg.seqno, latency);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(node_process, ev, data)
+{
+  static struct etimer et;
+  static struct app_msg msg;
+  static unsigned long ticks;
+  rpl_dag_t *dag;
+
+  PROCESS_BEGIN();
+
+  if(node_id == 1) {
+    uip_ipaddr_t prefix;
+    uip_ipaddr_t root_ipaddr;
+    uip_ip6addr(&prefix, UIP_DS6_DEFAULT_PREFIX, 0, 0, 0, 0, 0, 0, 0);
+    memcpy(&root_ipaddr, &prefix, 16);
+    uip_ds6_set_addr_iid(&root_ipaddr, &uip_lladdr);
+    uip_ds6_addr_add(&root_ipaddr, 0, ADDR_AUTOCONF);
+    rpl_set_root(RPL_DEFAULT_INSTANCE, &root_ipaddr);
+    rpl_set_prefix(rpl_get_any_dag(), &prefix, 64);
+    rpl_repair_root(RPL_DEFAULT_INSTANCE);
+  }
+  NETSTACK_MAC.on();
+
+  simple_udp_register(&udp_conn, UDP_PORT, NULL, UDP_PORT, udp_rx_callback);
+
+  etimer_set(&et, SEND_INTERVAL);
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+    etimer_reset(&et);
+    ticks++;
+
+    if(ticks % 20 == 0) {
+      printf("App: cells %d\n", sixtop_num_cells());
+    }
+
+    dag = rpl_get_any_dag();
+    if(node_id != 1 && msg.seqno < NUM_PACKETS
+       && dag != NULL && dag->preferred_parent != NULL && tsch_is_associated) {
+      msg.seqno++;
+      msg.asn = tsch_current_asn;
+      printf("App: tx seqno %lu\n", (unsigned long)msg.seqno);
+      simple_udp_sendto(&udp_conn, &msg, sizeof(msg), &dag->dag_id);
+      if(msg.seqno == NUM_PACKETS) {
+        printf("App: done\n");
+      }
+    }
+  }
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/